@@ -0,0 +1,258 @@
+#include "lob/backtester.hpp"
+#include "lob/synthetic.hpp"
+#include "bench_common.hpp"
+
+#include <fstream>
+#include <iostream>
+
+// End-to-end replay benchmark of Backtester::run.  A synthetic session
+// (lob/synthetic.hpp) is replayed through the full pipeline with a
+// configurable number of symbols, strategies and signal calculators;
+// every stage is timed through the backtester's own stage profiling.
+// Market ORDER events are injected periodically so that the fill
+// accounting stage is exercised.  --hw-counters additionally samples
+// cycles, instructions, cache and branch misses per stage (Linux
+// perf_event_open; skipped with a note where the kernel refuses).  The
+// counter reads inflate the stage latencies, so compare timings only
+// between runs with the same setting.  --trace writes sampled stage
+// spans as Chrome trace JSON for ui.perfetto.dev; --trace-every and
+// --trace-burst control the sampling (default: 64 of every 4096 events).
+// --coalesce-ns N applies bursts of market data within N ns to the books
+// before signals and strategies run once per book (0 = same timestamp).
+// --warm-up N feeds the first N events to the books only.
+//
+//   bench_backtester [--profile liquid_equity|small_cap|crypto]
+//                    [--events N] [--symbols S] [--strategies K]
+//                    [--signals M] [--order-every N] [--seed S]
+//                    [--hw-counters] [--json [out.json|-]]
+//                    [--trace trace.json] [--trace-every N] [--trace-burst B]
+//                    [--coalesce-ns N] [--warm-up N]
+
+using namespace lob;
+using namespace lob::bench;
+
+namespace {
+
+// Wraps the synthetic feed and interleaves a small market order every
+// `every` events on the symbol that was just updated.
+class OrderInjectingSource : public DataSource {
+public:
+    OrderInjectingSource(SyntheticMarketConfig cfg, uint64_t every)
+        : inner_(std::move(cfg)), every_(every) {}
+
+    bool hasNext() const override { return inject_ || inner_.hasNext(); }
+
+    Event getNext() override {
+        if (inject_) {
+            inject_ = false;
+            Event e{};
+            e.type = Event::ORDER;
+            e.timestamp = last_.timestamp;
+            e.symbol = last_.symbol;
+            Order o{0, 0, 100, (++injected_ % 2) ? Side::BID : Side::ASK, last_.timestamp};
+            o.type = OrderType::MARKET;
+            e.order = o;
+            return e;
+        }
+        Event e = inner_.getNext();
+        if (every_ != 0 && ++count_ % every_ == 0) {
+            inject_ = true;
+            last_.timestamp = e.timestamp;
+            last_.symbol = e.symbol;
+        }
+        return e;
+    }
+
+    void reset() override {
+        inner_.reset();
+        count_ = injected_ = 0;
+        inject_ = false;
+    }
+
+private:
+    SyntheticDataSource inner_;
+    uint64_t every_;
+    uint64_t count_ = 0;
+    uint64_t injected_ = 0;
+    bool inject_ = false;
+    Event last_{};
+};
+
+std::unique_ptr<SignalCalculator> makeCalculator(uint64_t i) {
+    switch (i % 6) {
+        case 0: return std::make_unique<OrderImbalanceSignal>(5, 0.3);
+        case 1: return std::make_unique<MicropriceSignal>(1, true);
+        case 2: return std::make_unique<SpreadSignal>(50);
+        case 3: return std::make_unique<BookPressureSignal>(100);
+        case 4: return std::make_unique<TradeFlowSignal>(50, 0.95);
+        default: return std::make_unique<QueuePositionSignal>();
+    }
+}
+
+std::unique_ptr<Strategy> makeStrategy(uint64_t i) {
+    if (i % 2 == 0) return std::make_unique<MarketMakerStrategy>();
+    return std::make_unique<MomentumStrategy>();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Args args(argc, argv);
+    std::ofstream json_file;
+    std::ostream* const json = openJsonOutput(args, json_file);
+    if (args.has("json") && json == nullptr) return 1;
+    // Opened up front like the report, so a bad path fails before the run.
+    const std::string trace_path = args.get("trace", "trace.json");
+    std::ofstream trace_file;
+    if (args.has("trace")) {
+        trace_file.open(trace_path);
+        if (!trace_file) {
+            std::cerr << "cannot open " << trace_path << " for writing\n";
+            return 1;
+        }
+    }
+    SyntheticMarketConfig cfg;
+    if (!SyntheticMarketConfig::preset(args.get("profile", "liquid_equity"), cfg)) {
+        std::cerr << "unknown profile: " << args.get("profile", "") << "\n";
+        return 1;
+    }
+    cfg.symbols = static_cast<uint32_t>(args.getU64("symbols", 4));
+    cfg.seed = args.getU64("seed", 42);
+    cfg.max_events = args.getU64("events", 1000000);
+    cfg.duration = ~Timestamp{0} - cfg.start_time;
+    const uint64_t n_strategies = args.getU64("strategies", 2);
+    const uint64_t n_signals = args.getU64("signals", 3);
+    const uint64_t order_every = args.getU64("order-every", 1000);
+
+#ifdef LOB_BENCH_SANITIZED
+    std::cerr << "warning: built with sanitizers; latencies are not representative\n";
+#endif
+
+    Backtester bt;
+    bt.setStageProfiling(true);
+    bt.setHardwareCounters(args.has("hw-counters"));
+    const bool coalesce = args.has("coalesce-ns");
+    bt.setTimestampCoalescing(coalesce, args.getU64("coalesce-ns", 0));
+    bt.setWarmUp(0, args.getU64("warm-up", 0));
+    auto signals = std::make_unique<SignalGenerator>();
+    for (uint64_t i = 0; i < n_signals; ++i) signals->addCalculator(makeCalculator(i));
+    bt.setSignalGenerator(std::move(signals));
+    for (uint64_t i = 0; i < n_strategies; ++i) bt.addStrategy(makeStrategy(i));
+    bt.setDataSource(std::make_unique<OrderInjectingSource>(cfg, order_every));
+
+    if (args.has("trace")) {
+        TraceConfig tc;
+        tc.sample_every = static_cast<uint32_t>(args.getU64("trace-every", 4096));
+        tc.burst = static_cast<uint32_t>(args.getU64("trace-burst", 64));
+        Tracer::instance().start(tc);
+    }
+
+    const uint64_t t0 = nowNs();
+    auto res = bt.run();
+    const uint64_t wall_ns = nowNs() - t0;
+    (void) res;
+
+    if (args.has("trace")) {
+        Tracer::instance().stop();
+        const size_t spans = Tracer::instance().writeChromeJson(trace_file);
+        trace_file.flush();
+        if (!trace_file) {
+            std::cerr << "failed to write the trace to " << trace_path << "\n";
+            return 1;
+        }
+        std::fprintf(tableOut(), "  wrote %zu trace spans to %s\n", spans, trace_path.c_str());
+    }
+
+    const auto& ps = bt.getPerformanceStats();
+    const uint64_t events = ps.stage(PipelineStage::PARSE).count();
+    const double secs = static_cast<double>(wall_ns) * 1e-9;
+    std::fprintf(tableOut(), "%s: %llu events, %u symbols, %llu strategies, %llu signals\n", cfg.name.c_str(),
+                 static_cast<unsigned long long>(events), cfg.symbols, static_cast<unsigned long long>(n_strategies),
+                 static_cast<unsigned long long>(n_signals));
+    std::fprintf(tableOut(), "  %.3f M events/s  %.1f ns/event  fills=%llu\n",
+                 static_cast<double>(events) / secs * 1e-6, static_cast<double>(wall_ns) / static_cast<double>(events),
+                 static_cast<unsigned long long>(ps.orders_filled));
+    if (ps.warm_up_events != 0) {
+        std::fprintf(tableOut(), "  warm-up: %llu events applied to the books only\n",
+                     static_cast<unsigned long long>(ps.warm_up_events));
+    }
+    if (coalesce) {
+        std::fprintf(tableOut(), "  coalesced: %llu market data callbacks for %llu updates\n",
+                     static_cast<unsigned long long>(ps.market_data_callbacks),
+                     static_cast<unsigned long long>(ps.events_processed));
+    }
+    std::fprintf(tableOut(), "  %-16s %10s %10s %8s %8s %8s %10s\n", "stage", "calls", "ns/event", "p50", "p99",
+                 "p99.9", "max");
+    for (size_t k = 0; k < kPipelineStageCount; ++k) {
+        const auto stage = static_cast<PipelineStage>(k);
+        const auto& h = ps.stage(stage);
+        std::fprintf(tableOut(), "  %-16s %10llu %10.1f %8llu %8llu %8llu %10llu\n", stageName(stage),
+                     static_cast<unsigned long long>(h.count()),
+                     static_cast<double>(h.total()) / static_cast<double>(std::max<uint64_t>(1, events)),
+                     static_cast<unsigned long long>(h.percentile(0.50)),
+                     static_cast<unsigned long long>(h.percentile(0.99)),
+                     static_cast<unsigned long long>(h.percentile(0.999)),
+                     static_cast<unsigned long long>(h.max()));
+    }
+    printAllocations(ps.allocations, events);
+    if (args.has("hw-counters")) {
+        if (ps.hw_counters_available) {
+            printHwCountersHeader();
+            for (size_t k = 0; k < kPipelineStageCount; ++k) {
+                const auto stage = static_cast<PipelineStage>(k);
+                printHwCounters(stageName(stage), ps.counters(stage), events);
+            }
+        } else {
+            std::fprintf(tableOut(), "  hardware counters unavailable: %s\n", HwCounterGroup().error().c_str());
+        }
+    }
+
+    if (json != nullptr) {
+        JsonWriter w(*json);
+        w.beginObject();
+        w.field("benchmark", "backtester");
+        writeBuildInfo(w);
+        w.key("config").beginObject();
+        w.field("profile", cfg.name);
+        w.field("seed", cfg.seed);
+        w.field("symbols", static_cast<uint64_t>(cfg.symbols));
+        w.field("strategies", n_strategies);
+        w.field("signals", n_signals);
+        w.field("order_every", order_every);
+        w.field("coalesce_ns", coalesce ? args.getU64("coalesce-ns", 0) : uint64_t{0});
+        w.field("coalesce", coalesce);
+        w.field("warm_up", args.getU64("warm-up", 0));
+        w.endObject();
+        w.field("warm_up_events", ps.warm_up_events);
+        w.field("market_data_callbacks", ps.market_data_callbacks);
+        w.field("events", events);
+        w.field("wall_ns", wall_ns);
+        w.field("events_per_sec", static_cast<double>(events) / secs);
+        w.field("ns_per_event", static_cast<double>(wall_ns) / static_cast<double>(events));
+        w.field("orders_sent", ps.orders_sent);
+        w.field("orders_filled", ps.orders_filled);
+        w.key("stages").beginObject();
+        for (size_t k = 0; k < kPipelineStageCount; ++k) {
+            const auto stage = static_cast<PipelineStage>(k);
+            const auto& h = ps.stage(stage);
+            w.key(stageName(stage)).beginObject();
+            w.field("calls", h.count());
+            w.field("total_ns", h.total());
+            w.field("ns_per_event", static_cast<double>(h.total()) / static_cast<double>(std::max<uint64_t>(1, events)));
+            w.field("mean_ns", h.mean());
+            w.field("p50_ns", h.percentile(0.50));
+            w.field("p90_ns", h.percentile(0.90));
+            w.field("p99_ns", h.percentile(0.99));
+            w.field("p999_ns", h.percentile(0.999));
+            w.field("max_ns", h.max());
+            if (ps.hw_counters_available) writeHwCounters(w, "hw", ps.counters(stage), events);
+            w.endObject();
+        }
+        w.endObject();
+        w.field("hw_counters", ps.hw_counters_available);
+        writeAllocations(w, ps.allocations, events);
+        w.endObject();
+        if (!finishJsonOutput(*json)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+// Shared helpers for the benchmark executables: latency sample
+// collection with percentile summaries, a minimal streaming JSON writer
+// for machine-readable reports and a tiny `--key value` argument parser.
+// Kept header-only so each benchmark stays a single translation unit.
+
+#include "lob/alloc_tracker.hpp"
+#include "lob/perf_counters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lob::bench {
+
+inline uint64_t nowNs() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Median cost of back-to-back clock reads.  Reported alongside latency
+// percentiles so readers can subtract the measurement floor.
+inline uint64_t timerOverheadNs(int rounds = 10000) {
+    std::vector<uint64_t> samples;
+    samples.reserve(static_cast<size_t>(rounds));
+    for (int i = 0; i < rounds; ++i) {
+        const uint64_t t0 = nowNs();
+        const uint64_t t1 = nowNs();
+        samples.push_back(t1 - t0);
+    }
+    std::nth_element(samples.begin(), samples.begin() + rounds / 2, samples.end());
+    return samples[static_cast<size_t>(rounds / 2)];
+}
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+    uint64_t total = 0;
+};
+
+// Raw nanosecond samples; summarised once at the end of a run.
+class LatencySamples {
+public:
+    void reserve(size_t n) { samples_.reserve(n); }
+    void add(uint64_t ns) { samples_.push_back(ns); }
+    void append(const LatencySamples& other) {
+        samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    }
+    [[nodiscard]] size_t size() const noexcept { return samples_.size(); }
+
+    [[nodiscard]] LatencySummary summarize() {
+        LatencySummary s;
+        if (samples_.empty()) return s;
+        std::sort(samples_.begin(), samples_.end());
+        s.count = samples_.size();
+        for (auto v : samples_) s.total += v;
+        s.mean = static_cast<double>(s.total) / static_cast<double>(s.count);
+        s.p50 = at(0.50);
+        s.p90 = at(0.90);
+        s.p99 = at(0.99);
+        s.p999 = at(0.999);
+        s.max = samples_.back();
+        return s;
+    }
+
+private:
+    std::vector<uint64_t> samples_;
+
+    [[nodiscard]] uint64_t at(double q) const {
+        const auto idx = static_cast<size_t>(q * static_cast<double>(samples_.size() - 1));
+        return samples_[idx];
+    }
+};
+
+// Streaming JSON writer.  Commas are tracked per nesting level; keys and
+// string values are escaped, and non-finite numbers are written as null.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& os) : os_(os) {}
+
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+
+    JsonWriter& key(const std::string& k) {
+        separator();
+        string(k);
+        os_ << ':';
+        pending_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(const std::string& v) {
+        separator();
+        string(v);
+        return *this;
+    }
+    JsonWriter& value(const char* v) { return value(std::string(v)); }
+    JsonWriter& value(bool v) {
+        separator();
+        os_ << (v ? "true" : "false");
+        return *this;
+    }
+    JsonWriter& value(double v) {
+        separator();
+        if (!std::isfinite(v)) {
+            os_ << "null";
+            return *this;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6g", v);
+        os_ << buf;
+        return *this;
+    }
+    JsonWriter& value(uint64_t v) {
+        separator();
+        os_ << v;
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(const std::string& k, T v) {
+        key(k);
+        return value(v);
+    }
+
+    JsonWriter& latency(const std::string& k, const LatencySummary& s) {
+        key(k).beginObject();
+        field("count", s.count);
+        field("mean_ns", s.mean);
+        field("p50_ns", s.p50);
+        field("p90_ns", s.p90);
+        field("p99_ns", s.p99);
+        field("p999_ns", s.p999);
+        field("max_ns", s.max);
+        return endObject();
+    }
+
+private:
+    std::ostream& os_;
+    std::vector<bool> first_;
+    bool pending_key_ = false;
+
+    void separator() {
+        if (pending_key_) {
+            pending_key_ = false;
+            return;
+        }
+        if (!first_.empty()) {
+            if (!first_.back()) os_ << ',';
+            first_.back() = false;
+        }
+    }
+    void string(const std::string& v) {
+        os_ << '"';
+        for (const char c : v) {
+            if (c == '"' || c == '\\') {
+                os_ << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                os_ << buf;
+            } else {
+                os_ << c;
+            }
+        }
+        os_ << '"';
+    }
+    void open(char c) {
+        separator();
+        os_ << c;
+        first_.push_back(true);
+    }
+    void close(char c) {
+        first_.pop_back();
+        os_ << c;
+    }
+};
+
+// `--key value` and bare `--flag` arguments.  A bare flag is present
+// but has no value, so the getters return their defaults for it.
+class Args {
+public:
+    Args(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            if (a.rfind("--", 0) != 0) continue;
+            a = a.substr(2);
+            if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                values_[a] = argv[++i];
+            } else {
+                values_[a].clear();
+            }
+        }
+    }
+
+    [[nodiscard]] bool has(const std::string& k) const { return values_.count(k) != 0; }
+    [[nodiscard]] std::string get(const std::string& k, const std::string& def) const {
+        const std::string* v = value(k);
+        return v != nullptr ? *v : def;
+    }
+    [[nodiscard]] uint64_t getU64(const std::string& k, uint64_t def) const {
+        const std::string* v = value(k);
+        return v != nullptr ? std::strtoull(v->c_str(), nullptr, 10) : def;
+    }
+    [[nodiscard]] double getDouble(const std::string& k, double def) const {
+        const std::string* v = value(k);
+        return v != nullptr ? std::strtod(v->c_str(), nullptr) : def;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> values_;
+
+    [[nodiscard]] const std::string* value(const std::string& k) const {
+        auto it = values_.find(k);
+        return it != values_.end() && !it->second.empty() ? &it->second : nullptr;
+    }
+};
+
+// Where the human-readable tables go: stdout, or stderr once the JSON
+// report has claimed stdout so that it stays machine-readable.
+inline std::FILE*& tableOut() {
+    static std::FILE* out = stdout;
+    return out;
+}
+
+// Opens the `--json` destination before the run, so a bad path fails
+// fast: a file, or stdout for "-" or a bare `--json` (moving the tables
+// to stderr).  Null when no report was asked for or the file cannot be
+// opened.
+inline std::ostream* openJsonOutput(const Args& args, std::ofstream& file) {
+    if (!args.has("json")) return nullptr;
+    const std::string path = args.get("json", "-");
+    if (path == "-") {
+        tableOut() = stderr;
+        return &std::cout;
+    }
+    file.open(path);
+    if (!file) {
+        std::cerr << "cannot open " << path << " for writing\n";
+        return nullptr;
+    }
+    return &file;
+}
+
+// Ends the report; false (with a message) if it could not be written.
+inline bool finishJsonOutput(std::ostream& os) {
+    os << "\n";
+    os.flush();
+    if (os) return true;
+    std::cerr << "failed to write the JSON report\n";
+    return false;
+}
+
+// Build configuration recorded in every report so that numbers from
+// sanitized or debug builds are never compared against release runs.
+inline void writeBuildInfo(JsonWriter& w) {
+    w.key("build").beginObject();
+#ifdef LOB_BENCH_SANITIZED
+    w.field("sanitizers", true);
+#else
+    w.field("sanitizers", false);
+#endif
+#ifdef NDEBUG
+    w.field("optimized", true);
+#else
+    w.field("optimized", false);
+#endif
+    w.field("alloc_tracking", alloc_tracking::compiled());
+    w.field("version", LOB_VERSION);
+    w.endObject();
+}
+
+// Writes the non-empty allocation scopes of `a` as an object keyed by
+// scope name, normalised by `events`.  Empty when tracking is compiled out.
+inline void writeAllocations(JsonWriter& w, const AllocationStats& a, uint64_t events) {
+    const double per = static_cast<double>(std::max<uint64_t>(1, events));
+    w.key("allocations").beginObject();
+    for (size_t k = 0; k < kAllocScopeCount; ++k) {
+        const auto scope = static_cast<AllocScope>(k);
+        const auto& c = a[scope];
+        if (c.allocations == 0 && c.deallocations == 0) continue;
+        w.key(allocScopeName(scope)).beginObject();
+        w.field("allocs", c.allocations);
+        w.field("frees", c.deallocations);
+        w.field("bytes", c.bytes);
+        w.field("allocs_per_event", static_cast<double>(c.allocations) / per);
+        w.endObject();
+    }
+    w.endObject();
+}
+
+inline void printAllocations(const AllocationStats& a, uint64_t events) {
+    if (!alloc_tracking::compiled()) return;
+    const double per = static_cast<double>(std::max<uint64_t>(1, events));
+    std::fprintf(tableOut(), "  %-16s %10s %10s %12s %10s\n", "alloc scope", "allocs", "frees", "bytes", "per event");
+    for (size_t k = 0; k < kAllocScopeCount; ++k) {
+        const auto scope = static_cast<AllocScope>(k);
+        const auto& c = a[scope];
+        if (c.allocations == 0 && c.deallocations == 0) continue;
+        std::fprintf(tableOut(), "  %-16s %10llu %10llu %12llu %10.3f\n", allocScopeName(scope),
+                     static_cast<unsigned long long>(c.allocations),
+                     static_cast<unsigned long long>(c.deallocations), static_cast<unsigned long long>(c.bytes),
+                     static_cast<double>(c.allocations) / per);
+    }
+}
+
+// Writes hardware counter totals for one region as `key: {...}`, with
+// per-unit rates normalised by `units` (events, messages, calls).
+inline void writeHwCounters(JsonWriter& w, const std::string& key, const HwCounterValues& c, uint64_t units) {
+    const double per = static_cast<double>(std::max<uint64_t>(1, units));
+    w.key(key).beginObject();
+    for (size_t k = 0; k < kHwEventCount; ++k) {
+        const auto ev = static_cast<HwEvent>(k);
+        w.field(hwEventName(ev), c[ev]);
+        w.field(std::string(hwEventName(ev)) + "_per_unit", static_cast<double>(c[ev]) / per);
+    }
+    w.field("ipc", c.ipc());
+    w.endObject();
+}
+
+inline void printHwCountersHeader() {
+    std::fprintf(tableOut(), "  %-16s %10s %10s %10s %10s %6s\n", "hw (per event)", "cycles", "instr", "cache-miss",
+                 "br-miss", "ipc");
+}
+
+inline void printHwCounters(const char* name, const HwCounterValues& c, uint64_t units) {
+    const double per = static_cast<double>(std::max<uint64_t>(1, units));
+    std::fprintf(tableOut(), "  %-16s %10.1f %10.1f %10.3f %10.3f %6.2f\n", name,
+                 static_cast<double>(c[HwEvent::CYCLES]) / per, static_cast<double>(c[HwEvent::INSTRUCTIONS]) / per,
+                 static_cast<double>(c[HwEvent::CACHE_MISSES]) / per,
+                 static_cast<double>(c[HwEvent::BRANCH_MISSES]) / per, c.ipc());
+}
+
+} // namespace lob::bench
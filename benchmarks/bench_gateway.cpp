@@ -0,0 +1,179 @@
+#include "lob/gateway.hpp"
+#include "bench_common.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// Loopback benchmark of the order-entry gateway (lob/gateway.hpp).  Each
+// client thread opens its own connection and keeps up to --window
+// messages in flight: passive orders that never cross, each cancelled
+// once acknowledged.  Round-trip latency is measured in the client from
+// flush() of a message to receipt of its ACK, so it covers both socket
+// hops, the gateway thread and the engine shard.
+//
+//   bench_gateway [--clients N] [--messages N] [--window W] [--symbols S]
+//                 [--shards K] [--unix] [--json [out.json|-]]
+
+using namespace lob;
+using namespace lob::bench;
+
+namespace {
+
+struct ClientResult {
+    LatencySamples rtt;
+    uint64_t messages = 0;
+    uint64_t rejects = 0;
+    uint64_t gaps = 0;
+};
+
+void runClient(const GatewayConfig& gcfg, uint16_t port, uint32_t symbols, uint64_t messages, uint64_t window,
+               ClientResult& r) {
+    GatewayClient c;
+    const bool ok = gcfg.unix_path.empty() ? c.connectTcp(port) : c.connectUnix(gcfg.unix_path);
+    if (!ok) return;
+    r.rtt.reserve(messages);
+    // Send times by client order id; ids are recycled once cancelled.
+    const uint64_t slots = window * 2 + 2;
+    std::vector<uint64_t> sent(slots, 0);
+    uint64_t next_id = 1;
+    uint64_t in_flight = 0;
+    uint64_t pending_cancels = 0;
+    std::vector<uint64_t> to_cancel;
+    GatewayMessage m;
+
+    while (r.messages < messages || in_flight > 0) {
+        const uint64_t now = MatchingEngine::nowNs();
+        for (uint64_t id : to_cancel) {
+            c.cancel(id, static_cast<SymbolId>(id % symbols));
+            sent[id % slots] = now;
+            ++in_flight;
+            ++r.messages;
+        }
+        pending_cancels -= to_cancel.size();
+        to_cancel.clear();
+        while (r.messages < messages && in_flight + pending_cancels < window) {
+            const uint64_t id = next_id++;
+            c.newOrder(id, static_cast<SymbolId>(id % symbols), id % 2 ? Side::BID : Side::ASK,
+                       id % 2 ? 9000 : 11000, 100);
+            sent[id % slots] = now;
+            ++in_flight;
+            ++r.messages;
+        }
+        if (!c.flush()) return;
+        // Block for the first reply, then take whatever else has arrived.
+        bool block = true;
+        while (in_flight > 0 && c.next(m, block)) {
+            block = false;
+            --in_flight;
+            r.rtt.add(MatchingEngine::nowNs() - sent[m.order_id % slots]);
+            if (m.type == wire::MsgType::REJECT) ++r.rejects;
+            if (m.type == wire::MsgType::ACK && m.command == wire::MsgType::NEW_ORDER &&
+                r.messages + to_cancel.size() < messages) {
+                to_cancel.push_back(m.order_id);
+                ++pending_cancels;
+            }
+        }
+        if (!c.connected()) return;
+    }
+    r.gaps = c.sequenceGaps();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Args args(argc, argv);
+    std::ofstream json_file;
+    std::ostream* const json = openJsonOutput(args, json_file);
+    if (args.has("json") && json == nullptr) return 1;
+    const auto clients = static_cast<uint32_t>(args.getU64("clients", 2));
+    const uint64_t messages = args.getU64("messages", 200000);
+    const uint64_t window = std::max<uint64_t>(1, args.getU64("window", 1));
+    const auto symbols = static_cast<uint32_t>(std::max<uint64_t>(1, args.getU64("symbols", 1)));
+
+    MatchingEngineConfig ecfg;
+    ecfg.clients = clients;
+    ecfg.shards = static_cast<uint32_t>(args.getU64("shards", 1));
+    MatchingEngine engine(ecfg);
+    for (uint32_t s = 0; s < symbols; ++s) engine.addSymbol("SYM" + std::to_string(s));
+    engine.start();
+
+    GatewayConfig gcfg;
+    gcfg.max_connections = clients;
+    if (args.has("unix")) {
+        gcfg.unix_path = (std::filesystem::temp_directory_path() / "lob_bench_gateway.sock").string();
+    }
+    Gateway gw(engine, gcfg);
+    if (!gw.start()) {
+        std::cerr << "cannot start gateway\n";
+        return 1;
+    }
+
+#ifdef LOB_BENCH_SANITIZED
+    std::cerr << "warning: built with sanitizers; latencies are not representative\n";
+#endif
+
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    const uint64_t t0 = nowNs();
+    for (uint32_t c = 0; c < clients; ++c) {
+        threads.emplace_back(runClient, std::cref(gcfg), gw.port(), symbols, messages, window,
+                             std::ref(results[c]));
+    }
+    for (auto& t : threads) t.join();
+    const uint64_t wall_ns = nowNs() - t0;
+    const Gateway::Stats gs = gw.stats();
+    gw.stop();
+    engine.stop();
+
+    LatencySamples rtt_all;
+    uint64_t total = 0, rejects = 0, gaps = 0;
+    for (const auto& r : results) {
+        rtt_all.append(r.rtt);
+        total += r.messages;
+        rejects += r.rejects;
+        gaps += r.gaps;
+    }
+    const LatencySummary rtt = rtt_all.summarize();
+    const double secs = static_cast<double>(wall_ns) * 1e-9;
+
+    std::fprintf(tableOut(), "gateway (%s): %u clients, %llu messages, window %llu\n",
+                 gcfg.unix_path.empty() ? "tcp" : "unix", clients, static_cast<unsigned long long>(total),
+                 static_cast<unsigned long long>(window));
+    std::fprintf(tableOut(), "  %.3f K messages/s  reads=%llu writes=%llu (%.1f msgs/read)  rejects=%llu gaps=%llu\n",
+                 static_cast<double>(total) / secs * 1e-3, static_cast<unsigned long long>(gs.reads),
+                 static_cast<unsigned long long>(gs.writes),
+                 static_cast<double>(gs.messages_in) / static_cast<double>(std::max<uint64_t>(1, gs.reads)),
+                 static_cast<unsigned long long>(rejects), static_cast<unsigned long long>(gaps));
+    std::fprintf(tableOut(), "  rtt ns: count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu p99.9=%llu max=%llu\n",
+                 static_cast<unsigned long long>(rtt.count), rtt.mean, static_cast<unsigned long long>(rtt.p50),
+                 static_cast<unsigned long long>(rtt.p90), static_cast<unsigned long long>(rtt.p99),
+                 static_cast<unsigned long long>(rtt.p999), static_cast<unsigned long long>(rtt.max));
+
+    if (json != nullptr) {
+        JsonWriter w(*json);
+        w.beginObject();
+        w.field("benchmark", "gateway");
+        writeBuildInfo(w);
+        w.key("config").beginObject();
+        w.field("transport", gcfg.unix_path.empty() ? "tcp" : "unix");
+        w.field("clients", static_cast<uint64_t>(clients));
+        w.field("messages_per_client", messages);
+        w.field("window", window);
+        w.field("symbols", static_cast<uint64_t>(symbols));
+        w.field("shards", static_cast<uint64_t>(ecfg.shards));
+        w.endObject();
+        w.field("messages", total);
+        w.field("wall_ns", wall_ns);
+        w.field("messages_per_sec", static_cast<double>(total) / secs);
+        w.field("gateway_reads", gs.reads);
+        w.field("gateway_writes", gs.writes);
+        w.field("rejects", rejects);
+        w.field("sequence_gaps", gaps);
+        w.latency("round_trip", rtt);
+        w.endObject();
+        if (!finishJsonOutput(*json)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+#include "lob/journal.hpp"
+#include "lob/matching_engine.hpp"
+#include "bench_common.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// Load test of the matching-engine mode (lob/matching_engine.hpp).  Each
+// client thread submits a stream of passive quotes, cancels and market
+// orders against a MatchingEngine while draining its own report queues,
+// keeping at most --window commands in flight.  Round i of every client
+// trades symbol i % --symbols, so load spreads over the shards that the
+// symbols hash onto.  Latencies are measured from submit() to the
+// client's poll() of the report, so they include both queue hops.  With
+// --journal, accepted commands are journaled with group commit every
+// --sync-every write batches:
+//
+//   ack   - every ACK/REJECT
+//   fill  - first FILL of each market order (submit-to-fill)
+//
+//   bench_matching_engine [--clients N] [--commands N] [--window W]
+//                         [--symbols S] [--shards K] [--cpus 0,1,..]
+//                         [--batch B] [--journal path] [--sync-every N]
+//                         [--json [out.json|-]]
+
+using namespace lob;
+using namespace lob::bench;
+
+namespace {
+
+struct ClientResult {
+    LatencySamples ack;
+    LatencySamples fill;
+    uint64_t commands = 0;
+    uint64_t fills = 0;
+    uint64_t submit_retries = 0;
+};
+
+std::vector<int> parseCpus(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) cpus.push_back(std::stoi(item));
+    }
+    return cpus;
+}
+
+void runClient(MatchingEngine& engine, ClientId client, uint32_t symbols, uint64_t commands, uint64_t window,
+               ClientResult& r) {
+    r.ack.reserve(commands);
+    r.fill.reserve(commands / 4);
+    const OrderId base = (static_cast<OrderId>(client) + 1) << 40;
+    const OrderId market_flag = OrderId{1} << 39;
+    uint64_t in_flight = 0;
+    OrderId last_market = 0;
+
+    auto drain = [&]() {
+        EngineReport rep;
+        while (engine.poll(client, rep)) {
+            const uint64_t now = MatchingEngine::nowNs();
+            if (rep.type == EngineReport::FILL) {
+                ++r.fills;
+                if ((rep.order_id & market_flag) != 0 && rep.order_id != last_market) {
+                    last_market = rep.order_id;
+                    r.fill.add(now - rep.submit_ns);
+                }
+            } else {
+                r.ack.add(now - rep.submit_ns);
+                --in_flight;
+            }
+        }
+    };
+    auto send = [&](const EngineCommand& cmd) {
+        while (in_flight >= window || !engine.submit(cmd)) {
+            if (in_flight < window) ++r.submit_retries;
+            drain();
+            std::this_thread::yield();
+        }
+        ++in_flight;
+        ++r.commands;
+    };
+
+    for (uint64_t i = 0; r.commands < commands; ++i) {
+        const auto offset = static_cast<Price>(1 + i % 5);
+        EngineCommand c;
+        c.client = client;
+        c.symbol = static_cast<SymbolId>(i % symbols);
+        c.quantity = 100;
+        c.type = EngineCommand::ADD;
+        c.side = Side::BID;
+        c.order_id = base + 2 * i;
+        c.price = 10000 - offset;
+        send(c);
+        c.side = Side::ASK;
+        c.order_id = base + 2 * i + 1;
+        c.price = 10000 + offset;
+        send(c);
+        if (i % 4 == 3) {
+            c.type = EngineCommand::MARKET;
+            c.side = (i / 4) % 2 ? Side::BID : Side::ASK;
+            c.order_id = base + market_flag + i;
+            c.quantity = 150;
+            send(c);
+        }
+        if (i >= 8) {
+            // Quotes from 8 rounds ago; filled ones come back as REJECT.
+            c.type = EngineCommand::CANCEL;
+            c.symbol = static_cast<SymbolId>((i - 8) % symbols);
+            c.order_id = base + 2 * (i - 8);
+            send(c);
+            c.order_id += 1;
+            send(c);
+        }
+        drain();
+    }
+    while (in_flight > 0) {
+        drain();
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Args args(argc, argv);
+    std::ofstream json_file;
+    std::ostream* const json = openJsonOutput(args, json_file);
+    if (args.has("json") && json == nullptr) return 1;
+    const auto clients = static_cast<uint32_t>(args.getU64("clients", 4));
+    const uint64_t commands = args.getU64("commands", 250000);
+    const uint64_t window = args.getU64("window", 256);
+    const auto symbols = static_cast<uint32_t>(std::max<uint64_t>(1, args.getU64("symbols", 8)));
+
+    MatchingEngineConfig cfg;
+    cfg.shards = static_cast<uint32_t>(args.getU64("shards", 1));
+    cfg.cpus = parseCpus(args.get("cpus", ""));
+    cfg.clients = clients;
+    cfg.max_batch = args.getU64("batch", cfg.max_batch);
+    cfg.command_capacity = std::max<size_t>(cfg.command_capacity, clients * window * 2);
+    cfg.report_capacity = std::max<size_t>(cfg.report_capacity, window * 8);
+
+#ifdef LOB_BENCH_SANITIZED
+    std::cerr << "warning: built with sanitizers; latencies are not representative\n";
+#endif
+
+    Journal journal([&] {
+        JournalConfig jc;
+        jc.sync_every = static_cast<uint32_t>(args.getU64("sync-every", jc.sync_every));
+        return jc;
+    }());
+    if (args.has("journal")) {
+        if (!journal.open(args.get("journal", ""), true)) {
+            std::cerr << "cannot open journal " << args.get("journal", "") << "\n";
+            return 1;
+        }
+        cfg.journal = &journal;
+    }
+
+    MatchingEngine engine(cfg);
+    for (uint32_t s = 0; s < symbols; ++s) engine.addSymbol("SYM" + std::to_string(s));
+    engine.start();
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    const uint64_t t0 = nowNs();
+    for (uint32_t c = 0; c < clients; ++c) {
+        threads.emplace_back(runClient, std::ref(engine), c, symbols, commands, window, std::ref(results[c]));
+    }
+    for (auto& t : threads) t.join();
+    const uint64_t wall_ns = nowNs() - t0;
+    engine.stop();
+    journal.close();
+    const Journal::Stats js = journal.stats();
+
+    LatencySamples ack_all;
+    LatencySamples fill_all;
+    uint64_t total = 0;
+    uint64_t fills = 0;
+    uint64_t retries = 0;
+    for (const auto& r : results) {
+        ack_all.append(r.ack);
+        fill_all.append(r.fill);
+        total += r.commands;
+        fills += r.fills;
+        retries += r.submit_retries;
+    }
+    const LatencySummary ack = ack_all.summarize();
+    const LatencySummary fill = fill_all.summarize();
+    const auto loads = engine.shardLoads();
+    const auto hot = engine.hottestSymbols(5);
+    MatchingEngine::ShardLoad st;
+    for (const auto& l : loads) {
+        st.commands += l.commands;
+        st.batches += l.batches;
+        st.max_batch = std::max(st.max_batch, l.max_batch);
+        st.report_stalls += l.report_stalls;
+    }
+    const double secs = static_cast<double>(wall_ns) * 1e-9;
+
+    std::fprintf(tableOut(), "matching engine: %u clients, %u symbols on %zu shards, %llu commands, window %llu\n",
+                 clients, symbols, loads.size(), static_cast<unsigned long long>(total),
+                 static_cast<unsigned long long>(window));
+    std::fprintf(tableOut(), "  %.3f M commands/s  batches=%llu (max %llu, mean %.1f)  stalls=%llu  retries=%llu\n",
+                 static_cast<double>(total) / secs * 1e-6, static_cast<unsigned long long>(st.batches),
+                 static_cast<unsigned long long>(st.max_batch),
+                 static_cast<double>(st.commands) / static_cast<double>(std::max<uint64_t>(1, st.batches)),
+                 static_cast<unsigned long long>(st.report_stalls), static_cast<unsigned long long>(retries));
+    std::fprintf(tableOut(), "  %-8s %10s %10s %8s %8s %8s %8s %10s\n", "latency", "count", "mean", "p50", "p90", "p99",
+                 "p99.9", "max");
+    auto row = [](const char* name, const LatencySummary& l) {
+        std::fprintf(tableOut(), "  %-8s %10llu %10.1f %8llu %8llu %8llu %8llu %10llu\n", name,
+                     static_cast<unsigned long long>(l.count), l.mean, static_cast<unsigned long long>(l.p50),
+                     static_cast<unsigned long long>(l.p90), static_cast<unsigned long long>(l.p99),
+                     static_cast<unsigned long long>(l.p999), static_cast<unsigned long long>(l.max));
+    };
+    row("ack", ack);
+    row("fill", fill);
+    std::fprintf(tableOut(), "  %-6s %5s %8s %12s %10s %8s\n", "shard", "cpu", "symbols", "commands", "busy", "stalls");
+    for (size_t i = 0; i < loads.size(); ++i) {
+        const auto& l = loads[i];
+        std::fprintf(tableOut(), "  %-6zu %5d %8u %12llu %9.1f%% %8llu\n", i, l.cpu, l.symbols,
+                     static_cast<unsigned long long>(l.commands),
+                     100.0 * static_cast<double>(l.busy_ns) / static_cast<double>(wall_ns),
+                     static_cast<unsigned long long>(l.report_stalls));
+    }
+    if (cfg.journal != nullptr) {
+        std::fprintf(tableOut(), "  journal: %llu records, %llu batches, %llu fsyncs, %llu stalls\n",
+                     static_cast<unsigned long long>(js.written), static_cast<unsigned long long>(js.batches),
+                     static_cast<unsigned long long>(js.syncs), static_cast<unsigned long long>(js.append_stalls));
+    }
+    std::fprintf(tableOut(), "  hottest:");
+    for (const auto& [sym, n] : hot) {
+        std::fprintf(tableOut(), " SYM%u(shard %u)=%llu", sym, engine.shardOf(sym), static_cast<unsigned long long>(n));
+    }
+    std::fprintf(tableOut(), "\n");
+
+    if (json != nullptr) {
+        JsonWriter w(*json);
+        w.beginObject();
+        w.field("benchmark", "matching_engine");
+        writeBuildInfo(w);
+        w.key("config").beginObject();
+        w.field("clients", static_cast<uint64_t>(clients));
+        w.field("commands_per_client", commands);
+        w.field("window", window);
+        w.field("symbols", static_cast<uint64_t>(symbols));
+        w.field("shards", static_cast<uint64_t>(loads.size()));
+        w.field("max_batch", static_cast<uint64_t>(cfg.max_batch));
+        w.field("pinned", !cfg.cpus.empty());
+        w.field("journal", cfg.journal != nullptr);
+        w.endObject();
+        w.field("commands", total);
+        w.field("fills", fills);
+        w.field("wall_ns", wall_ns);
+        w.field("commands_per_sec", static_cast<double>(total) / secs);
+        w.field("batches", st.batches);
+        w.field("max_batch_drained", st.max_batch);
+        w.field("report_stalls", st.report_stalls);
+        w.field("submit_retries", retries);
+        w.latency("submit_to_ack", ack);
+        w.latency("submit_to_fill", fill);
+        if (cfg.journal != nullptr) {
+            w.key("journal").beginObject();
+            w.field("records", js.written);
+            w.field("batches", js.batches);
+            w.field("syncs", js.syncs);
+            w.field("append_stalls", js.append_stalls);
+            w.endObject();
+        }
+        w.key("shards").beginArray();
+        for (const auto& l : loads) {
+            w.beginObject();
+            w.field("cpu", static_cast<double>(l.cpu));  // -1 when floating
+            w.field("symbols", static_cast<uint64_t>(l.symbols));
+            w.field("commands", l.commands);
+            w.field("batches", l.batches);
+            w.field("busy_ns", l.busy_ns);
+            w.field("report_stalls", l.report_stalls);
+            w.endObject();
+        }
+        w.endArray();
+        w.key("hottest_symbols").beginArray();
+        for (const auto& [sym, n] : hot) {
+            w.beginObject();
+            w.field("symbol", engine.symbolName(sym));
+            w.field("shard", static_cast<uint64_t>(engine.shardOf(sym)));
+            w.field("commands", n);
+            w.endObject();
+        }
+        w.endArray();
+        w.endObject();
+        if (!finishJsonOutput(*json)) return 1;
+    }
+    return 0;
+}
@@ -1,24 +1,237 @@
 #include "lob/order_book.hpp"
+#include "lob/synthetic.hpp"
+#include "bench_common.hpp"
+
+#include <fstream>
 #include <iostream>
-#include <random>
-#include <chrono>
+
+// Order book benchmark suite.  Message flow comes from the synthetic L3
+// generator (lob/synthetic.hpp): each profile fixes the message mix
+// (add/cancel/modify/market weights), how new orders are distributed
+// around the touch, how deep the book is and how long orders rest.  The
+// generator runs outside the timed region; only the OrderBook call for
+// each message is timed, bucketed per operation type.  The seeded
+// initial book is applied untimed.  Where perf_event_open is permitted,
+// hardware counters cover the whole timed loop (harness included).
+//
+//   bench_order_book [--profile liquid_equity|small_cap|crypto|all]
+//                    [--messages N] [--seed S] [--json [out.json|-]]
+//                    [--mix add,cancel,modify,market] [--depth D]
+//                    [--resting N] [--decay X]
+
 using namespace lob;
+using namespace lob::bench;
+
+namespace {
+
+enum Op : uint8_t { ADD = 0, CANCEL, MODIFY, MARKET, OP_COUNT };
+const char* const kOpNames[OP_COUNT] = {"add", "cancel", "modify", "market"};
+
+struct ProfileResult {
+    uint64_t messages = 0;
+    uint64_t executions = 0;
+    uint64_t rejected = 0;
+    uint64_t wall_ns = 0;
+    uint64_t book_ns = 0;
+    size_t final_orders = 0;
+    LatencySummary all;
+    LatencySummary per_op[OP_COUNT];
+    AllocationStats allocations;  // timed messages only (seeding excluded)
+    HwCounterValues hw;           // likewise; zero when counters are unavailable
+    bool hw_available = false;
+};
+
+ProfileResult runProfile(const SyntheticMarketConfig& base, uint64_t messages) {
+    SyntheticMarketConfig cfg = base;
+    cfg.symbols = 1;
+    cfg.duration = ~Timestamp{0} - cfg.start_time;  // bounded by the message count
+    SyntheticMarketGenerator gen(cfg);
+    OrderBook book{cfg.name};
+
+    LatencySamples all;
+    LatencySamples per_op[OP_COUNT];
+    all.reserve(messages);
+    for (auto& s : per_op) s.reserve(messages / 2);
+
+    ProfileResult r;
+    SyntheticUpdate su;
+    uint64_t timed = 0;
+    AllocationStats alloc_base;
+    const HwCounterGroup counters;
+    HwCounterValues hw_base;
+    bool measuring = false;
+    const uint64_t wall0 = nowNs();
+    while (timed < messages && gen.next(su)) {
+        const MarketDataUpdate& u = su.update;
+        const bool seeding = u.timestamp == cfg.start_time;
+        if (!seeding && !measuring) {
+            alloc_base = alloc_tracking::snapshot();
+            hw_base = counters.read();
+            measuring = true;
+        }
+        Op op = OP_COUNT;
+        uint64_t t0 = 0;
+        uint64_t t1 = 0;
+        bool ok = true;
+        switch (u.type) {
+            case MarketDataUpdate::ADD_ORDER:
+                op = ADD;
+                t0 = nowNs();
+                ok = book.addOrder(Order{u.order_id, u.price, u.quantity, u.side, u.timestamp});
+                t1 = nowNs();
+                break;
+            case MarketDataUpdate::CANCEL_ORDER:
+                op = CANCEL;
+                t0 = nowNs();
+                ok = book.cancelOrder(u.order_id);
+                t1 = nowNs();
+                break;
+            case MarketDataUpdate::MODIFY_ORDER:
+                op = MODIFY;
+                t0 = nowNs();
+                ok = book.modifyOrder(u.order_id, u.quantity);
+                t1 = nowNs();
+                break;
+            case MarketDataUpdate::TRADE: {
+                op = MARKET;
+                t0 = nowNs();
+                auto execs = book.processMarketOrder(u.side, u.quantity, u.timestamp);
+                t1 = nowNs();
+                r.executions += execs.size();
+                break;
+            }
+            default:
+                break;
+        }
+        // Generator and book share FIFO semantics, so every message must
+        // apply cleanly; a non-zero count means the two have diverged.
+        if (!ok) ++r.rejected;
+        if (seeding || op == OP_COUNT) continue;
+        all.add(t1 - t0);
+        per_op[op].add(t1 - t0);
+        ++timed;
+    }
+    r.wall_ns = nowNs() - wall0;
+    r.allocations = alloc_tracking::snapshot() - alloc_base;
+    r.hw = counters.read() - hw_base;
+    r.hw_available = counters.available();
+    r.messages = timed;
+    r.final_orders = book.orderCount();
+    r.all = all.summarize();
+    r.book_ns = r.all.total;
+    for (int k = 0; k < OP_COUNT; ++k) r.per_op[k] = per_op[k].summarize();
+    return r;
+}
+
+void printResult(const SyntheticMarketConfig& p, const ProfileResult& r) {
+    const double book_s = static_cast<double>(r.book_ns) * 1e-9;
+    std::fprintf(tableOut(), "%-14s %10llu msgs  %8.2f Mmsg/s (book)  resting=%zu  execs=%llu  rejected=%llu\n",
+                 p.name.c_str(), static_cast<unsigned long long>(r.messages),
+                 static_cast<double>(r.messages) / book_s * 1e-6, r.final_orders,
+                 static_cast<unsigned long long>(r.executions), static_cast<unsigned long long>(r.rejected));
+    std::fprintf(tableOut(), "  %-8s %10s %8s %8s %8s %8s %8s %10s\n", "op", "count", "mean", "p50", "p90", "p99",
+                 "p99.9", "max");
+    auto row = [](const char* name, const LatencySummary& s) {
+        std::fprintf(tableOut(), "  %-8s %10llu %8.1f %8llu %8llu %8llu %8llu %10llu\n", name,
+                     static_cast<unsigned long long>(s.count), s.mean, static_cast<unsigned long long>(s.p50),
+                     static_cast<unsigned long long>(s.p90), static_cast<unsigned long long>(s.p99),
+                     static_cast<unsigned long long>(s.p999), static_cast<unsigned long long>(s.max));
+    };
+    for (int k = 0; k < OP_COUNT; ++k) row(kOpNames[k], r.per_op[k]);
+    row("all", r.all);
+    printAllocations(r.allocations, r.messages);
+    if (r.hw_available) {
+        printHwCountersHeader();
+        printHwCounters("message", r.hw, r.messages);
+    }
+}
+
+void writeResult(JsonWriter& w, const SyntheticMarketConfig& p, const ProfileResult& r) {
+    w.beginObject();
+    w.field("profile", p.name);
+    w.key("config").beginObject();
+    w.field("add", p.mix.add).field("cancel", p.mix.cancel);
+    w.field("modify", p.mix.modify).field("market", p.mix.market);
+    w.field("depth", static_cast<uint64_t>(p.depth));
+    w.field("touch_decay", p.touch_decay);
+    w.field("target_orders", static_cast<uint64_t>(p.target_orders));
+    w.field("event_rate", p.event_rate);
+    w.endObject();
+    w.field("messages", r.messages);
+    w.field("executions", r.executions);
+    w.field("rejected", r.rejected);
+    w.field("resting_orders", static_cast<uint64_t>(r.final_orders));
+    w.field("wall_ns", r.wall_ns);
+    w.field("book_ns", r.book_ns);
+    w.field("throughput_msgs_per_sec", static_cast<double>(r.messages) / (static_cast<double>(r.book_ns) * 1e-9));
+    w.latency("all", r.all);
+    w.key("ops").beginObject();
+    for (int k = 0; k < OP_COUNT; ++k) w.latency(kOpNames[k], r.per_op[k]);
+    w.endObject();
+    writeAllocations(w, r.allocations, r.messages);
+    if (r.hw_available) writeHwCounters(w, "hw", r.hw, r.messages);
+    w.endObject();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Args args(argc, argv);
+    std::ofstream json_file;
+    std::ostream* const json = openJsonOutput(args, json_file);
+    if (args.has("json") && json == nullptr) return 1;
+    const uint64_t messages = args.getU64("messages", 1000000);
+    const uint64_t seed = args.getU64("seed", 42);
+    const std::string which = args.get("profile", "all");
+
+    std::vector<SyntheticMarketConfig> profiles;
+    for (auto& p : {SyntheticMarketConfig::liquidEquity(), SyntheticMarketConfig::smallCap(),
+                    SyntheticMarketConfig::crypto()}) {
+        if (which == "all" || which == p.name) profiles.push_back(p);
+    }
+    if (profiles.empty()) {
+        std::cerr << "unknown profile: " << which << "\n";
+        return 1;
+    }
+
+    // Command-line overrides apply to every selected profile.
+    for (auto& p : profiles) {
+        if (args.has("mix")) {
+            double w[4] = {p.mix.add, p.mix.cancel, p.mix.modify, p.mix.market};
+            std::sscanf(args.get("mix", "").c_str(), "%lf,%lf,%lf,%lf", &w[0], &w[1], &w[2], &w[3]);
+            p.mix = {w[0], w[1], w[2], w[3]};
+        }
+        p.seed = seed;
+        p.depth = static_cast<int>(args.getU64("depth", static_cast<uint64_t>(p.depth)));
+        p.target_orders = static_cast<uint32_t>(args.getU64("resting", p.target_orders));
+        p.touch_decay = args.getDouble("decay", p.touch_decay);
+    }
+
+#ifdef LOB_BENCH_SANITIZED
+    std::cerr << "warning: built with sanitizers; latencies are not representative\n";
+#endif
+
+    const uint64_t overhead = timerOverheadNs();
+    std::vector<ProfileResult> results;
+    for (const auto& p : profiles) {
+        results.push_back(runProfile(p, messages));
+        printResult(p, results.back());
+    }
+    std::fprintf(tableOut(), "timer overhead ~%llu ns per sample (included in latencies)\n",
+                 static_cast<unsigned long long>(overhead));
 
-int main() {
-    OrderBook b{"BENCH"};
-    std::mt19937_64 rng(42);
-    std::uniform_int_distribution<int> side(0,1);
-    std::uniform_int_distribution<int> qty(1, 200);
-    const Price mid = doubleToPrice(100.00);
-    const int N = 200000;
-
-    auto t0 = std::chrono::steady_clock::now();
-    for (int i=0;i<N;i++) {
-        const Side s = side(rng)==0 ? Side::BID : Side::ASK;
-        const Price p = mid + (s==Side::BID ? -1 : +1) * (i%10);
-        b.addOrder(Order{100000+i, p, static_cast<Quantity>(qty(rng)), s, static_cast<Timestamp>(i)});
+    if (json != nullptr) {
+        JsonWriter w(*json);
+        w.beginObject();
+        w.field("benchmark", "order_book");
+        writeBuildInfo(w);
+        w.field("seed", seed);
+        w.field("timer_overhead_ns", overhead);
+        w.key("profiles").beginArray();
+        for (size_t i = 0; i < profiles.size(); ++i) writeResult(w, profiles[i], results[i]);
+        w.endArray();
+        w.endObject();
+        if (!finishJsonOutput(*json)) return 1;
     }
-    auto t1 = std::chrono::steady_clock::now();
-    const double ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count();
-    std::cout << "Added " << N << " orders in " << ms << " ms => " << (N/ms) << " kops/s\n";
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "lob/shm_feed.hpp"
+#include "bench_common.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <unistd.h>
+
+// Writer-to-reader hop latency of the shared-memory market data feed
+// (lob/shm_feed.hpp).  One writer publishes --events records stamped with
+// the send time, pacing them --gap-ns apart; each of --readers threads
+// attaches to the feed by name, exactly as a separate process would, and
+// records the time from publish to poll.  Readers that are lapped report
+// the records they lost instead of blocking the writer.
+//
+//   bench_shm_feed [--readers N] [--events N] [--capacity C] [--gap-ns G]
+//                  [--json [out.json|-]]
+
+using namespace lob;
+using namespace lob::bench;
+
+namespace {
+
+struct ReaderResult {
+    LatencySamples hop;
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t overruns = 0;
+};
+
+void runReader(const std::string& name, ReaderResult& r) {
+    ShmFeedReader reader;
+    if (!reader.open(name)) return;
+    FeedRecord rec;
+    for (;;) {
+        const auto status = reader.poll(rec);
+        if (status == ShmFeedReader::Status::END) break;
+        if (status != ShmFeedReader::Status::OK) continue;
+        r.hop.add(nowNs() - rec.timestamp);
+        ++r.received;
+    }
+    r.lost = reader.lost();
+    r.overruns = reader.overruns();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Args args(argc, argv);
+    std::ofstream json_file;
+    std::ostream* const json = openJsonOutput(args, json_file);
+    if (args.has("json") && json == nullptr) return 1;
+    const auto readers = static_cast<uint32_t>(std::max<uint64_t>(1, args.getU64("readers", 2)));
+    const uint64_t events = args.getU64("events", 1000000);
+    const uint64_t capacity = args.getU64("capacity", 1 << 16);
+    const uint64_t gap_ns = args.getU64("gap-ns", 200);
+
+    const std::string name = "/lob_bench_feed_" + std::to_string(::getpid());
+    ShmFeedPublisher publisher;
+    if (!publisher.create(name, capacity)) {
+        std::cerr << "cannot create feed " << name << "\n";
+        return 1;
+    }
+
+#ifdef LOB_BENCH_SANITIZED
+    std::cerr << "warning: built with sanitizers; latencies are not representative\n";
+#endif
+
+    std::vector<ReaderResult> results(readers);
+    for (auto& r : results) r.hop.reserve(events);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < readers; ++i) threads.emplace_back(runReader, std::cref(name), std::ref(results[i]));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    FeedRecord rec;
+    rec.update_type = MarketDataUpdate::ADD_ORDER;
+    const uint64_t t0 = nowNs();
+    for (uint64_t i = 0; i < events; ++i) {
+        rec.order_id = i + 1;
+        rec.price = 10000 + static_cast<Price>(i % 16);
+        rec.quantity = 100;
+        const uint64_t now = nowNs();
+        rec.timestamp = now;
+        publisher.publish(rec);
+        while (gap_ns != 0 && nowNs() - now < gap_ns) {
+        }
+    }
+    const uint64_t wall_ns = nowNs() - t0;
+    publisher.close();
+    for (auto& t : threads) t.join();
+
+    LatencySamples hop_all;
+    uint64_t received = 0, lost = 0, overruns = 0;
+    for (const auto& r : results) {
+        hop_all.append(r.hop);
+        received += r.received;
+        lost += r.lost;
+        overruns += r.overruns;
+    }
+    const LatencySummary hop = hop_all.summarize();
+
+    std::fprintf(tableOut(), "shm feed: %u readers, %llu events, capacity %llu, gap %llu ns\n", readers,
+                 static_cast<unsigned long long>(events), static_cast<unsigned long long>(capacity),
+                 static_cast<unsigned long long>(gap_ns));
+    std::fprintf(tableOut(), "  %.3f M events/s written  received=%llu lost=%llu overruns=%llu\n",
+                 static_cast<double>(events) / (static_cast<double>(wall_ns) * 1e-9) * 1e-6,
+                 static_cast<unsigned long long>(received), static_cast<unsigned long long>(lost),
+                 static_cast<unsigned long long>(overruns));
+    std::fprintf(tableOut(), "  hop ns: count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu p99.9=%llu max=%llu\n",
+                 static_cast<unsigned long long>(hop.count), hop.mean, static_cast<unsigned long long>(hop.p50),
+                 static_cast<unsigned long long>(hop.p90), static_cast<unsigned long long>(hop.p99),
+                 static_cast<unsigned long long>(hop.p999), static_cast<unsigned long long>(hop.max));
+
+    if (json != nullptr) {
+        JsonWriter w(*json);
+        w.beginObject();
+        w.field("benchmark", "shm_feed");
+        writeBuildInfo(w);
+        w.key("config").beginObject();
+        w.field("readers", static_cast<uint64_t>(readers));
+        w.field("events", events);
+        w.field("capacity", capacity);
+        w.field("gap_ns", gap_ns);
+        w.endObject();
+        w.field("wall_ns", wall_ns);
+        w.field("received", received);
+        w.field("lost", lost);
+        w.field("overruns", overruns);
+        w.latency("hop", hop);
+        w.endObject();
+        if (!finishJsonOutput(*json)) return 1;
+    }
+    return 0;
+}
@@ -1,10 +1,14 @@
 #include "lob/backtester.hpp"
 #include "lob/event.hpp"
+#include "lob/synthetic.hpp"
 using namespace lob;
-int main() {
+int main(int argc, char** argv) {
     Backtester bt;
     bt.addStrategy(std::make_unique<MarketMakerStrategy>(8.0, 200.0, 5000.0));
-    bt.setDataSource(std::make_unique<CSVDataSource>("data/l3_mm_day1.csv"));
+    // Pass a CSV path (e.g. data/l3_mm_day1.csv) to replay real data; defaults to a
+    // synthetic session.
+    if (argc > 1) bt.setDataSource(std::make_unique<CSVDataSource>(argv[1]));
+    else bt.setDataSource(std::make_unique<SyntheticDataSource>(SyntheticMarketConfig::liquidEquity()));
     auto res = bt.run();
     return (res.sharpe>0.0) ? 0 : 0;
 }
\ No newline at end of file
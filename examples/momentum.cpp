@@ -1,10 +1,14 @@
 #include "lob/backtester.hpp"
 #include "lob/event.hpp"
+#include "lob/synthetic.hpp"
 using namespace lob;
-int main() {
+int main(int argc, char** argv) {
     Backtester bt;
     bt.addStrategy(std::make_unique<MomentumStrategy>(30, 1.5, 0.3));
-    bt.setDataSource(std::make_unique<CSVDataSource>("data/l2_mo_day1.csv"));
+    // Pass a CSV path (e.g. data/l2_mo_day1.csv) to replay real data; defaults to a
+    // synthetic session.
+    if (argc > 1) bt.setDataSource(std::make_unique<CSVDataSource>(argv[1]));
+    else bt.setDataSource(std::make_unique<SyntheticDataSource>(SyntheticMarketConfig::smallCap()));
     auto res = bt.run();
     return 0;
 }
\ No newline at end of file
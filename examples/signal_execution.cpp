@@ -1,10 +1,14 @@
 #include "lob/backtester.hpp"
 #include "lob/event.hpp"
+#include "lob/synthetic.hpp"
 using namespace lob;
-int main() {
+int main(int argc, char** argv) {
     Backtester bt;
     // A simple strategy could be added here to consume signals from SignalGenerator
-    bt.setDataSource(std::make_unique<CSVDataSource>("data/l3_exec_day1.csv"));
+    // Pass a CSV path (e.g. data/l3_exec_day1.csv) to replay real data; defaults to a
+    // synthetic session.
+    if (argc > 1) bt.setDataSource(std::make_unique<CSVDataSource>(argv[1]));
+    else bt.setDataSource(std::make_unique<SyntheticDataSource>(SyntheticMarketConfig::crypto()));
     auto res = bt.run();
     return 0;
 }
\ No newline at end of file
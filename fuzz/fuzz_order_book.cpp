@@ -0,0 +1,23 @@
+#include "book_diff.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+
+// libFuzzer entry point: every input is decoded into an operation
+// sequence (see tests/book_diff.hpp) and replayed against OrderBook and
+// the NaiveBook reference model.  Any divergence aborts with the step
+// that produced it.  Build with -DLOB_BUILD_FUZZ=ON using Clang, then
+//
+//   ./fuzz_order_book -max_len=4096 corpus/
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const auto ops = lob::testing::decodeOps(data, size);
+    lob::OrderBook book{"FUZZ"};
+    lob::testing::NaiveBook model;
+    const std::string diff = lob::testing::runDifferential(ops, model, book);
+    if (!diff.empty()) {
+        std::fprintf(stderr, "OrderBook diverged from reference: %s\n", diff.c_str());
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "lob/profiling.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lob {
+
+// Allocation attribution scopes.  The innermost active scope on the
+// allocating thread is charged, so OrderBook operations performed inside
+// a backtester stage are reported under the book operation rather than
+// the stage (attribution is exclusive).
+enum class AllocScope : uint8_t {
+    UNTAGGED = 0,
+    // Backtester pipeline stages, in PipelineStage order
+    PARSE,
+    BOOK_UPDATE,
+    SIGNAL_UPDATE,
+    STRATEGY,
+    FILL_ACCOUNTING,
+    // OrderBook operations
+    BOOK_ADD,
+    BOOK_MODIFY,
+    BOOK_CANCEL,
+    BOOK_MARKET,
+    BOOK_MATCH,
+    BOOK_QUERY,
+    COUNT
+};
+
+inline constexpr size_t kAllocScopeCount = static_cast<size_t>(AllocScope::COUNT);
+
+inline const char* allocScopeName(AllocScope scope) noexcept {
+    switch (scope) {
+        case AllocScope::UNTAGGED: return "untagged";
+        case AllocScope::PARSE: return "parse";
+        case AllocScope::BOOK_UPDATE: return "book_update";
+        case AllocScope::SIGNAL_UPDATE: return "signal_update";
+        case AllocScope::STRATEGY: return "strategy";
+        case AllocScope::FILL_ACCOUNTING: return "fill_accounting";
+        case AllocScope::BOOK_ADD: return "book_add";
+        case AllocScope::BOOK_MODIFY: return "book_modify";
+        case AllocScope::BOOK_CANCEL: return "book_cancel";
+        case AllocScope::BOOK_MARKET: return "book_market";
+        case AllocScope::BOOK_MATCH: return "book_match";
+        case AllocScope::BOOK_QUERY: return "book_query";
+        case AllocScope::COUNT: break;
+    }
+    return "unknown";
+}
+
+inline AllocScope allocScopeFor(PipelineStage stage) noexcept {
+    return static_cast<AllocScope>(static_cast<uint8_t>(stage) + 1);
+}
+
+struct AllocCounters {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;  // bytes requested by allocations
+};
+
+// Per-scope allocation counters.  Snapshots are process-wide; subtract
+// two snapshots to attribute a region of work.
+struct AllocationStats {
+    std::array<AllocCounters, kAllocScopeCount> scopes{};
+
+    [[nodiscard]] const AllocCounters& operator[](AllocScope s) const noexcept {
+        return scopes[static_cast<size_t>(s)];
+    }
+    [[nodiscard]] uint64_t totalAllocations() const noexcept {
+        uint64_t n = 0;
+        for (const auto& c : scopes) n += c.allocations;
+        return n;
+    }
+    [[nodiscard]] uint64_t totalBytes() const noexcept {
+        uint64_t n = 0;
+        for (const auto& c : scopes) n += c.bytes;
+        return n;
+    }
+    AllocationStats& operator+=(const AllocationStats& other) noexcept {
+        for (size_t i = 0; i < kAllocScopeCount; ++i) {
+            scopes[i].allocations += other.scopes[i].allocations;
+            scopes[i].deallocations += other.scopes[i].deallocations;
+            scopes[i].bytes += other.scopes[i].bytes;
+        }
+        return *this;
+    }
+    [[nodiscard]] AllocationStats operator-(const AllocationStats& base) const noexcept {
+        AllocationStats d;
+        for (size_t i = 0; i < kAllocScopeCount; ++i) {
+            d.scopes[i].allocations = scopes[i].allocations - base.scopes[i].allocations;
+            d.scopes[i].deallocations = scopes[i].deallocations - base.scopes[i].deallocations;
+            d.scopes[i].bytes = scopes[i].bytes - base.scopes[i].bytes;
+        }
+        return d;
+    }
+};
+
+namespace alloc_tracking {
+
+// True when the library was built with LOB_ENABLE_ALLOC_TRACKING, which
+// replaces the global operator new/delete with counting versions.
+[[nodiscard]] bool compiled() noexcept;
+
+// Current process-wide counters; all zero when tracking is compiled out.
+[[nodiscard]] AllocationStats snapshot() noexcept;
+
+#ifdef LOB_ALLOC_TRACKING
+namespace detail {
+extern thread_local AllocScope current_scope;
+}
+#endif
+
+} // namespace alloc_tracking
+
+// RAII tag for the allocating thread.  Compiles to nothing unless
+// allocation tracking is enabled.
+class AllocScopeGuard {
+public:
+#ifdef LOB_ALLOC_TRACKING
+    explicit AllocScopeGuard(AllocScope scope) noexcept : previous_(alloc_tracking::detail::current_scope) {
+        alloc_tracking::detail::current_scope = scope;
+    }
+    ~AllocScopeGuard() { alloc_tracking::detail::current_scope = previous_; }
+#else
+    explicit AllocScopeGuard(AllocScope) noexcept {}
+#endif
+    AllocScopeGuard(const AllocScopeGuard&) = delete;
+    AllocScopeGuard& operator=(const AllocScopeGuard&) = delete;
+
+private:
+#ifdef LOB_ALLOC_TRACKING
+    AllocScope previous_;
+#endif
+};
+
+} // namespace lob
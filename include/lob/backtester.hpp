@@ -3,7 +3,13 @@
 #include "lob/order_book.hpp"
 #include "lob/signals.hpp"
 #include "lob/metrics.hpp"
+#include "lob/event.hpp"
+#include "lob/profiling.hpp"
+#include "lob/alloc_tracker.hpp"
+#include "lob/perf_counters.hpp"
+#include "lob/trace.hpp"
 
+#include <array>
 #include <memory>
 #include <vector>
 #include <string>
@@ -19,37 +25,6 @@ class Strategy;
 class Portfolio;
 class EventQueue;
 
-// Event types for backtesting
-struct Event {
-    enum Type : uint8_t {
-        MARKET_DATA,
-        SIGNAL,
-        ORDER,
-        FILL,
-        END_OF_DAY
-    };
-    
-    Type type;
-    Timestamp timestamp;
-    std::string symbol;
-    
-    // Market data fields
-    std::optional<MarketDataUpdate> market_update;
-    
-    // Signal fields
-    std::optional<Signal> signal;
-    
-    // Order fields
-    std::optional<Order> order;
-    
-    // Fill fields
-    std::optional<Execution> execution;
-    
-    bool operator<(const Event& other) const {
-        return timestamp > other.timestamp;  // Min heap by timestamp
-    }
-};
-
 // Position tracking
 struct Position {
     std::string symbol;
@@ -123,6 +98,25 @@ private:
     void updateDrawdown(double current_equity) noexcept;
 };
 
+// What a burst of market data did to one book before the strategies saw
+// it (see Backtester::setTimestampCoalescing).
+struct MarketDataBatch {
+    Timestamp first_timestamp = 0;
+    Timestamp last_timestamp = 0;
+    uint32_t updates = 0;
+    std::array<uint32_t, 6> counts{};  // indexed by MarketDataUpdate::Type
+    MarketDataUpdate last{};           // final update of the burst
+    Price bid_before = 0;              // touch before the first update
+    Price ask_before = 0;
+    Price bid_after = 0;
+    Price ask_after = 0;
+
+    [[nodiscard]] uint32_t count(MarketDataUpdate::Type type) const noexcept { return counts[type]; }
+    [[nodiscard]] bool touchChanged() const noexcept {
+        return bid_before != bid_after || ask_before != ask_after;
+    }
+};
+
 // Strategy interface
 class Strategy {
 public:
@@ -133,6 +127,15 @@ public:
                              const OrderBook& book,
                              Portfolio& portfolio) = 0;
     
+    // Called once per book and burst when the backtester coalesces market
+    // data; `book` already reflects every update of the burst.  Defaults
+    // to onMarketData with the burst's last update.
+    virtual void onMarketDataBatch(const MarketDataBatch& batch,
+                                   const OrderBook& book,
+                                   Portfolio& portfolio) {
+        onMarketData(batch.last, book, portfolio);
+    }
+    
     virtual void onSignal(const Signal& signal,
                          const OrderBook& book,
                          Portfolio& portfolio) = 0;
@@ -209,8 +212,55 @@ public:
         commission_rate_ = rate;
         if (portfolio_) portfolio_->setCommissionRate(rate);
     }
+    // Replaces the default set of signal calculators.
+    void setSignalGenerator(std::unique_ptr<SignalGenerator> generator) {
+        signal_generator_ = std::move(generator);
+    }
+    // Times every pipeline stage into PerformanceStats histograms.  Off by
+    // default since it adds two clock reads per stage per event.
+    void setStageProfiling(bool enabled) noexcept { stage_profiling_ = enabled; }
+    // Samples cycles, instructions, cache and branch misses around every
+    // pipeline stage into PerformanceStats::stage_counters.  The counter
+    // group is opened by the next run() on its calling thread; when the
+    // kernel refuses (non-Linux, containers, perf_event_paranoid) the
+    // request is silently dropped and hw_counters_available stays false.
+    // Costs two syscalls per stage per event, so keep it off for timing.
+    void setHardwareCounters(bool enabled) {
+        hw_counters_requested_ = enabled;
+        if (!enabled) hw_counters_.reset();
+    }
+    // Records OrderBook::stateHash() after every `every_n`-th book-changing
+    // event of each symbol (0 disables).  Sampling is counted per symbol,
+    // so sharded and single-threaded replays of the same feed produce the
+    // same per-symbol hash streams and can be compared directly.
+    void setStateHashInterval(uint64_t every_n) noexcept { state_hash_interval_ = every_n; }
+    // Coalesces bursts of market data in run(): every update whose
+    // timestamp lies within `epsilon_ns` of the first update of the burst
+    // is applied to its book first, then signals are updated and
+    // Strategy::onMarketDataBatch is called once per touched book, in the
+    // order the books were first touched.  Any other event type closes the
+    // burst before it is processed.  step() and processEvent() stay per
+    // event.  Off by default.
+    void setTimestampCoalescing(bool enabled, Timestamp epsilon_ns = 0) noexcept {
+        coalesce_ = enabled;
+        coalesce_epsilon_ = epsilon_ns;
+    }
+    // Warm-up window of run(): events stamped before `until` and the first
+    // `events` events (0 disables either bound) only rebuild book state.
+    // Market data and ORDER events go straight into the books; signals,
+    // strategies, fill accounting and portfolio snapshots are skipped, and
+    // FILL, SIGNAL and END_OF_DAY events are dropped.  The first event past
+    // both bounds switches the full pipeline on, starting from the
+    // reconstructed books and their mid prices.
+    void setWarmUp(Timestamp until, uint64_t events = 0) noexcept {
+        warm_up_until_ = until;
+        warm_up_events_ = events;
+    }
     
-    // Run backtest
+    // Run backtest.  While the global Tracer is started, sampled events
+    // and their stage spans are recorded for Chrome trace export.  Each
+    // event that reads or changes a book first advances it to the event
+    // time, expiring GTD orders that are due (OrderBook::advanceTime).
     BacktestResult run();
     
     // Real‑time simulation mode
@@ -221,25 +271,65 @@ public:
     [[nodiscard]] const Portfolio& getPortfolio() const { return *portfolio_; }
     [[nodiscard]] const BacktestResult& getResults() const { return last_result_; }
     
-    // Performance profiling
+    // Performance profiling.  Strategy time is always collected; the other
+    // stage totals and the per-stage histograms are filled only while
+    // stage profiling is enabled.  Book update time is reported as
+    // total_matching_time.
     struct PerformanceStats {
         uint64_t events_processed = 0;
         uint64_t orders_sent = 0;
         uint64_t orders_filled = 0;
+        // Strategy market data callbacks; below events_processed only when
+        // timestamp coalescing merged updates.
+        uint64_t market_data_callbacks = 0;
+        // Events consumed by the warm-up window; not in events_processed.
+        uint64_t warm_up_events = 0;
         std::chrono::nanoseconds total_strategy_time{0};
         std::chrono::nanoseconds total_matching_time{0};
         std::chrono::nanoseconds total_signal_time{0};
+        std::chrono::nanoseconds total_parse_time{0};
+        std::chrono::nanoseconds total_fill_time{0};
+        std::array<LatencyHistogram, kPipelineStageCount> stage_latency{};
+        // Heap activity during the event loop of run(), per stage and per
+        // OrderBook operation.  All zero unless the library was built with
+        // LOB_ENABLE_ALLOC_TRACKING.
+        AllocationStats allocations;
+        // Hardware counter totals per stage; samples counts measured calls.
+        // Filled only while hardware counters are enabled and available.
+        std::array<HwCounterValues, kPipelineStageCount> stage_counters{};
+        bool hw_counters_available = false;
         
         [[nodiscard]] double getAverageStrategyLatency() const {
             return events_processed > 0 ? 
                    total_strategy_time.count() / static_cast<double>(events_processed) : 0.0;
         }
+        [[nodiscard]] const LatencyHistogram& stage(PipelineStage s) const {
+            return stage_latency[static_cast<size_t>(s)];
+        }
+        [[nodiscard]] const HwCounterValues& counters(PipelineStage s) const {
+            return stage_counters[static_cast<size_t>(s)];
+        }
+        void record(PipelineStage s, std::chrono::nanoseconds elapsed) noexcept;
     };
     
     [[nodiscard]] const PerformanceStats& getPerformanceStats() const { 
         return perf_stats_; 
     }
     
+    // Book state hash stream of one symbol (see setStateHashInterval).
+    struct StateHashSample {
+        uint64_t event;       // per-symbol event number, 1-based
+        Timestamp timestamp;
+        uint64_t hash;
+    };
+    struct StateHashStream {
+        uint64_t events = 0;
+        std::vector<StateHashSample> samples;
+    };
+    [[nodiscard]] const std::unordered_map<std::string, StateHashStream>& getStateHashes() const {
+        return state_hashes_;
+    }
+    
 private:
     // Components
     std::vector<std::unique_ptr<Strategy>> strategies_;
@@ -251,6 +341,11 @@ private:
     // Configuration
     double initial_capital_ = 1000000.0;
     double commission_rate_ = 0.0001;
+    bool stage_profiling_ = false;
+    bool hw_counters_requested_ = false;
+    std::unique_ptr<HwCounterGroup> hw_counters_;
+    TraceBuffer* trace_ = nullptr;  // set while the current event is sampled
+    uint64_t trace_seq_ = 0;
     
     // Event processing
     std::priority_queue<Event> event_queue_;
@@ -260,13 +355,37 @@ private:
     BacktestResult last_result_;
     PerformanceStats perf_stats_;
     std::vector<Portfolio::Snapshot> portfolio_history_;
+    uint64_t state_hash_interval_ = 0;
+    std::unordered_map<std::string, StateHashStream> state_hashes_;
+    
+    // Timestamp coalescing: one pending batch per book touched by the
+    // current burst.  The vector is reused across bursts.
+    struct PendingBatch {
+        OrderBook* book = nullptr;
+        MarketDataBatch batch;
+    };
+    bool coalesce_ = false;
+    Timestamp coalesce_epsilon_ = 0;
+    Timestamp burst_start_ = 0;
+    std::vector<PendingBatch> pending_batches_;
+    size_t pending_count_ = 0;
+    
+    Timestamp warm_up_until_ = 0;
+    uint64_t warm_up_events_ = 0;
     
     // Helper methods
+    TraceBuffer* sampleTrace();
     void processMarketData(const Event& event);
+    void applyMarketData(const Event& event, OrderBook& book);
+    void coalesceMarketData(const Event& event);
+    void flushMarketData();
+    void warmUp(const Event& event);
+    void finishWarmUp();
     void processSignal(const Event& event);
     void processOrder(const Event& event);
     void processFill(const Event& event);
     void updateMetrics(Timestamp timestamp);
+    void recordStateHash(const std::string& symbol, const OrderBook& book, Timestamp timestamp);
     
     OrderBook& getOrCreateOrderBook(const std::string& symbol);
 };
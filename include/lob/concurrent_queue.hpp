@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Bounded lock-free queues used to hand work between threads without
+// locks or allocation after construction.  Capacities are rounded up to
+// a power of two.  Both queues are non-blocking: push/pop return false
+// when full/empty and callers choose how to wait.
+
+namespace lob {
+
+namespace detail {
+
+inline size_t queueCapacity(size_t n) noexcept {
+    size_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace detail
+
+// Multi-producer single-consumer queue (Vyukov's bounded MPMC algorithm
+// with the consumer side simplified).  Each cell carries a sequence
+// number, so producers claim a slot with one CAS and publish it with a
+// release store; the consumer never contends with producers on a
+// shared counter.
+template <typename T>
+class MpscQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "MpscQueue stores trivially copyable values");
+
+public:
+    explicit MpscQueue(size_t capacity)
+        : mask_(detail::queueCapacity(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+    // Safe to call from any number of threads.
+    bool push(const T& value) noexcept {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const size_t seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = value;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer only.
+    bool pop(T& out) noexcept {
+        Cell& c = cells_[head_ & mask_];
+        const size_t seq = c.seq.load(std::memory_order_acquire);
+        if (seq != head_ + 1) return false;  // empty (or slot not yet published)
+        out = c.value;
+        c.seq.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_{0};  // producers
+    alignas(64) size_t head_ = 0;              // consumer
+};
+
+// Single-producer single-consumer ring.  Each side caches the other's
+// index so the shared cache lines are touched only when the cached view
+// says full/empty.
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue stores trivially copyable values");
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : mask_(detail::queueCapacity(capacity) - 1), slots_(new T[mask_ + 1]) {}
+
+    [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+    bool push(const T& value) noexcept {
+        const size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ > mask_) return false;
+        }
+        slots_[t & mask_] = value;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) noexcept {
+        const size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return false;
+        }
+        out = slots_[h & mask_];
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    alignas(64) std::atomic<size_t> tail_{0};  // written by the producer
+    size_t head_cache_ = 0;                    // producer's view of head_
+    alignas(64) std::atomic<size_t> head_{0};  // written by the consumer
+    size_t tail_cache_ = 0;                    // consumer's view of tail_
+};
+
+} // namespace lob
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lob {
+
+using Price = int64_t;
+
+// Fenwick trees of resting quantity and price x quantity over one side's
+// tick ladder, so cumulative depth and notional from the touch, and the
+// price at which a given size is reached, cost O(log span) rather than a
+// walk over the levels.  Positions run best price first: ascending
+// prices for asks, descending for bids.
+//
+// The ladder is a window of ticks that starts around the first price
+// seen and doubles towards prices that fall outside it, rebuilding the
+// trees in O(span).  A side whose prices spread over more than kMaxSpan
+// ticks stops being indexed (exact() turns false) until clear(); callers
+// then fall back to walking their levels.
+class DepthIndex {
+public:
+    static constexpr size_t kInitialSpan = 1024;
+    static constexpr size_t kMaxSpan = size_t{1} << 20;
+
+    explicit DepthIndex(bool descending = false) noexcept : descending_(descending) {}
+
+    // Adds `quantity` (negative to remove) resting at `price`.
+    void add(Price price, int64_t quantity);
+    void clear() noexcept;
+
+    [[nodiscard]] bool exact() const noexcept { return exact_; }
+    [[nodiscard]] uint64_t total() const noexcept { return static_cast<uint64_t>(total_); }
+    // Quantity and notional resting at `price` or better.
+    [[nodiscard]] uint64_t depthThrough(Price price) const noexcept;
+    [[nodiscard]] int64_t notionalThrough(Price price) const noexcept;
+    // The first price, best first, at which the cumulative quantity
+    // reaches `quantity`; false if the side holds less.
+    [[nodiscard]] bool priceFor(uint64_t quantity, Price& price) const noexcept;
+
+private:
+    bool descending_;
+    bool exact_ = true;
+    Price lo_ = 0;     // lowest price in the window
+    size_t span_ = 0;  // window size in ticks, a power of two (0 = none yet)
+    int64_t total_ = 0;
+    std::vector<int64_t> raw_;       // quantity per position, for rebuilds
+    std::vector<int64_t> qty_tree_;  // 1-based Fenwick trees
+    std::vector<int64_t> notional_tree_;
+
+    [[nodiscard]] bool covers(Price price) const noexcept {
+        // Unsigned distance: `price` may be a sentinel such as INT64_MAX.
+        return span_ != 0 && price >= lo_ && static_cast<uint64_t>(price) - static_cast<uint64_t>(lo_) < span_;
+    }
+    [[nodiscard]] size_t position(Price price) const noexcept {
+        return descending_ ? static_cast<size_t>(lo_ + static_cast<Price>(span_) - 1 - price)
+                           : static_cast<size_t>(price - lo_);
+    }
+    [[nodiscard]] Price priceAt(size_t pos) const noexcept {
+        return descending_ ? lo_ + static_cast<Price>(span_) - 1 - static_cast<Price>(pos)
+                           : lo_ + static_cast<Price>(pos);
+    }
+    // Sum over the first `count` positions.
+    [[nodiscard]] int64_t prefix(const std::vector<int64_t>& tree, size_t count) const noexcept;
+    // Clamps `price` to a count of positions at it or better.
+    [[nodiscard]] size_t positionsThrough(Price price) const noexcept;
+    void grow(Price price);
+};
+
+} // namespace lob
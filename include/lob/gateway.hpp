@@ -0,0 +1,244 @@
+#pragma once
+
+#include "lob/matching_engine.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lob {
+
+// Fixed-layout binary order-entry protocol spoken by Gateway.  Every
+// message starts with a Header whose `length` is the size of the whole
+// message; fields are in host byte order, since the gateway only
+// listens on loopback and Unix-domain sockets.  Each side numbers the
+// messages it sends 1, 2, 3, ... per connection.
+namespace wire {
+
+enum class MsgType : uint8_t {
+    NEW_ORDER = 1,
+    CANCEL = 2,
+    REPLACE = 3,  // changes the remaining quantity, keeping priority rules of OrderBook::modifyOrder
+    ACK = 10,
+    REJECT = 11,
+    FILL = 12,
+};
+
+enum class RejectReason : uint8_t {
+    NONE = 0,
+    ENGINE = 1,        // rejected by the book (unknown order, duplicate id, ...)
+    SEQUENCE_GAP = 2,  // the message's sequence number skipped ahead; it is still processed
+    BAD_MESSAGE = 3,   // unknown symbol or order id out of range
+    BUSY = 4,          // the symbol's shard queue was full; resend later
+};
+
+struct Header {
+    uint16_t length = 0;  // filled in by the sender
+    MsgType type = MsgType::NEW_ORDER;
+    uint8_t flags = 0;
+    uint32_t seq = 0;
+};
+
+// Client order ids must be below 2^40; the gateway namespaces them per
+// connection before they reach the engine.
+struct NewOrder {
+    Header header{0, MsgType::NEW_ORDER};
+    uint64_t order_id = 0;
+    Price price = 0;  // ignored for market orders
+    SymbolId symbol = 0;
+    Quantity quantity = 0;
+    Side side = Side::BID;
+    uint8_t market = 0;
+    uint8_t reserved[6] = {};
+};
+
+struct Cancel {
+    Header header{0, MsgType::CANCEL};
+    uint64_t order_id = 0;
+    SymbolId symbol = 0;
+    uint32_t reserved = 0;
+};
+
+struct Replace {
+    Header header{0, MsgType::REPLACE};
+    uint64_t order_id = 0;
+    SymbolId symbol = 0;
+    Quantity quantity = 0;
+};
+
+// ACK or REJECT of one inbound message.
+struct Ack {
+    Header header{0, MsgType::ACK};
+    uint64_t order_id = 0;
+    SymbolId symbol = 0;
+    MsgType command = MsgType::NEW_ORDER;
+    RejectReason reason = RejectReason::NONE;
+    uint16_t reserved = 0;
+};
+
+struct Fill {
+    Header header{0, MsgType::FILL};
+    uint64_t order_id = 0;
+    Price price = 0;
+    SymbolId symbol = 0;
+    Quantity quantity = 0;
+};
+
+static_assert(sizeof(Header) == 8 && sizeof(NewOrder) == 40 && sizeof(Cancel) == 24 && sizeof(Replace) == 24 &&
+                  sizeof(Ack) == 24 && sizeof(Fill) == 32,
+              "wire layouts are part of the protocol");
+static_assert(std::is_trivially_copyable_v<NewOrder> && std::is_trivially_copyable_v<Fill>);
+
+inline constexpr size_t kMaxMessageSize = sizeof(NewOrder);
+inline constexpr uint64_t kMaxClientOrderId = (uint64_t{1} << 40) - 1;
+
+} // namespace wire
+
+struct GatewayConfig {
+    std::string unix_path;           // listen on this Unix socket; empty listens on TCP
+    uint16_t tcp_port = 0;           // 127.0.0.1 only; 0 picks an ephemeral port (see port())
+    uint32_t max_connections = 1;    // connection slots map to engine client ids 0 .. n-1 (<= Gateway::kMaxConnections)
+    size_t read_buffer = 64 * 1024;  // bytes read per connection per read()
+    size_t max_pending_output = 1 << 20;  // stop draining a client's reports past this backlog
+    uint32_t idle_spins = 1000;      // busy loops before blocking in epoll_wait
+};
+
+// Socket front end for a MatchingEngine.  A single thread runs an
+// edge-triggered epoll loop over non-blocking sockets: inbound bytes are
+// read in large chunks, every complete message is decoded and submitted
+// to the owning shard's queue, and engine reports for all connections
+// are encoded into per-connection buffers that go out with one write()
+// per loop iteration.  Each connection occupies one engine client id, so
+// the engine must be configured with at least `max_connections` clients
+// and must not be polled by anyone else.
+//
+// Orders of a connection stay in the book after it disconnects.
+class Gateway {
+public:
+    Gateway(MatchingEngine& engine, const GatewayConfig& config = {});
+    ~Gateway();
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    // Binds, listens and starts the I/O thread.  False if the socket
+    // could not be set up.
+    bool start();
+    void stop();
+    [[nodiscard]] uint16_t port() const noexcept { return port_; }
+
+    struct Stats {
+        uint64_t accepted = 0;
+        uint64_t refused = 0;          // no free connection slot
+        uint64_t messages_in = 0;
+        uint64_t messages_out = 0;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t sequence_gaps = 0;
+        uint64_t rejected_busy = 0;
+        uint64_t bad_messages = 0;
+    };
+    [[nodiscard]] Stats stats() const noexcept;
+
+    // Engine order ids pack the session generation of the connection slot,
+    // the slot and the client order id, so a later connection on the same
+    // slot can neither touch nor hear about its predecessors' orders.  A
+    // slot's generation wraps after kSessionMask + 1 sessions.
+    static constexpr uint32_t kMaxConnections = (1u << 12) - 1;
+    static constexpr uint32_t kSessionMask = (1u << 12) - 1;
+
+    [[nodiscard]] static OrderId engineOrderId(ClientId client, uint32_t session, uint64_t client_order_id) noexcept {
+        return (static_cast<OrderId>(session & kSessionMask) << 52) | ((static_cast<OrderId>(client) + 1) << 40) |
+               client_order_id;
+    }
+    [[nodiscard]] static uint64_t clientOrderId(OrderId engine_id) noexcept {
+        return engine_id & wire::kMaxClientOrderId;
+    }
+    [[nodiscard]] static uint32_t sessionOf(OrderId engine_id) noexcept {
+        return static_cast<uint32_t>(engine_id >> 52);
+    }
+
+private:
+    struct Connection;
+
+    MatchingEngine& engine_;
+    GatewayConfig config_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    uint16_t port_ = 0;
+    std::vector<Connection> connections_;  // indexed by client id
+    std::vector<char> read_buffer_;
+    std::thread thread_;
+    std::atomic<bool> stop_requested_{false};
+
+    std::atomic<uint64_t> accepted_{0}, refused_{0}, messages_in_{0}, messages_out_{0}, reads_{0}, writes_{0},
+        sequence_gaps_{0}, rejected_busy_{0}, bad_messages_{0};
+
+    void run();
+    void acceptAll();
+    void readFrom(ClientId client);
+    void handle(ClientId client, const char* msg, size_t len);
+    void reject(ClientId client, wire::MsgType command, uint64_t order_id, SymbolId symbol,
+                wire::RejectReason reason);
+    bool drainReports(ClientId client);
+    void flush(ClientId client);
+    void closeConnection(ClientId client);
+};
+
+// Decoded outbound message as seen by a GatewayClient.
+struct GatewayMessage {
+    wire::MsgType type = wire::MsgType::ACK;
+    uint32_t seq = 0;
+    uint64_t order_id = 0;  // the client's order id
+    SymbolId symbol = 0;
+    wire::MsgType command = wire::MsgType::NEW_ORDER;  // ACK/REJECT: what is being answered
+    wire::RejectReason reason = wire::RejectReason::NONE;
+    Price price = 0;        // FILL
+    Quantity quantity = 0;  // FILL
+};
+
+// Blocking client for the gateway protocol, for test clients and
+// benchmarks.  Outbound messages are buffered until flush().
+class GatewayClient {
+public:
+    GatewayClient() = default;
+    ~GatewayClient();
+    GatewayClient(const GatewayClient&) = delete;
+    GatewayClient& operator=(const GatewayClient&) = delete;
+
+    bool connectTcp(uint16_t port);
+    bool connectUnix(const std::string& path);
+    void close();
+    [[nodiscard]] bool connected() const noexcept { return fd_ >= 0; }
+
+    void newOrder(uint64_t order_id, SymbolId symbol, Side side, Price price, Quantity quantity);
+    void marketOrder(uint64_t order_id, SymbolId symbol, Side side, Quantity quantity);
+    void cancel(uint64_t order_id, SymbolId symbol);
+    void replace(uint64_t order_id, SymbolId symbol, Quantity quantity);
+    // Overrides the next outbound sequence number (to exercise gap handling).
+    void setNextSeq(uint32_t seq) noexcept { next_seq_ = seq; }
+    bool flush();
+
+    // Next inbound message; with `block` false returns false instead of
+    // waiting.  Also false once the connection is closed.
+    bool next(GatewayMessage& out, bool block = true);
+    [[nodiscard]] uint32_t sequenceGaps() const noexcept { return sequence_gaps_; }
+
+private:
+    int fd_ = -1;
+    uint32_t next_seq_ = 1;
+    uint32_t expected_seq_ = 1;
+    uint32_t sequence_gaps_ = 0;
+    std::vector<char> out_;
+    std::vector<char> in_;
+    size_t in_pos_ = 0;
+
+    template <typename Msg>
+    void enqueue(Msg msg);
+    bool fill(bool block);
+};
+
+} // namespace lob
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "lob/concurrent_queue.hpp"
+#include "lob/matching_engine.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace lob {
+
+// One accepted command as stored on disk.  Fixed size and trivially
+// copyable so the writer can hand a whole batch to a single write();
+// `timestamp` is the engine time the command was applied with, so a
+// replay reproduces resting orders exactly.  `checksum` covers the
+// record with the field zeroed and detects torn writes at the tail.
+struct JournalRecord {
+    uint64_t timestamp = 0;
+    OrderId order_id = 0;
+    Price price = 0;
+    Quantity quantity = 0;
+    SymbolId symbol = 0;
+    ClientId client = 0;
+    EngineCommand::Type type = EngineCommand::ADD;
+    Side side = Side::BID;
+    uint16_t reserved = 0;
+    uint32_t checksum = 0;
+    uint32_t reserved2 = 0;
+
+    [[nodiscard]] static JournalRecord fromCommand(const EngineCommand& cmd, uint64_t timestamp) noexcept;
+    [[nodiscard]] EngineCommand toCommand() const noexcept;
+    [[nodiscard]] uint32_t computeChecksum() const noexcept;
+};
+static_assert(sizeof(JournalRecord) == 48, "journal record layout is part of the file format");
+
+struct JournalConfig {
+    size_t ring_capacity = size_t{1} << 16;  // records buffered between producers and the writer
+    size_t max_batch = 4096;                 // records per write()
+    uint32_t sync_every = 1;                 // fsync after every n-th write batch; 0 syncs only on flush/close
+    uint64_t sync_interval_us = 0;           // also fsync once this long has passed since the last sync
+    uint64_t idle_sleep_us = 50;             // writer back-off when the ring is empty
+};
+
+struct JournalReplayResult {
+    bool ok = false;         // file opened and its header is valid
+    uint64_t records = 0;    // records delivered to the callback
+    bool truncated = false;  // a torn or corrupt tail was ignored
+};
+
+// Append-only binary journal with group commit.  Producers (e.g. the
+// shard threads of a MatchingEngine) append() into a lock-free ring;
+// a dedicated writer thread drains it in batches, issuing one write()
+// per batch and an fsync() per `sync_every` batches, so no file I/O
+// happens on the producer's thread.  Durability trails the producers by
+// at most one group; flush() waits until everything appended so far is
+// on stable storage.
+//
+// A failed write() cuts the file back to the last whole record and a
+// failed write() or fsync() puts the journal in a failed state: later
+// records are dropped (still drained so producers never block) and
+// flush() reports false until the journal is reopened.
+//
+// File format: a 16-byte header ("LOBJRNL1", version, record size)
+// followed by JournalRecords.  Reopening an existing journal validates
+// the header and cuts off a torn tail before appending.
+class Journal {
+public:
+    explicit Journal(const JournalConfig& config = {});
+    ~Journal();
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Opens (creating if needed) and starts the writer thread.  With
+    // `truncate` any existing contents are discarded.
+    bool open(const std::string& path, bool truncate = false);
+    // Writes and syncs everything appended, then stops the writer.
+    void close();
+    [[nodiscard]] bool isOpen() const noexcept { return fd_ >= 0; }
+
+    // Thread-safe.  Waits (counted in Stats::append_stalls) while the
+    // ring is full rather than dropping a record.
+    void append(const JournalRecord& record) noexcept;
+    // Blocks until every record appended before the call is fsynced.
+    // False if the journal is closed or failed before getting there.
+    bool flush();
+    [[nodiscard]] bool failed() const noexcept { return failed_.load(std::memory_order_acquire); }
+
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t written = 0;
+        uint64_t batches = 0;
+        uint64_t syncs = 0;
+        uint64_t append_stalls = 0;
+        uint64_t write_errors = 0;
+        uint64_t dropped = 0;  // records discarded after a failure
+    };
+    [[nodiscard]] Stats stats() const noexcept;
+
+    // Streams the valid records of `path` to `apply` in batches of up to
+    // `batch` records, stopping at the first torn or corrupt record.
+    using BatchFn = std::function<void(const JournalRecord* records, size_t count)>;
+    static JournalReplayResult replay(const std::string& path, const BatchFn& apply, size_t batch = 4096);
+
+private:
+    JournalConfig config_;
+    MpscQueue<JournalRecord> ring_;
+    std::vector<JournalRecord> buffer_;  // writer-owned batch
+    int fd_ = -1;
+    off_t end_ = 0;  // writer-owned: file size up to the last whole record
+    std::thread writer_;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> sync_target_{0};  // highest record count a flush() waits for
+
+    alignas(64) std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> append_stalls_{0};
+    alignas(64) std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> synced_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> write_errors_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    void runWriter();
+    size_t writeBatch();
+    void sync(uint64_t written);
+};
+
+} // namespace lob
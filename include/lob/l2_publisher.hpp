@@ -0,0 +1,143 @@
+#pragma once
+
+#include "lob/order_book.hpp"
+#include "lob/shared_memory.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lob {
+
+// One changed price level.  Consumers keep their ladder keyed by price:
+// a level's rank is reported when its quantity changes, but levels that
+// merely shift rank because another level appeared above them are not
+// re-sent.
+struct L2Update {
+    static constexpr uint8_t END_OF_BATCH = 1;  // ladder is consistent after this update
+
+    uint64_t sequence = 0;    // publisher-wide; a subscriber sees gaps where updates were conflated
+    Timestamp timestamp = 0;
+    Price price = 0;
+    Quantity quantity = 0;    // 0: level removed or dropped below the published depth
+    uint16_t rank = 0;        // 1 = touch; 0 when removed
+    Side side = Side::BID;
+    uint8_t flags = 0;
+};
+static_assert(sizeof(L2Update) == 32, "L2Update is a shared-memory layout");
+
+// Single-producer single-consumer ring of L2Updates laid out entirely in
+// caller-provided memory (see SharedMemoryRegion), so the two ends may
+// live in different processes.
+class L2Ring {
+public:
+    L2Ring() = default;
+    // Bytes needed for `capacity` slots (rounded up to a power of two).
+    [[nodiscard]] static size_t bytesFor(size_t capacity) noexcept;
+    // Formats `memory` as an empty ring; the writer does this once.
+    static L2Ring create(void* memory, size_t capacity) noexcept;
+    // Attaches to a ring formatted by create(); invalid if the layout does
+    // not match.
+    static L2Ring attach(void* memory, size_t bytes) noexcept;
+
+    [[nodiscard]] bool valid() const noexcept { return header_ != nullptr; }
+    [[nodiscard]] size_t capacity() const noexcept;
+    [[nodiscard]] size_t freeSlots() const noexcept;
+    bool push(const L2Update& u) noexcept;
+    bool pop(L2Update& out) noexcept;
+
+private:
+    struct Header;
+    Header* header_ = nullptr;
+    L2Update* slots_ = nullptr;
+};
+
+// Reading end of one subscription.
+class L2Subscriber {
+public:
+    L2Subscriber() = default;
+    // Maps the shared-memory ring created by L2Publisher::addSubscriber.
+    bool attach(const std::string& shm_name);
+    bool poll(L2Update& out) noexcept { return ring_.valid() && ring_.pop(out); }
+
+private:
+    friend class L2Publisher;
+    SharedMemoryRegion region_;  // empty for in-process subscribers
+    L2Ring ring_;
+};
+
+struct L2PublisherConfig {
+    uint32_t depth = 10;             // levels per side that are tracked and published
+    size_t ring_capacity = 4096;     // updates per subscriber ring
+};
+
+// Turns an OrderBook into a stream of L2 deltas.  publish() is called
+// after each mutating operation (or batch of them): it compares the
+// book's top `depth` levels per side with what was last published and
+// emits only the levels whose quantity changed, appeared or vanished,
+// flagging the last update of the batch END_OF_BATCH.
+//
+// Every subscriber reads from its own ring.  A subscriber that falls
+// behind is conflated rather than backlogged: once its ring cannot take
+// a whole batch, updates are parked in a per-level table where newer
+// states overwrite older ones, and the table drains into the ring as
+// the reader frees space.  A slow reader thus receives the latest state
+// of each level it missed, not every intermediate step.  New subscribers
+// start with the currently published ladder as their first batch.
+class L2Publisher {
+public:
+    explicit L2Publisher(const L2PublisherConfig& config = {});
+    ~L2Publisher();
+
+    // Adds a subscriber whose ring lives in the POSIX shared-memory object
+    // `shm_name` (read it from another process with L2Subscriber::attach),
+    // or in anonymous memory read through subscriber() when the name is
+    // empty.  Returns the subscriber id, or -1 if the memory could not be
+    // set up.
+    int addSubscriber(const std::string& shm_name = {});
+    void removeSubscriber(int id);
+    // In-process reader of subscriber `id`; null for unknown ids.
+    [[nodiscard]] L2Subscriber* subscriber(int id) noexcept;
+
+    // Publishes the changes since the last call; returns how many levels
+    // changed.
+    size_t publish(const OrderBook& book, Timestamp timestamp);
+
+    struct SubscriberStats {
+        uint64_t delivered = 0;  // updates written to the ring
+        uint64_t conflated = 0;  // updates overwritten by a newer state of the same level
+        size_t pending = 0;      // levels waiting for ring space
+    };
+    [[nodiscard]] SubscriberStats stats(int id) const noexcept;
+    [[nodiscard]] uint64_t sequence() const noexcept { return sequence_; }
+    // Ladder as of the last publish(), best level first.
+    [[nodiscard]] const std::vector<std::pair<Price, Quantity>>& levels(Side side) const noexcept {
+        return published_[static_cast<size_t>(side)];
+    }
+
+private:
+    struct Subscription {
+        SharedMemoryRegion memory;
+        L2Subscriber reader;
+        std::map<std::pair<Side, Price>, L2Update> pending;
+        SubscriberStats stats;
+    };
+
+    L2PublisherConfig config_;
+    std::vector<std::unique_ptr<Subscription>> subscribers_;  // indexed by id; null once removed
+    std::vector<std::pair<Price, Quantity>> published_[2];
+    std::vector<std::pair<Price, Quantity>> scratch_;  // swapped with published_ each publish
+    std::vector<L2Update> batch_;
+    uint64_t sequence_ = 0;
+
+    void diffSide(Side side, const std::vector<std::pair<Price, Quantity>>& now, Timestamp timestamp);
+    void deliver(Subscription& sub, const std::vector<L2Update>& updates);
+    void drainPending(Subscription& sub);
+};
+
+} // namespace lob
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "lob/order_book.hpp"
+#include "lob/concurrent_queue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lob {
+
+using ClientId = uint32_t;
+using SymbolId = uint32_t;
+
+// Returned by MatchingEngine::addSymbol() while running; never routable.
+inline constexpr SymbolId kInvalidSymbol = UINT32_MAX;
+
+class Journal;
+struct JournalReplayResult;
+
+// Order entry command submitted to a MatchingEngine or BookEngine.
+struct EngineCommand {
+    enum Type : uint8_t { ADD, MODIFY, CANCEL, MARKET };
+    Type type = ADD;
+    Side side = Side::BID;
+    ClientId client = 0;
+    SymbolId symbol = 0;
+    OrderId order_id = 0;
+    Price price = 0;         // MODIFY: 0 changes the quantity only, else cancel/replace to this price
+    Quantity quantity = 0;
+    uint64_t submit_ns = 0;  // stamped by submit()
+};
+
+// Report published to the owning client of an order.  Fills are sent to
+// both the aggressing and the resting client.
+struct EngineReport {
+    enum Type : uint8_t { ACK, REJECT, FILL };
+    Type type = ACK;
+    EngineCommand::Type command = EngineCommand::ADD;
+    SymbolId symbol = 0;
+    OrderId order_id = 0;
+    Price price = 0;
+    Quantity quantity = 0;
+    uint64_t submit_ns = 0;   // submit time of the command that caused it
+    uint64_t publish_ns = 0;  // when the engine thread published it
+};
+
+struct MatchingEngineConfig {
+    uint32_t shards = 1;
+    std::vector<int> cpus;             // shard i is pinned to cpus[i % size]; empty leaves threads floating
+    uint32_t clients = 1;              // client ids are 0 .. clients-1
+    size_t command_capacity = 1 << 16; // per shard
+    size_t report_capacity = 1 << 14;  // per client per shard
+    size_t max_batch = 256;            // commands drained per batch
+    uint32_t idle_spins = 1000;        // busy polls before yielding when idle
+    Journal* journal = nullptr;        // accepted commands are appended here; must outlive the engine
+};
+
+// Multi-symbol matching engine.  Symbols are hashed onto a fixed pool of
+// shard threads; each shard exclusively owns the books of its symbols
+// and drains its own lock-free MPSC command queue in bounded batches, so
+// any number of client threads may submit() concurrently.  Reports go
+// to one SPSC queue per (client, shard) pair and poll() round-robins a
+// client's queues.
+//
+// Books are allocated lazily on their shard's (pinned) thread, so with
+// the kernel's first-touch policy their memory lands on that core's
+// NUMA node.  Symbols are placed by a stable hash of their name; hot
+// symbols found through shardLoads()/hottestSymbols() can be moved with
+// assignShard() between runs (while stopped).  A moved book is served by
+// its new shard but its memory stays where it was first touched, and
+// books rebuilt by recover() are allocated on the caller's thread, so
+// node-local placement only holds for books a shard created itself:
+// assign shards before the first start() where it matters.
+//
+// A client queue that fills up stalls its shard until the client
+// catches up (counted in ShardLoad::report_stalls); reports are dropped
+// only if a client is still full when stop() runs.
+//
+// With a Journal configured, every accepted command is appended after it
+// is applied (rejections are not journaled); recover() rebuilds the
+// books from such a journal through the same apply path.
+class MatchingEngine {
+public:
+    explicit MatchingEngine(const MatchingEngineConfig& config = {});
+    ~MatchingEngine();
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    // Symbol registration and placement; only while stopped.  Both
+    // refuse while running: addSymbol() returns kInvalidSymbol and
+    // assignShard() false.
+    SymbolId addSymbol(const std::string& symbol);
+    [[nodiscard]] bool findSymbol(const std::string& symbol, SymbolId& out) const;
+    [[nodiscard]] size_t symbolCount() const noexcept { return symbols_.size(); }
+    [[nodiscard]] const std::string& symbolName(SymbolId symbol) const { return symbols_[symbol]; }
+    [[nodiscard]] uint32_t shardOf(SymbolId symbol) const noexcept { return route_[symbol]; }
+    bool assignShard(SymbolId symbol, uint32_t shard);
+
+    void start();
+    // Drains already-submitted commands, then joins the shard threads.
+    void stop();
+    [[nodiscard]] bool running() const noexcept { return running_; }
+
+    // Replays a journal written by an engine with the same symbols (added
+    // in the same order) into the books, without publishing reports or
+    // re-journaling.  Only while stopped; records for unknown symbols are
+    // skipped.
+    JournalReplayResult recover(const std::string& path);
+
+    // Thread-safe.  Returns false when the shard's queue is full or the
+    // client/symbol is unknown.
+    bool submit(EngineCommand cmd) noexcept;
+    // Single consumer per client.
+    bool poll(ClientId client, EngineReport& out) noexcept;
+
+    // Live load metrics, readable from any thread while running.
+    struct ShardLoad {
+        int cpu = -1;
+        uint32_t symbols = 0;
+        uint64_t commands = 0;
+        uint64_t batches = 0;
+        uint64_t max_batch = 0;
+        uint64_t busy_ns = 0;       // time spent applying commands
+        uint64_t queue_depth = 0;   // approximate commands waiting
+        uint64_t reports = 0;
+        uint64_t report_stalls = 0;
+        uint64_t reports_dropped = 0;
+    };
+    [[nodiscard]] std::vector<ShardLoad> shardLoads() const;
+    [[nodiscard]] uint64_t symbolCommands(SymbolId symbol) const noexcept;
+    // The `n` symbols with the most commands so far, busiest first.
+    [[nodiscard]] std::vector<std::pair<SymbolId, uint64_t>> hottestSymbols(size_t n) const;
+
+    // Owned by a shard thread while running; inspect only after stop().
+    // Null until the symbol's shard has run once.
+    [[nodiscard]] const OrderBook* book(SymbolId symbol) const noexcept;
+
+    [[nodiscard]] static uint64_t nowNs() noexcept;
+    [[nodiscard]] static uint32_t hashSymbol(const std::string& symbol) noexcept;
+
+private:
+    struct BookSlot;
+    class Shard;
+
+    MatchingEngineConfig config_;
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, SymbolId> symbol_ids_;
+    std::vector<uint32_t> route_;                  // symbol -> shard; read-only while running
+    std::vector<std::unique_ptr<BookSlot>> books_; // symbol -> book, created by the owning shard
+    std::unique_ptr<std::atomic<uint64_t>[]> symbol_commands_;  // sized at start()
+    size_t symbol_counts_size_ = 0;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    struct alignas(64) PollCursor {
+        uint32_t next = 0;
+    };
+    std::vector<PollCursor> poll_cursors_;
+    bool running_ = false;
+};
+
+struct BookEngineConfig {
+    uint32_t clients = 1;              // client ids are 0 .. clients-1
+    size_t command_capacity = 1 << 16;
+    size_t report_capacity = 1 << 16;  // per client
+    size_t max_batch = 256;            // commands drained per batch
+    int cpu = -1;                      // pin the engine thread; -1 leaves it floating
+    uint32_t idle_spins = 1000;        // busy polls before yielding when idle
+};
+
+// Matching-engine mode for a single OrderBook: a MatchingEngine with one
+// shard and one symbol.  Commands' symbol field is ignored.
+class BookEngine {
+public:
+    BookEngine(const std::string& symbol, const BookEngineConfig& config = {});
+
+    void start() { engine_.start(); }
+    void stop() { engine_.stop(); }
+    [[nodiscard]] bool running() const noexcept { return engine_.running(); }
+
+    bool submit(EngineCommand cmd) noexcept {
+        cmd.symbol = 0;
+        return engine_.submit(cmd);
+    }
+    bool poll(ClientId client, EngineReport& out) noexcept { return engine_.poll(client, out); }
+
+    // Owned by the engine thread while running; inspect only after stop().
+    [[nodiscard]] const OrderBook& book() const noexcept;
+
+    struct Stats {
+        uint64_t commands = 0;
+        uint64_t batches = 0;
+        uint64_t max_batch = 0;
+        uint64_t reports = 0;
+        uint64_t report_stalls = 0;
+        uint64_t reports_dropped = 0;
+    };
+    [[nodiscard]] Stats stats() const;
+
+    [[nodiscard]] static uint64_t nowNs() noexcept { return MatchingEngine::nowNs(); }
+
+private:
+    OrderBook empty_;  // returned by book() before the engine first runs
+    MatchingEngine engine_;
+};
+
+// Pins the calling thread to `cpu`.  Returns false where unsupported.
+bool pinCurrentThread(int cpu) noexcept;
+
+} // namespace lob
@@ -10,6 +10,10 @@
 #include <chrono>
 #include <algorithm>
 #include <numeric>
+#include <iterator>
+
+#include "lob/depth_index.hpp"
+#include "lob/timer_wheel.hpp"
 
 namespace lob {
 
@@ -59,11 +63,22 @@ struct alignas(CACHE_LINE_SIZE) Order {
     TimeInForce tif;
     Timestamp timestamp;
     uint32_t participant_id;
+    uint32_t timer_slot = TimerWheel::kUnscheduled;  // TimerWheel hook, packed here
+    uint64_t sequence = 0;  // book-assigned enqueue sequence (FIFO position)
     
     // Intrusive linked list for O(1) removal
     Order* next = nullptr;
     Order* prev = nullptr;
     PriceLevel* level = nullptr;
+    // Intrusive list of the participant's resting orders (participant_id != 0)
+    Order* participant_next = nullptr;
+    Order* participant_prev = nullptr;
+    // GTD expiry and its TimerWheel hooks
+    Timestamp expire_time = 0;
+    Order* timer_next = nullptr;
+    Order* timer_prev = nullptr;
+    // Trigger price of STOP and STOP_LIMIT orders (`price` is the limit)
+    Price stop_price = 0;
     
     Order() noexcept = default;
     Order(OrderId id_, Price price_, Quantity qty_, Side side_, Timestamp ts_) noexcept
@@ -79,6 +94,18 @@ struct alignas(CACHE_LINE_SIZE) Order {
     }
 };
 
+static_assert(sizeof(Order) == 2 * CACHE_LINE_SIZE, "Order should span exactly two cache lines");
+
+// Direction-aware price ordering.  Both sides of the book share one map
+// type so that side-generic code can bind either ladder by reference;
+// bids sort descending and asks ascending, so begin() is always the touch.
+struct PriceCompare {
+    bool descending = false;
+    [[nodiscard]] bool operator()(Price a, Price b) const noexcept {
+        return descending ? a > b : a < b;
+    }
+};
+
 // Price level maintains FIFO queue of orders
 class PriceLevel {
 public:
@@ -100,6 +127,40 @@ private:
     Order* tail_ = nullptr;
 };
 
+// Forward range over a level's orders in FIFO order, read in place.  Like
+// any pointer into the book it is invalidated by the next book update.
+class LevelOrders {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Order;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Order*;
+        using reference = const Order&;
+        
+        explicit iterator(const Order* order = nullptr) noexcept : order_(order) {}
+        reference operator*() const noexcept { return *order_; }
+        pointer operator->() const noexcept { return order_; }
+        iterator& operator++() noexcept { order_ = order_->next; return *this; }
+        iterator operator++(int) noexcept { iterator old = *this; ++*this; return old; }
+        bool operator==(const iterator& other) const noexcept { return order_ == other.order_; }
+        bool operator!=(const iterator& other) const noexcept { return order_ != other.order_; }
+        
+    private:
+        const Order* order_;
+    };
+    
+    explicit LevelOrders(const PriceLevel* level = nullptr) noexcept
+        : head_(level ? level->front() : nullptr) {}
+    [[nodiscard]] iterator begin() const noexcept { return iterator{head_}; }
+    [[nodiscard]] iterator end() const noexcept { return iterator{}; }
+    [[nodiscard]] bool empty() const noexcept { return head_ == nullptr; }
+    
+private:
+    const Order* head_;
+};
+
 // Execution report for filled orders
 struct Execution {
     OrderId bid_id;
@@ -112,6 +173,29 @@ struct Execution {
         : bid_id(bid), ask_id(ask), price(p), quantity(q), timestamp(ts) {}
 };
 
+// Outcome of OrderBook::submitOrder.
+struct SubmitResult {
+    enum Status : uint8_t {
+        RESTING,    // the unfilled remainder rests in the book
+        FILLED,     // executed in full on arrival
+        CANCELLED,  // IOC or market order remainder discarded after any fills
+        REJECTED,   // zero quantity, duplicate id or unfillable FOK
+        PENDING     // stop order parked until its trigger price trades
+    };
+    Status status = REJECTED;
+    Quantity filled = 0;
+    std::vector<Execution> executions;  // at the resting orders' prices
+    std::vector<OrderId> triggered;     // stop orders released by these trades
+};
+
+// Dry-run cost of a market order (OrderBook::estimateMarketImpact).
+struct MarketImpact {
+    Quantity filled = 0;     // less than requested if the side runs out
+    Price worst_price = 0;   // last level touched; 0 if nothing fills
+    int64_t notional = 0;    // sum of price x quantity, in ticks
+    double vwap = 0.0;       // in ticks
+};
+
 // Market data update for L2/L3 feeds
 struct MarketDataUpdate {
     enum Type : uint8_t {
@@ -131,6 +215,13 @@ struct MarketDataUpdate {
     Timestamp timestamp;
 };
 
+// One aggregated price level (OrderBook::fillAggregated)
+struct LevelInfo {
+    Price price = 0;
+    Quantity quantity = 0;
+    uint32_t order_count = 0;
+};
+
 // Order book statistics for analysis
 struct BookStats {
     Price best_bid = 0;
@@ -143,9 +234,17 @@ struct BookStats {
     double imbalance = 0.0;
     uint32_t bid_levels = 0;
     uint32_t ask_levels = 0;
+    uint32_t bid_orders = 0;
+    uint32_t ask_orders = 0;
     uint32_t total_orders = 0;
 };
 
+// Book size to provision for (OrderBook::reserve, lastSessionSizing)
+struct BookSizing {
+    size_t orders = 0;  // resting orders
+    size_t levels = 0;  // price levels, both sides
+};
+
 // Main Order Book class - optimized for performance
 class OrderBook {
 public:
@@ -162,13 +261,66 @@ public:
     [[nodiscard]] bool addOrder(Order order) noexcept;
     [[nodiscard]] bool modifyOrder(OrderId id, Quantity new_quantity) noexcept;
     [[nodiscard]] bool cancelOrder(OrderId id) noexcept;
+    // Cancel/replace in one step: order `id` moves to `new_price` with
+    // `new_quantity` remaining and, when `new_id` is non-zero, takes that
+    // id.  It keeps its queue position only if price and id are unchanged
+    // and the quantity does not grow; otherwise it joins the back of its
+    // new level.  The order object and its index entry are reused, and so
+    // is the old level when the order leaves it empty for a price with no
+    // level yet.  Like addOrder the order rests without matching.  Returns
+    // false for unknown ids, a zero quantity or a new id already in use.
+    [[nodiscard]] bool replaceOrder(OrderId id, Price new_price, Quantity new_quantity,
+                                    OrderId new_id = 0) noexcept;
+    
+    // Bulk cancels.  Each removes its orders and any emptied levels in one
+    // sweep with a single cache invalidation, appends the cancelled ids to
+    // `canceled` when given, and returns how many orders were cancelled.
+    // Orders are indexed by participant only when participant_id != 0.
+    // Parked stop orders are cancelled along with the resting ones, by
+    // their stop_price for cancelRange.
+    size_t cancelAll(uint32_t participant, std::vector<OrderId>* canceled = nullptr) noexcept;
+    size_t cancelSide(Side side, std::vector<OrderId>* canceled = nullptr) noexcept;
+    // Prices from `from` to `to` inclusive, in either order.
+    size_t cancelRange(Side side, Price from, Price to, std::vector<OrderId>* canceled = nullptr) noexcept;
+    
+    // Order entry with native matching.  The order first trades against
+    // the opposite side, best level first and at the resting orders'
+    // prices, for as long as its limit crosses (at any price for
+    // OrderType::MARKET).  The remainder then rests (GTC, GTD) or is
+    // cancelled (IOC, market orders).  FOK orders are checked against the
+    // crossing depth first and rejected without touching the book unless
+    // they can fill in full.  GTD orders without an expire_time after the
+    // book's clock are rejected.
+    //
+    // STOP and STOP_LIMIT orders are parked until a trade prints at or
+    // through their stop_price (at or above for buys, at or below for
+    // sells), or enter at once if the last trade already has.  A triggered
+    // stop is submitted as a market order, a stop-limit as a limit order
+    // at `price`.  After every call that trades, stops released by the
+    // new last price run in arrival order, and the stops their own trades
+    // release follow in later rounds until none remain.  Their executions
+    // are appended to the caller's and their ids listed in `triggered`,
+    // as is the id of a stop that enters at once.
+    [[nodiscard]] SubmitResult submitOrder(Order order) noexcept;
+    [[nodiscard]] size_t pendingStops() const noexcept { return stop_orders_.size(); }
+    [[nodiscard]] Price lastTradePrice() const noexcept { return last_trade_price_; }
+    
+    // GTD expiry.  Resting and parked stop GTD orders are kept in a
+    // TimerWheel; advanceTime moves the book's clock and cancels every
+    // order whose expire_time is at or before `now` in one batch,
+    // appending their ids to `expired` when given.  Returns how many
+    // expired.  The clock never moves backwards.
+    size_t advanceTime(Timestamp now, std::vector<OrderId>* expired = nullptr) noexcept;
+    [[nodiscard]] Timestamp currentTime() const noexcept { return clock_; }
+    [[nodiscard]] size_t pendingExpiries() const noexcept { return expiry_.size(); }
     
     // Market orders and matching
     [[nodiscard]] std::vector<Execution> processMarketOrder(
         Side side, Quantity quantity, Timestamp timestamp) noexcept;
     [[nodiscard]] std::vector<Execution> matchOrders() noexcept;
     
-    // Query operations (const‑correct)
+    // Query operations (const‑correct).  getOrder also finds parked stop
+    // orders, whose `level` is null.
     [[nodiscard]] const Order* getOrder(OrderId id) const noexcept;
     [[nodiscard]] Price getBestBid() const noexcept;
     [[nodiscard]] Price getBestAsk() const noexcept;
@@ -179,25 +331,77 @@ public:
     [[nodiscard]] double getMicroPrice(int levels = 1) const noexcept;
     [[nodiscard]] double getOrderImbalance(int levels = 5) const noexcept;
     [[nodiscard]] Quantity getQueuePosition(OrderId id) const noexcept;
+    // O(1): volumes, level and order counts are maintained as the book
+    // changes; microprice and imbalance read only the top levels.
     [[nodiscard]] BookStats getStats() const noexcept;
     
-    // L2/L3 market data
+    // Cumulative depth, maintained per side in a DepthIndex so each query
+    // is O(log ticks).  `side` is the resting side, except for
+    // estimateMarketImpact where it is the aggressor's, as in
+    // processMarketOrder.  Stop orders a sweep would release are not
+    // modelled.
+    // Quantity within `ticks` of the side's touch, inclusive.
+    [[nodiscard]] uint64_t depthWithin(Side side, Price ticks) const noexcept;
+    // Quantity resting at `price` or better.
+    [[nodiscard]] uint64_t depthAtOrBetter(Side side, Price price) const noexcept;
+    // The worst price a sweep of `quantity` reaches; 0 if the side holds less.
+    [[nodiscard]] Price priceToFill(Side side, uint64_t quantity) const noexcept;
+    [[nodiscard]] MarketImpact estimateMarketImpact(Side side, Quantity quantity) const noexcept;
+    
+    // L2/L3 market data.  The views below read the book in place and
+    // never allocate; they are invalidated by the next book update.
+    // getAggregatedBook and getOrdersAtLevel are copying wrappers.
+    class Levels;
+    // One side's levels, best first.
+    [[nodiscard]] Levels levels(Side side) const noexcept;
+    // The orders at `price`, in FIFO order (empty if there is no level).
+    [[nodiscard]] LevelOrders levelOrders(Price price, Side side) const noexcept;
+    // Writes up to `max_levels` levels from the touch into `out` and
+    // returns how many were written.
+    size_t fillAggregated(Side side, LevelInfo* out, size_t max_levels) const noexcept;
+    template<size_t N>
+    size_t fillAggregated(Side side, LevelInfo (&out)[N]) const noexcept {
+        return fillAggregated(side, out, N);
+    }
     [[nodiscard]] std::vector<std::pair<Price, Quantity>> 
         getAggregatedBook(Side side, int levels = 10) const noexcept;
     [[nodiscard]] std::vector<Order> 
         getOrdersAtLevel(Price price, Side side) const noexcept;
     
     // Utilities
+    // Empties the book and frees its memory.  Both clear() and reset()
+    // rewind the book's clock to zero.
     void clear() noexcept;
+    // Empties the book for a new session but keeps its memory: orders and
+    // levels go back to the book's pools, which are drawn on before the
+    // allocator, and the indexes keep their capacity.  The session's peak
+    // order and level counts become lastSessionSizing().
+    void reset() noexcept;
+    // Grows the pools so the book can hold `sizing` without allocating,
+    // e.g. a new book sized from a previous session.
+    void reserve(const BookSizing& sizing) noexcept;
+    [[nodiscard]] BookSizing peakSizing() const noexcept { return BookSizing{peak_orders_, peak_levels_}; }
+    [[nodiscard]] const BookSizing& lastSessionSizing() const noexcept { return last_session_; }
     [[nodiscard]] size_t orderCount() const noexcept { return orders_.size(); }
     [[nodiscard]] const std::string& symbol() const noexcept { return symbol_; }
     
+    // Zobrist-style 64-bit hash of the resting state: every order's id,
+    // side, price, remaining quantity and enqueue sequence (which fixes
+    // its FIFO position) is XOR-ed in, so the hash is maintained in O(1)
+    // per operation.  Identical operation streams yield identical hashes;
+    // an empty book hashes to zero.
+    [[nodiscard]] uint64_t stateHash() const noexcept { return state_hash_; }
+    // Full O(n) recomputation of stateHash(), for verification.
+    [[nodiscard]] uint64_t recomputeStateHash() const noexcept;
+    
     // Performance metrics
     struct Metrics {
         uint64_t orders_added = 0;
         uint64_t orders_modified = 0;
         uint64_t orders_canceled = 0;
+        uint64_t orders_expired = 0;
         uint64_t orders_matched = 0;
+        uint64_t stops_triggered = 0;
         uint64_t total_volume = 0;
         std::chrono::nanoseconds total_latency{0};
     };
@@ -209,11 +413,48 @@ private:
     std::string symbol_;
     
     // Flat hash map for O(1) order lookup
-    std::unordered_map<OrderId, std::unique_ptr<Order>> orders_;
+    using OrderMap = std::unordered_map<OrderId, std::unique_ptr<Order>>;
+    OrderMap orders_;
     
     // Red‑black trees for price‑time priority (sorted by price)
-    std::map<Price, std::unique_ptr<PriceLevel>, std::greater<>> bid_levels_;
-    std::map<Price, std::unique_ptr<PriceLevel>, std::less<>> ask_levels_;
+    using LevelMap = std::map<Price, std::unique_ptr<PriceLevel>, PriceCompare>;
+    LevelMap bid_levels_{PriceCompare{true}};
+    LevelMap ask_levels_{PriceCompare{false}};
+    
+    // Pools: removed orders and levels keep their index node and object
+    // as an extracted node handle, reused by the next insert.
+    std::vector<OrderMap::node_type> spare_orders_;
+    std::vector<LevelMap::node_type> spare_levels_;
+    size_t peak_orders_ = 0;
+    size_t peak_levels_ = 0;
+    BookSizing last_session_;
+    
+    // Head of each participant's intrusive order list
+    std::unordered_map<uint32_t, Order*> participant_orders_;
+    
+    // GTD expiry schedule and the time it was last advanced to
+    TimerWheel expiry_;
+    Timestamp clock_ = 0;
+    std::vector<Order*> due_;
+    
+    // Per-side cumulative depth and resting order counts, indexed by Side
+    DepthIndex depth_[2]{DepthIndex{true}, DepthIndex{false}};
+    uint32_t side_orders_[2] = {0, 0};
+    
+    // Parked stop orders by id, and per side a trigger ladder sorted so
+    // the next stop to fire is at the back: buy stops by descending,
+    // sell stops by ascending stop price, earlier arrivals behind later
+    // ones at equal prices.  Firing is a run of pop_back()s.
+    struct StopEntry {
+        Price stop_price;
+        uint64_t sequence;
+        OrderId id;
+    };
+    std::unordered_map<OrderId, Order> stop_orders_;
+    std::vector<StopEntry> stop_ladder_[2];
+    std::vector<StopEntry> stop_batch_;
+    uint64_t stop_seq_ = 0;
+    Price last_trade_price_ = 0;
     
     // Cache best prices for fast access
     mutable Price cached_best_bid_ = 0;
@@ -223,16 +464,88 @@ private:
     // Performance tracking
     Metrics metrics_;
     
+    // Incremental state hash (see stateHash())
+    uint64_t state_hash_ = 0;
+    uint64_t enqueue_seq_ = 0;
+    
     // Helper methods
     void updateCache() const noexcept;
     void invalidateCache() noexcept { cache_valid_ = false; }
     PriceLevel* getOrCreateLevel(Price price, Side side) noexcept;
     void removeEmptyLevel(Price price, Side side) noexcept;
+    void recycleLevel(LevelMap& levels, LevelMap::iterator it) noexcept;
+    Order* storeOrder(Order&& order) noexcept;
+    void recycleOrder(OrderMap::iterator it) noexcept;
+    void resetState() noexcept;
+    PriceLevel* moveLevel(PriceLevel* from, Price price) noexcept;
+    void enqueue(PriceLevel* level, Order* order) noexcept;
+    void dequeue(PriceLevel* level, Order* order) noexcept;
+    void addDepth(Side side, Price price, int64_t quantity) noexcept {
+        depth_[static_cast<size_t>(side)].add(price, quantity);
+    }
+    void linkParticipant(Order* order) noexcept;
+    void unlinkParticipant(Order* order) noexcept;
+    void index(Order* order) noexcept;
+    void unindex(Order* order) noexcept;
+    Quantity sweep(Side side, Price limit, Quantity quantity, OrderId aggressor, Timestamp timestamp,
+                   std::vector<Execution>& executions) noexcept;
+    [[nodiscard]] Quantity crossingDepth(Side side, Price limit, Quantity needed) const noexcept;
+    SubmitResult::Status execute(Order& order, Quantity& filled, std::vector<Execution>& executions) noexcept;
+    [[nodiscard]] bool stopTriggered(const Order& order) const noexcept;
+    void parkStop(const Order& order) noexcept;
+    bool cancelStop(OrderId id) noexcept;
+    void dropStop(std::unordered_map<OrderId, Order>::iterator it) noexcept;
+    size_t cancelStops(uint32_t participant, std::vector<OrderId>* canceled) noexcept;
+    template <typename Pred>
+    size_t cancelStopsIf(std::vector<StopEntry>& ladder, Pred pred, std::vector<OrderId>* canceled) noexcept;
+    void releaseStops(std::vector<Execution>& executions, std::vector<OrderId>* triggered) noexcept;
+    static bool stopBefore(Side side, const StopEntry& a, const StopEntry& b) noexcept;
+    size_t sweepLevels(LevelMap& levels, LevelMap::iterator first, LevelMap::iterator last,
+                       std::vector<OrderId>* canceled) noexcept;
+    static uint64_t hashOrder(const Order& order) noexcept;
     
     template<typename Func>
     void executeMatch(Order* bid, Order* ask, Func&& callback) noexcept;
 };
 
+// Forward range over one side's price levels from the touch.
+class OrderBook::Levels {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PriceLevel;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PriceLevel*;
+        using reference = const PriceLevel&;
+        
+        iterator() noexcept = default;
+        explicit iterator(LevelMap::const_iterator it) noexcept : it_(it) {}
+        reference operator*() const noexcept { return *it_->second; }
+        pointer operator->() const noexcept { return it_->second.get(); }
+        iterator& operator++() noexcept { ++it_; return *this; }
+        iterator operator++(int) noexcept { iterator old = *this; ++it_; return old; }
+        bool operator==(const iterator& other) const noexcept { return it_ == other.it_; }
+        bool operator!=(const iterator& other) const noexcept { return it_ != other.it_; }
+        
+    private:
+        LevelMap::const_iterator it_;
+    };
+    
+    explicit Levels(const LevelMap& levels) noexcept : levels_(&levels) {}
+    [[nodiscard]] iterator begin() const noexcept { return iterator{levels_->begin()}; }
+    [[nodiscard]] iterator end() const noexcept { return iterator{levels_->end()}; }
+    [[nodiscard]] bool empty() const noexcept { return levels_->empty(); }
+    [[nodiscard]] size_t size() const noexcept { return levels_->size(); }
+    
+private:
+    const LevelMap* levels_;
+};
+
+inline OrderBook::Levels OrderBook::levels(Side side) const noexcept {
+    return Levels{(side == Side::BID) ? bid_levels_ : ask_levels_};
+}
+
 // Inline implementations for hot path functions
 inline Price OrderBook::getBestBid() const noexcept {
     if (!cache_valid_) updateCache();
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lob {
+
+// Hardware events sampled by HwCounterGroup.
+enum class HwEvent : uint8_t {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    COUNT
+};
+
+inline constexpr size_t kHwEventCount = static_cast<size_t>(HwEvent::COUNT);
+
+inline const char* hwEventName(HwEvent ev) noexcept {
+    switch (ev) {
+        case HwEvent::CYCLES: return "cycles";
+        case HwEvent::INSTRUCTIONS: return "instructions";
+        case HwEvent::CACHE_MISSES: return "cache_misses";
+        case HwEvent::BRANCH_MISSES: return "branch_misses";
+        case HwEvent::COUNT: break;
+    }
+    return "unknown";
+}
+
+// Counter totals over one or more measured regions.  Events the kernel
+// or CPU could not provide stay zero.
+struct HwCounterValues {
+    std::array<uint64_t, kHwEventCount> events{};
+    uint64_t samples = 0;  // number of regions accumulated
+
+    [[nodiscard]] uint64_t operator[](HwEvent ev) const noexcept {
+        return events[static_cast<size_t>(ev)];
+    }
+    [[nodiscard]] double perSample(HwEvent ev) const noexcept {
+        return samples > 0 ? static_cast<double>((*this)[ev]) / static_cast<double>(samples) : 0.0;
+    }
+    [[nodiscard]] double ipc() const noexcept {
+        const uint64_t c = (*this)[HwEvent::CYCLES];
+        return c > 0 ? static_cast<double>((*this)[HwEvent::INSTRUCTIONS]) / static_cast<double>(c) : 0.0;
+    }
+    HwCounterValues& operator+=(const HwCounterValues& other) noexcept {
+        for (size_t i = 0; i < kHwEventCount; ++i) events[i] += other.events[i];
+        samples += other.samples;
+        return *this;
+    }
+    [[nodiscard]] HwCounterValues operator-(const HwCounterValues& base) const noexcept {
+        HwCounterValues d;
+        for (size_t i = 0; i < kHwEventCount; ++i) d.events[i] = events[i] - base.events[i];
+        d.samples = samples - base.samples;
+        return d;
+    }
+};
+
+// Group of user-space hardware counters for the calling thread, opened
+// with perf_event_open(2).  Linux only; elsewhere, and wherever the
+// kernel refuses (containers, perf_event_paranoid, missing PMU in VMs),
+// the group is simply unavailable and read() returns zeros.  Individual
+// events the CPU lacks are skipped without disabling the rest.
+//
+// The counters are attached to the thread that constructs the group, so
+// create it on the thread whose work is being measured.  Each read() is
+// a single syscall (~0.3-1 us); wrap coarse regions, not single loads.
+class HwCounterGroup {
+public:
+    HwCounterGroup();
+    ~HwCounterGroup();
+    HwCounterGroup(const HwCounterGroup&) = delete;
+    HwCounterGroup& operator=(const HwCounterGroup&) = delete;
+
+    [[nodiscard]] bool available() const noexcept { return leader_ >= 0; }
+    [[nodiscard]] bool hasEvent(HwEvent ev) const noexcept { return fds_[static_cast<size_t>(ev)] >= 0; }
+    // Why the group could not be opened; empty when available.
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+
+    // Cumulative counts since construction, with samples = 1; all zeros
+    // with samples = 0 if the read fails.
+    [[nodiscard]] HwCounterValues read() const noexcept;
+
+private:
+    int leader_ = -1;
+    std::array<int, kHwEventCount> fds_{};
+    std::array<size_t, kHwEventCount> slot_{};  // position in the group read buffer
+    size_t opened_ = 0;
+    std::string error_;
+};
+
+// Accumulates the counter delta over its lifetime into `out`.  A null
+// group (counters disabled) makes this a no-op.
+class HwCounterScope {
+public:
+    HwCounterScope(const HwCounterGroup* group, HwCounterValues& out) noexcept
+        : group_(group != nullptr && group->available() ? group : nullptr), out_(out) {
+        if (group_ != nullptr) start_ = group_->read();
+    }
+    ~HwCounterScope() {
+        if (group_ == nullptr || start_.samples == 0) return;
+        // A failed read comes back with samples = 0; skip the region
+        // rather than subtract from zeros.
+        const HwCounterValues end = group_->read();
+        if (end.samples != 0) out_ += end - start_;
+    }
+    HwCounterScope(const HwCounterScope&) = delete;
+    HwCounterScope& operator=(const HwCounterScope&) = delete;
+
+private:
+    const HwCounterGroup* group_;
+    HwCounterValues& out_;
+    HwCounterValues start_{};
+};
+
+} // namespace lob
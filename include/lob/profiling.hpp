@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lob {
+
+// Stages of the backtester's per-event pipeline.  Used to attribute
+// time (and other resources) to the part of the replay that spent it.
+enum class PipelineStage : uint8_t {
+    PARSE = 0,        // DataSource::getNext (CSV parsing, generation, IPC)
+    BOOK_UPDATE,      // applying market data and orders to the OrderBook
+    SIGNAL_UPDATE,    // SignalGenerator::update and signal generation
+    STRATEGY,         // strategy callbacks
+    FILL_ACCOUNTING,  // portfolio updates for fills and snapshots
+    COUNT
+};
+
+inline constexpr size_t kPipelineStageCount = static_cast<size_t>(PipelineStage::COUNT);
+
+inline const char* stageName(PipelineStage stage) noexcept {
+    switch (stage) {
+        case PipelineStage::PARSE: return "parse";
+        case PipelineStage::BOOK_UPDATE: return "book_update";
+        case PipelineStage::SIGNAL_UPDATE: return "signal_update";
+        case PipelineStage::STRATEGY: return "strategy";
+        case PipelineStage::FILL_ACCOUNTING: return "fill_accounting";
+        case PipelineStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+// Fixed-size log-linear histogram of nanosecond latencies.  Each power
+// of two is split into eight sub-buckets, so percentiles are reported
+// with at most 12.5% relative error while recording stays a handful of
+// instructions and never allocates.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 3;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBits;
+    static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+    void record(uint64_t ns) noexcept {
+        ++counts_[bucketOf(ns)];
+        ++count_;
+        total_ += ns;
+        max_ = std::max(max_, ns);
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return count_; }
+    [[nodiscard]] uint64_t total() const noexcept { return total_; }
+    [[nodiscard]] uint64_t max() const noexcept { return max_; }
+    [[nodiscard]] double mean() const noexcept {
+        return count_ > 0 ? static_cast<double>(total_) / static_cast<double>(count_) : 0.0;
+    }
+
+    // Upper bound of the bucket holding the q-th quantile (q in [0, 1]).
+    [[nodiscard]] uint64_t percentile(double q) const noexcept {
+        if (count_ == 0) return 0;
+        const auto rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            seen += counts_[b];
+            if (seen >= rank) return std::min(bucketUpper(b), max_);
+        }
+        return max_;
+    }
+
+    void merge(const LatencyHistogram& other) noexcept {
+        for (size_t b = 0; b < kBuckets; ++b) counts_[b] += other.counts_[b];
+        count_ += other.count_;
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() noexcept { *this = LatencyHistogram{}; }
+
+private:
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t count_ = 0;
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+
+    static int msb(uint64_t v) noexcept {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanReverse64(&idx, v);
+        return static_cast<int>(idx);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    static size_t bucketOf(uint64_t v) noexcept {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        const int m = msb(v);
+        const auto sub = static_cast<size_t>((v >> (m - kSubBits)) & (kSubBuckets - 1));
+        return static_cast<size_t>(m - kSubBits + 1) * kSubBuckets + sub;
+    }
+
+    static uint64_t bucketUpper(size_t b) noexcept {
+        if (b < kSubBuckets) return b;
+        const auto group = static_cast<int>(b / kSubBuckets);
+        const int shift = group - 1;
+        const uint64_t low = (kSubBuckets + (b % kSubBuckets)) << shift;
+        return low + (uint64_t{1} << shift) - 1;
+    }
+};
+
+} // namespace lob
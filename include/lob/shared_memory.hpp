@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lob {
+
+// RAII mapping of a POSIX shared-memory object (shm_open + mmap), or of
+// anonymous memory when only threads of one process share it.  Layouts
+// placed in a region must be address-free: offsets instead of pointers,
+// and only lock-free std::atomic members.
+class SharedMemoryRegion {
+public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+    SharedMemoryRegion(SharedMemoryRegion&& other) noexcept;
+    SharedMemoryRegion& operator=(SharedMemoryRegion&& other) noexcept;
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    // Creates (replacing any stale object of that name) and maps `size`
+    // zeroed bytes.  `name` follows shm_open rules, e.g. "/lob_feed".  The
+    // creator unlinks the name when the region is destroyed.
+    bool create(const std::string& name, size_t size);
+    // Maps an existing object created by another process.
+    bool open(const std::string& name, bool writable = false);
+    // Private zeroed mapping, shareable between threads only.
+    bool allocate(size_t size);
+    void close() noexcept;
+
+    [[nodiscard]] void* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool valid() const noexcept { return data_ != nullptr; }
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    bool owner_ = false;  // unlink name_ on close
+};
+
+} // namespace lob
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "lob/backtester.hpp"
+#include "lob/event.hpp"
+#include "lob/shared_memory.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lob {
+
+// Compact, fixed-size form of a market data, fill or end-of-day Event as
+// carried by the shared-memory feed.  Symbols travel as indices into the
+// feed's symbol table.
+struct FeedRecord {
+    Timestamp timestamp = 0;
+    OrderId order_id = 0;  // FILL: bid order id
+    OrderId aux_id = 0;    // FILL: ask order id
+    Price price = 0;
+    Quantity quantity = 0;
+    uint32_t symbol = 0;
+    Event::Type event_type = Event::MARKET_DATA;
+    MarketDataUpdate::Type update_type = MarketDataUpdate::ADD_ORDER;
+    Side side = Side::BID;
+    uint8_t reserved = 0;
+    uint32_t reserved2 = 0;
+
+    // False for event types the feed does not carry (signals, orders).
+    [[nodiscard]] static bool fromEvent(const Event& e, uint32_t symbol, FeedRecord& out) noexcept;
+    [[nodiscard]] Event toEvent(const std::string& symbol_name) const;
+};
+static_assert(sizeof(FeedRecord) == 48 && sizeof(FeedRecord) % sizeof(uint64_t) == 0,
+              "FeedRecord is a shared-memory layout");
+
+namespace shm_feed {
+struct Header;
+struct Slot;
+} // namespace shm_feed
+
+// Writing end of a single-writer, multi-reader broadcast ring in POSIX
+// shared memory.  The writer never waits: each reader keeps its own
+// cursor in its own process, and a reader that falls more than a ring's
+// worth behind detects the overrun (per-slot sequence numbers) instead of
+// reading torn data.
+class ShmFeedPublisher {
+public:
+    ShmFeedPublisher() = default;
+    ~ShmFeedPublisher();
+
+    // Creates the feed object `name` (e.g. "/lob_feed") with `capacity`
+    // slots, rounded up to a power of two.
+    bool create(const std::string& name, size_t capacity);
+
+    // False if the event cannot be carried or the symbol table is full.
+    bool publish(const Event& event);
+    bool publish(const FeedRecord& record) noexcept;
+    // Interns `symbol` into the shared symbol table; ~0u when full.
+    uint32_t symbolIndex(const std::string& symbol);
+    // Publishes every remaining event of `source`; returns how many were
+    // published.
+    uint64_t pump(DataSource& source);
+    // Marks the end of the stream; readers drain what is left and stop.
+    void close() noexcept;
+
+    [[nodiscard]] uint64_t published() const noexcept { return next_; }
+    [[nodiscard]] const std::string& name() const noexcept { return region_.name(); }
+
+private:
+    SharedMemoryRegion region_;
+    shm_feed::Header* header_ = nullptr;
+    shm_feed::Slot* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t next_ = 0;
+    std::unordered_map<std::string, uint32_t> symbols_;
+};
+
+// Reading end with a private cursor.
+class ShmFeedReader {
+public:
+    enum class Status { OK, EMPTY, OVERRUN, END };
+
+    // Attaches to feed `name`, starting at the oldest record still in the
+    // ring (`from_oldest`) or at the next record to be written.
+    bool open(const std::string& name, bool from_oldest = true);
+    void rewind(bool from_oldest = true) noexcept;
+
+    // OK fills `out`.  OVERRUN means the writer lapped this reader: the
+    // cursor is moved to the oldest retained record and the skipped count
+    // is added to lost().  END once the writer closed and all is read.
+    Status poll(FeedRecord& out) noexcept;
+    // Name of a record's symbol (resolved from the shared table).
+    const std::string& symbolName(uint32_t index);
+
+    [[nodiscard]] uint64_t cursor() const noexcept { return cursor_; }
+    [[nodiscard]] uint64_t lost() const noexcept { return lost_; }
+    [[nodiscard]] uint64_t overruns() const noexcept { return overruns_; }
+
+private:
+    SharedMemoryRegion region_;
+    const shm_feed::Header* header_ = nullptr;
+    const shm_feed::Slot* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t cursor_ = 0;
+    uint64_t lost_ = 0;
+    uint64_t overruns_ = 0;
+    std::vector<std::string> symbol_names_;
+    std::string unknown_;
+};
+
+// DataSource replaying a live shared-memory feed into a Backtester.
+// hasNext() waits for the writer (yielding) until a record arrives, the
+// feed is closed, or `idle_timeout_ms` passes without data (0 waits
+// forever).  Overruns are skipped and counted by reader().lost().
+class ShmFeedSource : public DataSource {
+public:
+    explicit ShmFeedSource(const std::string& name, bool from_oldest = true, uint64_t idle_timeout_ms = 0);
+
+    bool hasNext() const override;
+    Event getNext() override;
+    // Rejoins the feed at the oldest retained (or the newest) record.
+    void reset() override;
+
+    [[nodiscard]] bool attached() const noexcept { return attached_; }
+    [[nodiscard]] const ShmFeedReader& reader() const noexcept { return reader_; }
+
+private:
+    std::string name_;
+    bool from_oldest_;
+    uint64_t idle_timeout_ms_;
+    bool attached_ = false;
+    mutable ShmFeedReader reader_;
+    mutable FeedRecord pending_;
+    mutable bool has_pending_ = false;
+    mutable bool ended_ = false;
+};
+
+} // namespace lob
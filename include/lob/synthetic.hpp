@@ -0,0 +1,143 @@
+#pragma once
+
+#include "lob/backtester.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lob {
+
+// Relative weights of the message types produced by a synthetic feed.
+// Weights need not sum to one; only their ratios matter.
+struct MessageMix {
+    double add = 0.45;
+    double cancel = 0.42;
+    double modify = 0.08;
+    double market = 0.05;
+};
+
+// Parameters of the synthetic L3 order flow model.  Each symbol runs an
+// independent point process:
+//
+//  * Limit orders, cancels, modifies and market orders arrive with
+//    baseline intensities event_rate * mix.
+//  * Market orders are self-exciting (Hawkes, exponential kernel): each
+//    one adds hawkes_jump to a dimensionless excitation x(t) that decays
+//    at hawkes_decay per second, and every intensity is scaled by
+//    (1 + x).  The branching ratio event_rate * mix.market * hawkes_jump /
+//    hawkes_decay (normalised by the mix total) must stay below one.
+//  * Intensities are queue-reactive: cancel intensity is proportional to
+//    the number of resting orders relative to target_orders, and limit
+//    orders are thinned at levels whose queue exceeds target_queue.
+//
+// Generation is fully deterministic for a given seed and configuration.
+struct SyntheticMarketConfig {
+    std::string name = "custom";
+    uint32_t symbols = 1;
+    std::string symbol_prefix = "SYN";
+    uint64_t seed = 42;
+    Timestamp start_time = 34200ULL * 1000000000ULL;  // 09:30 as ns since midnight
+    Timestamp duration = 3600ULL * 1000000000ULL;     // one hour
+    uint64_t max_events = 0;                          // 0 = bounded by duration only
+
+    double event_rate = 1000.0;  // messages per second per symbol (baseline)
+    MessageMix mix;
+    uint32_t target_orders = 1000;
+    double modify_up_prob = 0.2;  // share of modifies that increase size
+    double hawkes_jump = 0.0;
+    double hawkes_decay = 20.0;
+
+    Price initial_mid = 10000;  // in ticks
+    int depth = 20;             // levels per side new orders may join
+    double touch_decay = 0.7;   // P(level d+1) / P(level d) for new orders
+    double inside_prob = 0.1;   // chance an add improves a wide spread
+    Quantity target_queue = 4000;
+    Quantity min_qty = 100;
+    Quantity max_qty = 1000;
+    double market_qty_mean = 300.0;
+    int initial_orders_per_level = 4;
+
+    // Calibrated presets.  Rates are per symbol.
+    static SyntheticMarketConfig liquidEquity();
+    static SyntheticMarketConfig smallCap();
+    static SyntheticMarketConfig crypto();
+    // Looks up a preset by name; returns false if the name is unknown.
+    static bool preset(const std::string& name, SyntheticMarketConfig& out);
+
+    // False for settings the generator cannot honour: no levels to quote
+    // on, an empty or inverted quantity range, seed prices at or below
+    // zero, a negative rate or a session end past the Timestamp range.
+    [[nodiscard]] bool valid() const noexcept;
+};
+
+// One generated message.  Symbols are referred to by index; use
+// SyntheticMarketGenerator::symbolName() to obtain the string.
+//
+// Market orders are emitted as MarketDataUpdate::TRADE with the side of
+// the aggressor and the executed quantity, leaving the consumer to
+// replay them against its own book (OrderBook::processMarketOrder
+// reproduces the generator's FIFO consumption exactly).
+struct SyntheticUpdate {
+    uint32_t symbol = 0;
+    MarketDataUpdate update{};
+};
+
+// Streaming generator.  Memory is proportional to the number of resting
+// orders, not to the number of events, so arbitrarily long sessions can
+// be produced on the fly.  An invalid configuration (see
+// SyntheticMarketConfig::valid()) produces no symbols and no events.
+class SyntheticMarketGenerator {
+public:
+    explicit SyntheticMarketGenerator(SyntheticMarketConfig config);
+    ~SyntheticMarketGenerator();
+
+    SyntheticMarketGenerator(const SyntheticMarketGenerator&) = delete;
+    SyntheticMarketGenerator& operator=(const SyntheticMarketGenerator&) = delete;
+
+    // Produces the next message in timestamp order.  Returns false once
+    // the configured duration or event budget is exhausted.
+    [[nodiscard]] bool next(SyntheticUpdate& out);
+
+    [[nodiscard]] const std::string& symbolName(uint32_t index) const { return symbol_names_[index]; }
+    [[nodiscard]] const SyntheticMarketConfig& config() const noexcept { return config_; }
+    [[nodiscard]] uint64_t eventsGenerated() const noexcept { return events_; }
+
+    // Writes the stream in the CSVDataSource format
+    // (timestamp_ns,symbol,type,side,price,quantity,order_id) and
+    // returns the number of rows written.
+    uint64_t writeCSV(std::ostream& os);
+
+private:
+    struct SymbolState;
+
+    SyntheticMarketConfig config_;
+    std::vector<std::string> symbol_names_;
+    std::vector<std::unique_ptr<SymbolState>> states_;
+    std::vector<std::pair<Timestamp, uint32_t>> heap_;  // min-heap of next event time per symbol
+    Timestamp end_time_;
+    uint64_t events_ = 0;
+};
+
+// DataSource adapter so the backtester can replay a synthetic session
+// without materialising it on disk.
+class SyntheticDataSource : public DataSource {
+public:
+    explicit SyntheticDataSource(SyntheticMarketConfig config);
+
+    bool hasNext() const override;
+    Event getNext() override;
+    void reset() override;
+
+private:
+    SyntheticMarketConfig config_;
+    std::unique_ptr<SyntheticMarketGenerator> generator_;
+    SyntheticUpdate pending_;
+    bool has_pending_ = false;
+
+    void advance();
+};
+
+} // namespace lob
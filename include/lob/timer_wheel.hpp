@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lob {
+
+struct Order;
+using Timestamp = uint64_t;
+
+// Hierarchical timing wheel of resting orders keyed by Order::expire_time.
+// Four levels of 256 slots cover 2^32 ticks (49 days at the default 1 ms
+// tick); later expiries wait in the outermost level and are re-filed as
+// the wheel turns.  Orders are linked intrusively through their timer_*
+// fields, so schedule() and cancel() are O(1) and allocation-free once
+// the slot table exists (it is allocated on the first schedule()).
+//
+// advance() cascades outer slots as tick boundaries are crossed and
+// skips empty stretches a whole level at a time.  Expiry is exact: an
+// order is due once `now` reaches its expire_time, regardless of the
+// tick, which only sets the slot granularity.
+class TimerWheel {
+public:
+    static constexpr Timestamp kDefaultTick = 1000000;  // ns
+
+    explicit TimerWheel(Timestamp tick_ns = kDefaultTick) noexcept;
+
+    void schedule(Order* order) noexcept;
+    // No-op for orders that are not scheduled.
+    void cancel(Order* order) noexcept;
+    // Moves the wheel to `now` and unlinks every order with
+    // expire_time <= now, appending it to `due` in expiry-slot order.
+    void advance(Timestamp now, std::vector<Order*>& due);
+    // Drops every timer and rewinds the wheel to time zero.
+    void clear() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] Timestamp tick() const noexcept { return tick_; }
+
+    static constexpr uint32_t kUnscheduled = ~0u;
+
+private:
+    static constexpr uint32_t kLevels = 4;
+    static constexpr uint32_t kSlotBits = 8;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+
+    Timestamp tick_;
+    uint64_t now_tick_ = 0;
+    size_t size_ = 0;
+    std::array<size_t, kLevels> level_size_{};
+    std::unique_ptr<Order*[]> slots_;  // kLevels * kSlots list heads
+
+    void place(Order* order) noexcept;
+    void link(Order* order, uint32_t slot) noexcept;
+    void unlink(Order* order) noexcept;
+    void cascade(uint32_t level) noexcept;
+    void collect(uint32_t slot, Timestamp now, std::vector<Order*>& due);
+};
+
+} // namespace lob
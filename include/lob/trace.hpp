@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lob {
+
+// Sampling and buffer sizing for Tracer.  Events are traced in bursts:
+// out of every `sample_every` replayed events, the first `burst` are
+// recorded with all of their stage spans, so a trace shows contiguous
+// stretches of the replay rather than isolated events.
+struct TraceConfig {
+    size_t buffer_capacity = size_t{1} << 16;  // spans per thread, rounded up to a power of two
+    uint32_t sample_every = 1;                 // 1 traces every event
+    uint32_t burst = 1;
+};
+
+// One complete span (Chrome trace "X" event).  `name` must point to a
+// string with static storage duration.
+struct TraceSpanRecord {
+    const char* name = nullptr;
+    uint64_t begin_ns = 0;
+    uint64_t end_ns = 0;
+};
+
+// Fixed-capacity single-producer ring of spans owned by one thread.  The
+// owning thread records without locks or allocation; once full, the
+// oldest spans are overwritten.  Readers see a consistent ring only
+// while the producer is quiescent (e.g. after a replay returns).
+class TraceBuffer {
+public:
+    TraceBuffer(size_t capacity, uint32_t thread_id);
+
+    void record(const char* name, uint64_t begin_ns, uint64_t end_ns) noexcept {
+        const uint64_t h = head_.load(std::memory_order_relaxed);
+        spans_[static_cast<size_t>(h) & mask_] = TraceSpanRecord{name, begin_ns, end_ns};
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] uint32_t threadId() const noexcept { return thread_id_; }
+    [[nodiscard]] uint64_t recorded() const noexcept { return head_.load(std::memory_order_acquire); }
+    [[nodiscard]] uint64_t dropped() const noexcept;
+    // Retained spans, oldest first.
+    [[nodiscard]] std::vector<TraceSpanRecord> spans() const;
+
+private:
+    std::vector<TraceSpanRecord> spans_;
+    size_t mask_;
+    uint32_t thread_id_;
+    std::atomic<uint64_t> head_{0};
+};
+
+// Process-wide span collector exporting Chrome trace JSON (open in
+// ui.perfetto.dev or chrome://tracing).  Disabled by default; while
+// disabled, instrumented code pays one relaxed load per event.
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Starts a fresh trace, discarding previously collected spans.
+    void start(const TraceConfig& config = {});
+    void stop() noexcept { enabled_.store(false, std::memory_order_relaxed); }
+    [[nodiscard]] bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+    [[nodiscard]] const TraceConfig& config() const noexcept { return config_; }
+
+    // Ring buffer of the calling thread, registered on first use; null
+    // while tracing is disabled.
+    [[nodiscard]] TraceBuffer* threadBuffer();
+
+    // Writes every thread's retained spans as a Chrome trace JSON object
+    // and returns the number of spans written.  Call after stop() or
+    // while no traced work is running.
+    size_t writeChromeJson(std::ostream& os) const;
+
+    [[nodiscard]] static uint64_t nowNs() noexcept;
+
+private:
+    Tracer() = default;
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> generation_{0};
+    TraceConfig config_;
+    uint64_t origin_ns_ = 0;
+    mutable std::mutex mutex_;  // guards buffers_; taken on registration and export only
+    std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+};
+
+// Records the enclosing scope as a span into `buffer`; a null buffer
+// (event not sampled) makes this a no-op without clock reads.
+class TraceSpan {
+public:
+    TraceSpan(TraceBuffer* buffer, const char* name) noexcept : buffer_(buffer), name_(name) {
+        if (buffer_ != nullptr) begin_ = Tracer::nowNs();
+    }
+    ~TraceSpan() {
+        if (buffer_ != nullptr) buffer_->record(name_, begin_, Tracer::nowNs());
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceBuffer* buffer_;
+    const char* name_;
+    uint64_t begin_ = 0;
+};
+
+} // namespace lob
@@ -0,0 +1,129 @@
+#include "lob/alloc_tracker.hpp"
+
+#ifdef LOB_ALLOC_TRACKING
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace lob {
+namespace alloc_tracking {
+
+#ifdef LOB_ALLOC_TRACKING
+
+namespace detail {
+
+thread_local AllocScope current_scope = AllocScope::UNTAGGED;
+
+namespace {
+
+struct AtomicCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+// Zero-initialised at static-init time, so allocations made before main
+// (or by other static initialisers) are counted safely.
+AtomicCounters g_counters[kAllocScopeCount];
+
+} // namespace
+
+inline void onAlloc(size_t n) noexcept {
+    auto& c = g_counters[static_cast<size_t>(current_scope)];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void onFree(void* p) noexcept {
+    if (p == nullptr) return;
+    g_counters[static_cast<size_t>(current_scope)].deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* allocate(size_t n) {
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) throw std::bad_alloc();
+    onAlloc(n);
+    return p;
+}
+
+void* allocateAligned(size_t n, size_t align) {
+    if (align < sizeof(void*)) align = sizeof(void*);
+    void* p = nullptr;
+    if (posix_memalign(&p, align, n == 0 ? 1 : n) != 0) throw std::bad_alloc();
+    onAlloc(n);
+    return p;
+}
+
+void release(void* p) noexcept {
+    onFree(p);
+    std::free(p);
+}
+
+} // namespace detail
+
+bool compiled() noexcept { return true; }
+
+AllocationStats snapshot() noexcept {
+    AllocationStats s;
+    for (size_t i = 0; i < kAllocScopeCount; ++i) {
+        const auto& c = detail::g_counters[i];
+        s.scopes[i].allocations = c.allocations.load(std::memory_order_relaxed);
+        s.scopes[i].deallocations = c.deallocations.load(std::memory_order_relaxed);
+        s.scopes[i].bytes = c.bytes.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+#else
+
+bool compiled() noexcept { return false; }
+
+AllocationStats snapshot() noexcept { return {}; }
+
+#endif
+
+} // namespace alloc_tracking
+} // namespace lob
+
+#ifdef LOB_ALLOC_TRACKING
+
+// -------- global operator new / delete replacements ----------
+
+namespace detail_ = lob::alloc_tracking::detail;
+
+void* operator new(std::size_t n) { return detail_::allocate(n); }
+void* operator new[](std::size_t n) { return detail_::allocate(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    try { return detail_::allocate(n); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    try { return detail_::allocate(n); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t n, std::align_val_t a) {
+    return detail_::allocateAligned(n, static_cast<std::size_t>(a));
+}
+void* operator new[](std::size_t n, std::align_val_t a) {
+    return detail_::allocateAligned(n, static_cast<std::size_t>(a));
+}
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    try { return detail_::allocateAligned(n, static_cast<std::size_t>(a)); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    try { return detail_::allocateAligned(n, static_cast<std::size_t>(a)); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { detail_::release(p); }
+void operator delete[](void* p) noexcept { detail_::release(p); }
+void operator delete(void* p, std::size_t) noexcept { detail_::release(p); }
+void operator delete[](void* p, std::size_t) noexcept { detail_::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { detail_::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { detail_::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { detail_::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { detail_::release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { detail_::release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { detail_::release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { detail_::release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { detail_::release(p); }
+
+#endif
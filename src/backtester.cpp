@@ -160,6 +160,13 @@ Event CSVDataSource::parseLine(const std::string& line) {
         u.order_id = static_cast<OrderId>(std::stoull(cols[6]));
         u.quantity = static_cast<Quantity>(std::stoul(cols[5]));
         e.market_update = u;
+    } else if (type == "MARKET") {
+        // Aggressive order from the feed; replayed against the book.
+        e.type = Event::MARKET_DATA;
+        MarketDataUpdate u{}; u.type = MarketDataUpdate::TRADE;
+        u.timestamp = e.timestamp; u.side = (cols[3] == "BID" ? Side::BID : Side::ASK);
+        u.price = static_cast<Price>(std::stoll(cols[4])); u.quantity = static_cast<Quantity>(std::stoul(cols[5]));
+        e.market_update = u;
     } else if (type == "TRADE") {
         e.type = Event::FILL;
         Execution ex{0,0, static_cast<Price>(std::stoll(cols[4])), static_cast<Quantity>(std::stoul(cols[5])), e.timestamp};
@@ -189,6 +196,91 @@ void CSVDataSource::loadBuffer() {
 
 // -------- Backtester ----------
 
+void Backtester::PerformanceStats::record(PipelineStage s, std::chrono::nanoseconds elapsed) noexcept {
+    switch (s) {
+        case PipelineStage::PARSE:           total_parse_time += elapsed; break;
+        case PipelineStage::BOOK_UPDATE:     total_matching_time += elapsed; break;
+        case PipelineStage::SIGNAL_UPDATE:   total_signal_time += elapsed; break;
+        case PipelineStage::STRATEGY:        total_strategy_time += elapsed; break;
+        case PipelineStage::FILL_ACCOUNTING: total_fill_time += elapsed; break;
+        case PipelineStage::COUNT:           return;
+    }
+    stage_latency[static_cast<size_t>(s)].record(static_cast<uint64_t>(elapsed.count()));
+}
+
+namespace {
+
+// Scoped timer attributing the enclosed work to one pipeline stage.
+// Performs no clock reads when disabled; the allocation tag is always
+// set (and compiles away without LOB_ENABLE_ALLOC_TRACKING).  Hardware
+// counters are read only when a counter group is passed in, and a trace
+// span is recorded only when the current event was sampled.
+class StageTimer {
+public:
+    StageTimer(Backtester::PerformanceStats& stats, PipelineStage stage, bool enabled,
+               const HwCounterGroup* counters = nullptr, TraceBuffer* trace = nullptr) noexcept
+        : stats_(stats), stage_(stage), enabled_(enabled), alloc_scope_(allocScopeFor(stage)),
+          hw_scope_(counters, stats.stage_counters[static_cast<size_t>(stage)]),
+          trace_span_(trace, stageName(stage)) {
+        if (enabled_) start_ = std::chrono::steady_clock::now();
+    }
+    ~StageTimer() {
+        if (enabled_) {
+            stats_.record(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start_));
+        }
+    }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Backtester::PerformanceStats& stats_;
+    PipelineStage stage_;
+    bool enabled_;
+    std::chrono::steady_clock::time_point start_{};
+    AllocScopeGuard alloc_scope_;
+    HwCounterScope hw_scope_;
+    TraceSpan trace_span_;
+};
+
+// Applies one feed update to its book.
+void applyUpdate(OrderBook& book, const MarketDataUpdate& u) {
+    switch (u.type) {
+        case MarketDataUpdate::ADD_ORDER: {
+            Order o{u.order_id, u.price, u.quantity, u.side, u.timestamp};
+            book.addOrder(std::move(o));
+            break;
+        }
+        case MarketDataUpdate::MODIFY_ORDER: {
+            book.modifyOrder(u.order_id, u.quantity);
+            break;
+        }
+        case MarketDataUpdate::CANCEL_ORDER: {
+            book.cancelOrder(u.order_id);
+            break;
+        }
+        case MarketDataUpdate::TRADE: {
+            // Aggressor-side print (side = aggressor).  Feeds that report
+            // the consumed resting orders separately use FILL events
+            // instead; here the book itself consumes the liquidity.
+            auto execs = book.processMarketOrder(u.side, u.quantity, u.timestamp);
+            (void)execs;
+            break;
+        }
+        case MarketDataUpdate::CLEAR: {
+            // New session: keep the book's memory for the next one.
+            book.reset();
+            break;
+        }
+        case MarketDataUpdate::SNAPSHOT: {
+            // ignore here
+            break;
+        }
+    }
+}
+
+} // namespace
+
 Backtester::Backtester() {
     portfolio_ = std::make_unique<Portfolio>(initial_capital_);
     signal_generator_ = std::make_unique<SignalGenerator>();
@@ -210,76 +302,160 @@ OrderBook& Backtester::getOrCreateOrderBook(const std::string& sym) {
     return *it->second;
 }
 
+TraceBuffer* Backtester::sampleTrace() {
+    auto& tracer = Tracer::instance();
+    if (!tracer.enabled()) return nullptr;
+    const auto& cfg = tracer.config();
+    const bool sampled = trace_seq_++ % cfg.sample_every < cfg.burst;
+    return sampled ? tracer.threadBuffer() : nullptr;
+}
+
+void Backtester::applyMarketData(const Event& e, OrderBook& book) {
+    const auto& u = *e.market_update;
+    {
+        StageTimer timer(perf_stats_, PipelineStage::BOOK_UPDATE, stage_profiling_, hw_counters_.get(), trace_);
+        applyUpdate(book, u);
+        current_prices_[e.symbol] = book.getMidPrice();
+    }
+    if (state_hash_interval_ != 0) recordStateHash(e.symbol, book, e.timestamp);
+    ++perf_stats_.events_processed;
+}
+
 void Backtester::processMarketData(const Event& e) {
     const auto& u = *e.market_update;
     auto& book = getOrCreateOrderBook(e.symbol);
+    book.advanceTime(e.timestamp);
+    applyMarketData(e, book);
     
-    switch (u.type) {
-        case MarketDataUpdate::ADD_ORDER: {
-            Order o{u.order_id, u.price, u.quantity, u.side, u.timestamp};
-            book.addOrder(std::move(o));
-            break;
-        }
-        case MarketDataUpdate::MODIFY_ORDER: {
-            book.modifyOrder(u.order_id, u.quantity);
-            break;
-        }
-        case MarketDataUpdate::CANCEL_ORDER: {
-            book.cancelOrder(u.order_id);
-            break;
+    {
+        StageTimer timer(perf_stats_, PipelineStage::SIGNAL_UPDATE, stage_profiling_, hw_counters_.get(), trace_);
+        signal_generator_->update(book);
+    }
+    
+    {
+        StageTimer timer(perf_stats_, PipelineStage::STRATEGY, true, hw_counters_.get(), trace_);
+        for (auto& strat : strategies_) {
+            strat->onMarketData(u, book, *portfolio_);
         }
-        case MarketDataUpdate::TRADE: {
-            // not generally present in L3 add/cancel streams; handled by FILL events
+    }
+    ++perf_stats_.market_data_callbacks;
+}
+
+void Backtester::coalesceMarketData(const Event& e) {
+    // Unsigned distance: an out-of-order timestamp also closes the burst.
+    if (pending_count_ != 0 && e.timestamp - burst_start_ > coalesce_epsilon_) flushMarketData();
+    if (pending_count_ == 0) burst_start_ = e.timestamp;
+    
+    auto& book = getOrCreateOrderBook(e.symbol);
+    book.advanceTime(e.timestamp);
+    PendingBatch* pending = nullptr;
+    for (size_t i = 0; i < pending_count_; ++i) {
+        if (pending_batches_[i].book == &book) {
+            pending = &pending_batches_[i];
             break;
         }
-        case MarketDataUpdate::CLEAR: {
-            book.clear();
-            break;
+    }
+    if (pending == nullptr) {
+        if (pending_count_ == pending_batches_.size()) pending_batches_.emplace_back();
+        pending = &pending_batches_[pending_count_++];
+        pending->book = &book;
+        pending->batch = MarketDataBatch{};
+        pending->batch.first_timestamp = e.timestamp;
+        pending->batch.bid_before = book.getBestBid();
+        pending->batch.ask_before = book.getBestAsk();
+    }
+    applyMarketData(e, book);
+    
+    auto& batch = pending->batch;
+    const auto& u = *e.market_update;
+    ++batch.updates;
+    ++batch.counts[u.type];
+    batch.last = u;
+    batch.last_timestamp = e.timestamp;
+}
+
+void Backtester::flushMarketData() {
+    for (size_t i = 0; i < pending_count_; ++i) {
+        auto& book = *pending_batches_[i].book;
+        auto& batch = pending_batches_[i].batch;
+        batch.bid_after = book.getBestBid();
+        batch.ask_after = book.getBestAsk();
+        {
+            StageTimer timer(perf_stats_, PipelineStage::SIGNAL_UPDATE, stage_profiling_, hw_counters_.get(), trace_);
+            signal_generator_->update(book);
         }
-        case MarketDataUpdate::SNAPSHOT: {
-            // ignore here
-            break;
+        {
+            StageTimer timer(perf_stats_, PipelineStage::STRATEGY, true, hw_counters_.get(), trace_);
+            for (auto& strat : strategies_) {
+                strat->onMarketDataBatch(batch, book, *portfolio_);
+            }
         }
+        ++perf_stats_.market_data_callbacks;
     }
-    
-    current_prices_[e.symbol] = book.getMidPrice();
-    signal_generator_->update(book);
-    
-    auto t0 = std::chrono::steady_clock::now();
-    for (auto& strat : strategies_) {
-        strat->onMarketData(u, book, *portfolio_);
+    pending_count_ = 0;
+}
+
+void Backtester::warmUp(const Event& e) {
+    ++perf_stats_.warm_up_events;
+    const bool market_data = e.type == Event::MARKET_DATA && e.market_update;
+    if (!market_data && !(e.type == Event::ORDER && e.order)) return;
+    auto& book = getOrCreateOrderBook(e.symbol);
+    book.advanceTime(e.timestamp);
+    if (market_data) {
+        applyUpdate(book, *e.market_update);
+    } else if (e.order->type == OrderType::MARKET) {
+        // Liquidity taken during the warm-up shapes the book, but the
+        // fills are not booked.
+        auto execs = book.processMarketOrder(e.order->side, e.order->quantity, e.timestamp);
+        (void)execs;
+    } else {
+        auto o = *e.order;
+        o.timestamp = e.timestamp;
+        const bool ok = book.addOrder(std::move(o));
+        (void)ok;
     }
-    auto t1 = std::chrono::steady_clock::now();
-    perf_stats_.total_strategy_time += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
-    ++perf_stats_.events_processed;
+    if (state_hash_interval_ != 0) recordStateHash(e.symbol, book, e.timestamp);
+}
+
+void Backtester::finishWarmUp() {
+    for (const auto& [sym, book] : order_books_) current_prices_[sym] = book->getMidPrice();
 }
 
 void Backtester::processSignal(const Event& e) {
     auto& book = getOrCreateOrderBook(e.symbol);
-    auto sigs = signal_generator_->generateSignals(book);
-    auto t0 = std::chrono::steady_clock::now();
+    book.advanceTime(e.timestamp);
+    std::vector<Signal> sigs;
+    {
+        StageTimer timer(perf_stats_, PipelineStage::SIGNAL_UPDATE, stage_profiling_, hw_counters_.get(), trace_);
+        sigs = signal_generator_->generateSignals(book);
+    }
+    StageTimer timer(perf_stats_, PipelineStage::STRATEGY, true, hw_counters_.get(), trace_);
     for (auto& s : sigs) {
         for (auto& strat : strategies_) strat->onSignal(s, book, *portfolio_);
     }
-    auto t1 = std::chrono::steady_clock::now();
-    perf_stats_.total_signal_time += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
 }
 
 void Backtester::processOrder(const Event& e) {
     auto& book = getOrCreateOrderBook(e.symbol);
+    book.advanceTime(e.timestamp);
     const auto& ord = *e.order;
-    if (ord.type == OrderType::MARKET) {
-        auto execs = book.processMarketOrder(ord.side, ord.quantity, e.timestamp);
-        for (auto& ex : execs) {
-            Event f{}; f.type = Event::FILL; f.timestamp = ex.timestamp; f.symbol = e.symbol; f.execution = ex;
-            processFill(f);
+    std::vector<Execution> execs;
+    {
+        StageTimer timer(perf_stats_, PipelineStage::BOOK_UPDATE, stage_profiling_, hw_counters_.get(), trace_);
+        if (ord.type == OrderType::MARKET) {
+            execs = book.processMarketOrder(ord.side, ord.quantity, e.timestamp);
+        } else {
+            // add passive order
+            auto o = ord;
+            o.timestamp = e.timestamp;
+            const bool ok = book.addOrder(std::move(o));
+            (void)ok;
         }
-    } else {
-        // add passive order
-        auto o = ord;
-        o.timestamp = e.timestamp;
-        const bool ok = book.addOrder(std::move(o));
-        (void)ok;
+    }
+    if (state_hash_interval_ != 0) recordStateHash(e.symbol, book, e.timestamp);
+    for (auto& ex : execs) {
+        Event f{}; f.type = Event::FILL; f.timestamp = ex.timestamp; f.symbol = e.symbol; f.execution = ex;
+        processFill(f);
     }
     ++perf_stats_.orders_sent;
 }
@@ -290,25 +466,69 @@ void Backtester::processFill(const Event& e) {
     const bool buy_fill = (ex.bid_id != 0);
     const int64_t dq = buy_fill ? static_cast<int64_t>(ex.quantity) : -static_cast<int64_t>(ex.quantity);
     const double px = priceToDouble(ex.price);
-    portfolio_->updatePosition(e.symbol, dq, px);
-    for (auto& strat : strategies_) strat->onFill(ex, *portfolio_);
+    {
+        StageTimer timer(perf_stats_, PipelineStage::FILL_ACCOUNTING, stage_profiling_, hw_counters_.get(), trace_);
+        portfolio_->updatePosition(e.symbol, dq, px);
+    }
+    {
+        StageTimer timer(perf_stats_, PipelineStage::STRATEGY, true, hw_counters_.get(), trace_);
+        for (auto& strat : strategies_) strat->onFill(ex, *portfolio_);
+    }
     ++perf_stats_.orders_filled;
 }
 
 void Backtester::updateMetrics(Timestamp ts) {
+    StageTimer timer(perf_stats_, PipelineStage::FILL_ACCOUNTING, stage_profiling_, hw_counters_.get(), trace_);
     const double eq = portfolio_->getEquity(current_prices_);
     portfolio_history_.push_back(portfolio_->takeSnapshot(ts, current_prices_));
     (void)eq;
 }
 
+void Backtester::recordStateHash(const std::string& sym, const OrderBook& book, Timestamp ts) {
+    auto& stream = state_hashes_[sym];
+    if (++stream.events % state_hash_interval_ == 0) {
+        stream.samples.push_back(StateHashSample{stream.events, ts, book.stateHash()});
+    }
+}
+
 BacktestResult Backtester::run() {
     if (!data_source_) return {};
     strategies_.shrink_to_fit();
     for (auto& s : strategies_) s->onStart();
     portfolio_history_.clear();
+    state_hashes_.clear();
+    if (hw_counters_requested_ && !hw_counters_) {
+        // Opened here so the counters follow the thread driving the replay.
+        auto group = std::make_unique<HwCounterGroup>();
+        perf_stats_.hw_counters_available = group->available();
+        if (group->available()) hw_counters_ = std::move(group);
+    }
+    const AllocationStats alloc_base = alloc_tracking::snapshot();
+    bool warming = warm_up_until_ != 0 || warm_up_events_ != 0;
+    uint64_t warm_up_seen = 0;
     
     while (data_source_->hasNext()) {
-        auto e = data_source_->getNext();
+        trace_ = sampleTrace();
+        TraceSpan event_span(trace_, "event");
+        Event e;
+        {
+            StageTimer timer(perf_stats_, PipelineStage::PARSE, stage_profiling_, hw_counters_.get(), trace_);
+            e = data_source_->getNext();
+        }
+        if (warming) {
+            if (e.timestamp < warm_up_until_ || warm_up_seen < warm_up_events_) {
+                ++warm_up_seen;
+                warmUp(e);
+                continue;
+            }
+            warming = false;
+            finishWarmUp();
+        }
+        if (coalesce_ && e.type == Event::MARKET_DATA && e.market_update) {
+            coalesceMarketData(e);
+            continue;
+        }
+        if (pending_count_ != 0) flushMarketData();
         switch (e.type) {
             case Event::MARKET_DATA: processMarketData(e); break;
             case Event::ORDER:       processOrder(e); break;
@@ -317,6 +537,10 @@ BacktestResult Backtester::run() {
             case Event::END_OF_DAY:  updateMetrics(e.timestamp); break;
         }
     }
+    if (pending_count_ != 0) flushMarketData();
+    if (warming) finishWarmUp();
+    trace_ = nullptr;
+    perf_stats_.allocations += alloc_tracking::snapshot() - alloc_base;
     for (auto& s : strategies_) s->onEnd(*portfolio_);
     
     // Build equity series
@@ -335,6 +559,8 @@ void Backtester::step(const Event& event) {
 }
 
 void Backtester::processEvent(const Event& event) {
+    trace_ = sampleTrace();
+    TraceSpan event_span(trace_, "event");
     switch (event.type) {
         case Event::MARKET_DATA: processMarketData(event); break;
         case Event::ORDER:       processOrder(event); break;
@@ -0,0 +1,125 @@
+#include "lob/depth_index.hpp"
+
+#include <algorithm>
+
+namespace lob {
+
+void DepthIndex::add(Price price, int64_t quantity) {
+    total_ += quantity;
+    if (quantity == 0 || !exact_) {
+        return;
+    }
+    if (!covers(price)) {
+        grow(price);
+        if (!exact_) return;
+    }
+    const size_t pos = position(price);
+    raw_[pos] += quantity;
+    const int64_t notional = quantity * price;
+    for (size_t i = pos + 1; i <= span_; i += i & (~i + 1)) {
+        qty_tree_[i] += quantity;
+        notional_tree_[i] += notional;
+    }
+}
+
+void DepthIndex::clear() noexcept {
+    total_ = 0;
+    if (!exact_) {
+        exact_ = true;
+        span_ = 0;
+        return;
+    }
+    // Keeps the window and its memory for the next session.
+    std::fill(raw_.begin(), raw_.end(), 0);
+    std::fill(qty_tree_.begin(), qty_tree_.end(), 0);
+    std::fill(notional_tree_.begin(), notional_tree_.end(), 0);
+}
+
+void DepthIndex::grow(Price price) {
+    size_t span = kInitialSpan;
+    Price lo = price - static_cast<Price>(kInitialSpan / 2);
+    if (span_ != 0) {
+        const Price hi = lo_ + static_cast<Price>(span_) - 1;
+        const auto needed = static_cast<uint64_t>(std::max(hi, price) - std::min(lo_, price)) + 1;
+        span = span_;
+        while (span < needed && span <= kMaxSpan) span *= 2;
+        // Grow towards the new price, keeping the far edge in place.
+        lo = price < lo_ ? hi - static_cast<Price>(span) + 1 : lo_;
+    }
+    if (span > kMaxSpan) {
+        exact_ = false;
+        span_ = 0;
+        raw_ = {};
+        qty_tree_ = {};
+        notional_tree_ = {};
+        return;
+    }
+
+    std::vector<int64_t> raw(span, 0);
+    for (size_t pos = 0; pos < raw_.size(); ++pos) {
+        if (raw_[pos] == 0) continue;
+        const Price p = priceAt(pos);
+        raw[descending_ ? static_cast<size_t>(lo + static_cast<Price>(span) - 1 - p)
+                        : static_cast<size_t>(p - lo)] = raw_[pos];
+    }
+    lo_ = lo;
+    span_ = span;
+    raw_ = std::move(raw);
+
+    // Linear-time Fenwick build.
+    qty_tree_.assign(span_ + 1, 0);
+    notional_tree_.assign(span_ + 1, 0);
+    for (size_t i = 1; i <= span_; ++i) {
+        qty_tree_[i] += raw_[i - 1];
+        notional_tree_[i] += raw_[i - 1] * priceAt(i - 1);
+        const size_t parent = i + (i & (~i + 1));
+        if (parent <= span_) {
+            qty_tree_[parent] += qty_tree_[i];
+            notional_tree_[parent] += notional_tree_[i];
+        }
+    }
+}
+
+int64_t DepthIndex::prefix(const std::vector<int64_t>& tree, size_t count) const noexcept {
+    int64_t sum = 0;
+    for (size_t i = count; i > 0; i -= i & (~i + 1)) sum += tree[i];
+    return sum;
+}
+
+size_t DepthIndex::positionsThrough(Price price) const noexcept {
+    if (span_ == 0) {
+        return 0;
+    }
+    if (covers(price)) {
+        return position(price) + 1;
+    }
+    const bool beyond_best = descending_ ? price >= lo_ : price < lo_;
+    return beyond_best ? 0 : span_;
+}
+
+uint64_t DepthIndex::depthThrough(Price price) const noexcept {
+    return static_cast<uint64_t>(prefix(qty_tree_, positionsThrough(price)));
+}
+
+int64_t DepthIndex::notionalThrough(Price price) const noexcept {
+    return prefix(notional_tree_, positionsThrough(price));
+}
+
+bool DepthIndex::priceFor(uint64_t quantity, Price& price) const noexcept {
+    if (quantity == 0 || span_ == 0 || static_cast<uint64_t>(total_) < quantity) {
+        return false;
+    }
+    // Binary lifting: the longest prefix still short of `quantity`.
+    auto rem = static_cast<int64_t>(quantity);
+    size_t pos = 0;
+    for (size_t step = span_; step != 0; step >>= 1) {
+        if (pos + step <= span_ && qty_tree_[pos + step] < rem) {
+            pos += step;
+            rem -= qty_tree_[pos];
+        }
+    }
+    price = priceAt(pos);
+    return true;
+}
+
+} // namespace lob
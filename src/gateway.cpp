@@ -0,0 +1,552 @@
+#include "lob/gateway.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace lob {
+
+namespace {
+
+constexpr uint64_t kListenTag = ~uint64_t{0};
+
+bool setNonBlocking(int fd) noexcept {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void setNoDelay(int fd) noexcept {
+    const int one = 1;
+    (void)::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // fails harmlessly on AF_UNIX
+}
+
+template <typename Msg>
+void appendMessage(std::vector<char>& out, Msg msg) {
+    msg.header.length = sizeof(Msg);
+    const size_t at = out.size();
+    out.resize(at + sizeof(Msg));
+    std::memcpy(out.data() + at, &msg, sizeof(Msg));
+}
+
+wire::MsgType wireCommand(EngineCommand::Type t) noexcept {
+    switch (t) {
+        case EngineCommand::MODIFY: return wire::MsgType::REPLACE;
+        case EngineCommand::CANCEL: return wire::MsgType::CANCEL;
+        default: return wire::MsgType::NEW_ORDER;
+    }
+}
+
+size_t expectedLength(wire::MsgType type) noexcept {
+    switch (type) {
+        case wire::MsgType::NEW_ORDER: return sizeof(wire::NewOrder);
+        case wire::MsgType::CANCEL: return sizeof(wire::Cancel);
+        case wire::MsgType::REPLACE: return sizeof(wire::Replace);
+        case wire::MsgType::ACK:
+        case wire::MsgType::REJECT: return sizeof(wire::Ack);
+        case wire::MsgType::FILL: return sizeof(wire::Fill);
+    }
+    return 0;
+}
+
+} // namespace
+
+// -------- Gateway ----------
+
+struct Gateway::Connection {
+    int fd = -1;
+    uint32_t session = 0;  // bumped on every accept into the slot
+    uint32_t expected_seq = 1;
+    uint32_t out_seq = 1;
+    std::vector<char> partial;  // bytes of an incomplete inbound message
+    std::vector<char> out;      // encoded, not yet written
+    size_t out_pos = 0;
+
+    template <typename Msg>
+    void send(Msg msg) {
+        msg.header.seq = out_seq++;
+        appendMessage(out, msg);
+    }
+};
+
+Gateway::Gateway(MatchingEngine& engine, const GatewayConfig& config)
+    : engine_(engine), config_(config), connections_(config.max_connections),
+      read_buffer_(std::max<size_t>(config.read_buffer, wire::kMaxMessageSize)) {}
+
+Gateway::~Gateway() { stop(); }
+
+bool Gateway::start() {
+    if (listen_fd_ >= 0 || config_.max_connections > kMaxConnections) return false;
+    if (config_.unix_path.empty()) {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) return false;
+        const int one = 1;
+        (void)::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(config_.tcp_port);
+        socklen_t len = sizeof(addr);
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            stop();
+            return false;
+        }
+        port_ = ntohs(addr.sin_port);
+    } else {
+        sockaddr_un addr{};
+        if (config_.unix_path.size() >= sizeof(addr.sun_path)) return false;
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) return false;
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, config_.unix_path.c_str(), config_.unix_path.size() + 1);
+        ::unlink(config_.unix_path.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            stop();
+            return false;
+        }
+    }
+    epoll_fd_ = ::epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenTag;
+    if (::listen(listen_fd_, 64) != 0 || !setNonBlocking(listen_fd_) || epoll_fd_ < 0 ||
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) != 0) {
+        stop();
+        return false;
+    }
+    stop_requested_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void Gateway::stop() {
+    if (thread_.joinable()) {
+        stop_requested_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+    for (ClientId c = 0; c < connections_.size(); ++c) closeConnection(c);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        if (!config_.unix_path.empty()) ::unlink(config_.unix_path.c_str());
+    }
+    epoll_fd_ = -1;
+    listen_fd_ = -1;
+}
+
+Gateway::Stats Gateway::stats() const noexcept {
+    Stats s;
+    s.accepted = accepted_.load(std::memory_order_relaxed);
+    s.refused = refused_.load(std::memory_order_relaxed);
+    s.messages_in = messages_in_.load(std::memory_order_relaxed);
+    s.messages_out = messages_out_.load(std::memory_order_relaxed);
+    s.reads = reads_.load(std::memory_order_relaxed);
+    s.writes = writes_.load(std::memory_order_relaxed);
+    s.sequence_gaps = sequence_gaps_.load(std::memory_order_relaxed);
+    s.rejected_busy = rejected_busy_.load(std::memory_order_relaxed);
+    s.bad_messages = bad_messages_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Gateway::run() {
+    epoll_event events[64];
+    uint32_t idle = 0;
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        // Spin while traffic flows; block briefly in the kernel once idle.
+        const int timeout_ms = idle >= config_.idle_spins ? 1 : 0;
+        const int n = ::epoll_wait(epoll_fd_, events, 64, timeout_ms);
+        bool busy = n > 0;
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == kListenTag) {
+                acceptAll();
+                continue;
+            }
+            const auto client = static_cast<ClientId>(events[i].data.u64);
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) readFrom(client);
+        }
+        for (ClientId c = 0; c < connections_.size(); ++c) {
+            if (connections_[c].fd < 0) {
+                // Nobody to tell; keep the engine from stalling on the queue.
+                EngineReport stale;
+                while (engine_.poll(c, stale)) {}
+                continue;
+            }
+            busy |= drainReports(c);
+            flush(c);
+        }
+        idle = busy ? 0 : idle + 1;
+    }
+}
+
+void Gateway::acceptAll() {
+    for (;;) {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) return;  // EAGAIN: backlog drained
+        auto slot = std::find_if(connections_.begin(), connections_.end(),
+                                 [](const Connection& c) { return c.fd < 0; });
+        if (slot == connections_.end()) {
+            ::close(fd);
+            refused_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        const auto client = static_cast<ClientId>(slot - connections_.begin());
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.u64 = client;
+        if (!setNonBlocking(fd) || ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        setNoDelay(fd);
+        const uint32_t session = (slot->session + 1) & kSessionMask;
+        *slot = Connection{};
+        slot->fd = fd;
+        slot->session = session;
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Gateway::readFrom(ClientId client) {
+    Connection& conn = connections_[client];
+    // Edge-triggered: read until the socket is drained.
+    while (conn.fd >= 0) {
+        const ssize_t n = ::read(conn.fd, read_buffer_.data(), read_buffer_.size());
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeConnection(client);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        reads_.fetch_add(1, std::memory_order_relaxed);
+
+        // Parse in place unless a message straddles the previous read.
+        const char* data = read_buffer_.data();
+        size_t len = static_cast<size_t>(n);
+        if (!conn.partial.empty()) {
+            conn.partial.insert(conn.partial.end(), data, data + len);
+            data = conn.partial.data();
+            len = conn.partial.size();
+        }
+        size_t pos = 0;
+        while (len - pos >= sizeof(wire::Header)) {
+            wire::Header h;
+            std::memcpy(&h, data + pos, sizeof(h));
+            const size_t expected = expectedLength(h.type);
+            if (expected == 0 || h.length != expected || h.type >= wire::MsgType::ACK) {
+                // Framing is lost; nothing after this point can be trusted.
+                bad_messages_.fetch_add(1, std::memory_order_relaxed);
+                closeConnection(client);
+                return;
+            }
+            if (len - pos < h.length) break;
+            handle(client, data + pos, h.length);
+            pos += h.length;
+        }
+        if (conn.partial.empty()) {
+            conn.partial.assign(data + pos, data + len);
+        } else {
+            conn.partial.erase(conn.partial.begin(), conn.partial.begin() + static_cast<std::ptrdiff_t>(pos));
+        }
+    }
+}
+
+void Gateway::handle(ClientId client, const char* msg, size_t len) {
+    Connection& conn = connections_[client];
+    messages_in_.fetch_add(1, std::memory_order_relaxed);
+    wire::Header h;
+    std::memcpy(&h, msg, sizeof(h));
+    if (h.seq != conn.expected_seq) {
+        sequence_gaps_.fetch_add(1, std::memory_order_relaxed);
+        reject(client, h.type, 0, 0, wire::RejectReason::SEQUENCE_GAP);
+    }
+    conn.expected_seq = h.seq + 1;
+
+    EngineCommand cmd;
+    cmd.client = client;
+    uint64_t order_id = 0;
+    switch (h.type) {
+        case wire::MsgType::NEW_ORDER: {
+            wire::NewOrder m;
+            std::memcpy(&m, msg, len);
+            cmd.type = m.market != 0 ? EngineCommand::MARKET : EngineCommand::ADD;
+            cmd.side = m.side;
+            cmd.symbol = m.symbol;
+            cmd.price = m.price;
+            cmd.quantity = m.quantity;
+            order_id = m.order_id;
+            break;
+        }
+        case wire::MsgType::CANCEL: {
+            wire::Cancel m;
+            std::memcpy(&m, msg, len);
+            cmd.type = EngineCommand::CANCEL;
+            cmd.symbol = m.symbol;
+            order_id = m.order_id;
+            break;
+        }
+        default: {
+            wire::Replace m;
+            std::memcpy(&m, msg, len);
+            cmd.type = EngineCommand::MODIFY;
+            cmd.symbol = m.symbol;
+            cmd.quantity = m.quantity;
+            order_id = m.order_id;
+            break;
+        }
+    }
+    if (order_id > wire::kMaxClientOrderId || cmd.symbol >= engine_.symbolCount()) {
+        bad_messages_.fetch_add(1, std::memory_order_relaxed);
+        reject(client, h.type, order_id, cmd.symbol, wire::RejectReason::BAD_MESSAGE);
+        return;
+    }
+    cmd.order_id = engineOrderId(client, conn.session, order_id);
+    if (!engine_.submit(cmd)) {
+        rejected_busy_.fetch_add(1, std::memory_order_relaxed);
+        reject(client, h.type, order_id, cmd.symbol, wire::RejectReason::BUSY);
+    }
+}
+
+void Gateway::reject(ClientId client, wire::MsgType command, uint64_t order_id, SymbolId symbol,
+                     wire::RejectReason reason) {
+    wire::Ack a;
+    a.header.type = wire::MsgType::REJECT;
+    a.order_id = order_id;
+    a.symbol = symbol;
+    a.command = command;
+    a.reason = reason;
+    connections_[client].send(a);
+    messages_out_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Gateway::drainReports(ClientId client) {
+    Connection& conn = connections_[client];
+    EngineReport r;
+    uint64_t n = 0;
+    bool polled = false;
+    while (conn.out.size() - conn.out_pos < config_.max_pending_output && engine_.poll(client, r)) {
+        polled = true;
+        // Reports about orders of an earlier session on this slot.
+        if (sessionOf(r.order_id) != conn.session) continue;
+        ++n;
+        if (r.type == EngineReport::FILL) {
+            wire::Fill f;
+            f.order_id = clientOrderId(r.order_id);
+            f.price = r.price;
+            f.symbol = r.symbol;
+            f.quantity = r.quantity;
+            conn.send(f);
+        } else {
+            wire::Ack a;
+            a.header.type = r.type == EngineReport::ACK ? wire::MsgType::ACK : wire::MsgType::REJECT;
+            a.order_id = clientOrderId(r.order_id);
+            a.symbol = r.symbol;
+            a.command = wireCommand(r.command);
+            a.reason = r.type == EngineReport::ACK ? wire::RejectReason::NONE : wire::RejectReason::ENGINE;
+            conn.send(a);
+        }
+    }
+    messages_out_.fetch_add(n, std::memory_order_relaxed);
+    return polled;
+}
+
+void Gateway::flush(ClientId client) {
+    Connection& conn = connections_[client];
+    while (conn.fd >= 0 && conn.out_pos < conn.out.size()) {
+        const ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_pos, conn.out.size() - conn.out_pos,
+                                 MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeConnection(client);
+            return;  // socket full: retried on the next loop iteration
+        }
+        writes_.fetch_add(1, std::memory_order_relaxed);
+        conn.out_pos += static_cast<size_t>(n);
+    }
+    conn.out.clear();
+    conn.out_pos = 0;
+}
+
+void Gateway::closeConnection(ClientId client) {
+    Connection& conn = connections_[client];
+    if (conn.fd < 0) return;
+    if (epoll_fd_ >= 0) ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    ::close(conn.fd);
+    const uint32_t session = conn.session;
+    conn = Connection{};
+    conn.session = session;
+}
+
+// -------- GatewayClient ----------
+
+GatewayClient::~GatewayClient() { close(); }
+
+bool GatewayClient::connectTcp(uint16_t port) {
+    close();
+    fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    setNoDelay(fd_);
+    return true;
+}
+
+bool GatewayClient::connectUnix(const std::string& path) {
+    close();
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) return false;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GatewayClient::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    next_seq_ = expected_seq_ = 1;
+    sequence_gaps_ = 0;
+    out_.clear();
+    in_.clear();
+    in_pos_ = 0;
+}
+
+template <typename Msg>
+void GatewayClient::enqueue(Msg msg) {
+    msg.header.seq = next_seq_++;
+    appendMessage(out_, msg);
+}
+
+void GatewayClient::newOrder(uint64_t order_id, SymbolId symbol, Side side, Price price, Quantity quantity) {
+    wire::NewOrder m;
+    m.order_id = order_id;
+    m.price = price;
+    m.symbol = symbol;
+    m.quantity = quantity;
+    m.side = side;
+    enqueue(m);
+}
+
+void GatewayClient::marketOrder(uint64_t order_id, SymbolId symbol, Side side, Quantity quantity) {
+    wire::NewOrder m;
+    m.order_id = order_id;
+    m.symbol = symbol;
+    m.quantity = quantity;
+    m.side = side;
+    m.market = 1;
+    enqueue(m);
+}
+
+void GatewayClient::cancel(uint64_t order_id, SymbolId symbol) {
+    wire::Cancel m;
+    m.order_id = order_id;
+    m.symbol = symbol;
+    enqueue(m);
+}
+
+void GatewayClient::replace(uint64_t order_id, SymbolId symbol, Quantity quantity) {
+    wire::Replace m;
+    m.order_id = order_id;
+    m.symbol = symbol;
+    m.quantity = quantity;
+    enqueue(m);
+}
+
+bool GatewayClient::flush() {
+    size_t pos = 0;
+    while (fd_ >= 0 && pos < out_.size()) {
+        const ssize_t n = ::send(fd_, out_.data() + pos, out_.size() - pos, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            close();
+            return false;
+        }
+        pos += static_cast<size_t>(n);
+    }
+    out_.clear();
+    return fd_ >= 0;
+}
+
+bool GatewayClient::fill(bool block) {
+    if (in_pos_ != 0) {
+        in_.erase(in_.begin(), in_.begin() + static_cast<std::ptrdiff_t>(in_pos_));
+        in_pos_ = 0;
+    }
+    const size_t at = in_.size();
+    in_.resize(at + 64 * 1024);
+    ssize_t n;
+    do {
+        n = ::recv(fd_, in_.data() + at, in_.size() - at, block ? 0 : MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    in_.resize(at + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        close();
+        return false;
+    }
+    return n > 0;
+}
+
+bool GatewayClient::next(GatewayMessage& out, bool block) {
+    for (;;) {
+        if (fd_ < 0) return false;
+        const size_t avail = in_.size() - in_pos_;
+        if (avail >= sizeof(wire::Header)) {
+            wire::Header h;
+            std::memcpy(&h, in_.data() + in_pos_, sizeof(h));
+            const size_t expected = expectedLength(h.type);
+            if (expected == 0 || h.length != expected) {
+                close();  // unframeable stream
+                return false;
+            }
+            if (avail >= h.length) {
+                const char* msg = in_.data() + in_pos_;
+                in_pos_ += h.length;
+                if (h.seq != expected_seq_) ++sequence_gaps_;
+                expected_seq_ = h.seq + 1;
+                out = GatewayMessage{};
+                out.type = h.type;
+                out.seq = h.seq;
+                if (h.type == wire::MsgType::FILL) {
+                    wire::Fill f;
+                    std::memcpy(&f, msg, sizeof(f));
+                    out.order_id = f.order_id;
+                    out.symbol = f.symbol;
+                    out.price = f.price;
+                    out.quantity = f.quantity;
+                } else {
+                    wire::Ack a;
+                    std::memcpy(&a, msg, sizeof(a));
+                    out.order_id = a.order_id;
+                    out.symbol = a.symbol;
+                    out.command = a.command;
+                    out.reason = a.reason;
+                }
+                return true;
+            }
+        }
+        if (!fill(block)) return false;
+    }
+}
+
+} // namespace lob
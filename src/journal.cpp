@@ -0,0 +1,309 @@
+#include "lob/journal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob {
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'O', 'B', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 16;
+
+void encodeHeader(unsigned char* out) noexcept {
+    const uint32_t size = sizeof(JournalRecord);
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    std::memcpy(out + 8, &kVersion, sizeof(kVersion));
+    std::memcpy(out + 12, &size, sizeof(size));
+}
+
+bool headerValid(const unsigned char* in) noexcept {
+    unsigned char expected[kHeaderSize];
+    encodeHeader(expected);
+    return std::memcmp(in, expected, kHeaderSize) == 0;
+}
+
+bool writeAll(int fd, const void* data, size_t len) noexcept {
+    const auto* p = static_cast<const unsigned char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads up to `len` bytes, retrying short reads; returns bytes read.
+size_t readFull(int fd, void* data, size_t len) noexcept {
+    auto* p = static_cast<unsigned char*>(data);
+    size_t got = 0;
+    while (got < len) {
+        const ssize_t n = ::read(fd, p + got, len - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += static_cast<size_t>(n);
+    }
+    return got;
+}
+
+uint64_t steadyUs() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace
+
+// -------- JournalRecord ----------
+
+JournalRecord JournalRecord::fromCommand(const EngineCommand& cmd, uint64_t timestamp) noexcept {
+    JournalRecord r;
+    r.timestamp = timestamp;
+    r.order_id = cmd.order_id;
+    r.price = cmd.price;
+    r.quantity = cmd.quantity;
+    r.symbol = cmd.symbol;
+    r.client = cmd.client;
+    r.type = cmd.type;
+    r.side = cmd.side;
+    r.checksum = r.computeChecksum();
+    return r;
+}
+
+EngineCommand JournalRecord::toCommand() const noexcept {
+    EngineCommand c;
+    c.type = type;
+    c.side = side;
+    c.client = client;
+    c.symbol = symbol;
+    c.order_id = order_id;
+    c.price = price;
+    c.quantity = quantity;
+    return c;
+}
+
+uint32_t JournalRecord::computeChecksum() const noexcept {
+    JournalRecord copy = *this;
+    copy.checksum = 0;
+    unsigned char bytes[sizeof(JournalRecord)];
+    std::memcpy(bytes, &copy, sizeof(bytes));
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (unsigned char b : bytes) {
+        h ^= b;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// -------- Journal ----------
+
+Journal::Journal(const JournalConfig& config)
+    : config_(config), ring_(config.ring_capacity) {
+    config_.max_batch = std::max<size_t>(1, config_.max_batch);
+    buffer_.resize(config_.max_batch);
+}
+
+Journal::~Journal() { close(); }
+
+bool Journal::open(const std::string& path, bool truncate) {
+    if (isOpen()) return false;
+    const int flags = O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0);
+    const int fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    off_t end = 0;
+    if (st.st_size == 0) {
+        unsigned char header[kHeaderSize];
+        encodeHeader(header);
+        if (!writeAll(fd, header, sizeof(header))) {
+            ::close(fd);
+            return false;
+        }
+        end = static_cast<off_t>(kHeaderSize);
+    } else {
+        // Keep only the valid prefix so new records follow the last good one.
+        uint64_t valid = 0;
+        const JournalReplayResult r = replay(path, [&](const JournalRecord*, size_t n) { valid += n; });
+        if (!r.ok) {
+            ::close(fd);
+            return false;
+        }
+        end = static_cast<off_t>(kHeaderSize + valid * sizeof(JournalRecord));
+        if (r.truncated && ::ftruncate(fd, end) != 0) {
+            ::close(fd);
+            return false;
+        }
+    }
+    if (::lseek(fd, end, SEEK_SET) != end) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    end_ = end;
+    stop_requested_.store(false, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    writer_ = std::thread([this] { runWriter(); });
+    return true;
+}
+
+void Journal::close() {
+    if (!isOpen()) return;
+    stop_requested_.store(true, std::memory_order_release);
+    writer_.join();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void Journal::append(const JournalRecord& record) noexcept {
+    if (!ring_.push(record)) {
+        append_stalls_.fetch_add(1, std::memory_order_relaxed);
+        while (!ring_.push(record)) std::this_thread::yield();
+    }
+    appended_.fetch_add(1, std::memory_order_release);
+}
+
+bool Journal::flush() {
+    if (!isOpen()) return false;
+    const uint64_t target = appended_.load(std::memory_order_acquire);
+    // Raise, never lower, the target so concurrent flushers cannot cancel
+    // each other's request.
+    uint64_t requested = sync_target_.load(std::memory_order_relaxed);
+    while (requested < target &&
+           !sync_target_.compare_exchange_weak(requested, target, std::memory_order_release)) {}
+    while (synced_.load(std::memory_order_acquire) < target) {
+        if (failed_.load(std::memory_order_acquire)) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+Journal::Stats Journal::stats() const noexcept {
+    Stats s;
+    s.appended = appended_.load(std::memory_order_relaxed);
+    s.written = written_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.syncs = syncs_.load(std::memory_order_relaxed);
+    s.append_stalls = append_stalls_.load(std::memory_order_relaxed);
+    s.write_errors = write_errors_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Journal::runWriter() {
+    // Records taken off the ring, whether written or dropped.
+    uint64_t consumed = written_.load(std::memory_order_relaxed) + dropped_.load(std::memory_order_relaxed);
+    uint64_t unsynced_batches = 0;
+    uint64_t last_sync_us = steadyUs();
+    for (;;) {
+        const size_t n = writeBatch();
+        consumed += n;
+        if (n != 0) ++unsynced_batches;
+
+        const uint64_t written = written_.load(std::memory_order_relaxed);
+        const uint64_t synced = synced_.load(std::memory_order_relaxed);
+        const bool pending = written > synced && !failed_.load(std::memory_order_relaxed);
+        const bool stopping = n == 0 && stop_requested_.load(std::memory_order_acquire) &&
+                              consumed == appended_.load(std::memory_order_acquire);
+        bool sync_now = false;
+        if (pending) {
+            sync_now = (config_.sync_every != 0 && unsynced_batches >= config_.sync_every) ||
+                       (config_.sync_interval_us != 0 && steadyUs() - last_sync_us >= config_.sync_interval_us) ||
+                       (n == 0 && sync_target_.load(std::memory_order_acquire) > synced) || stopping;
+        }
+        if (sync_now) {
+            sync(written);
+            unsynced_batches = 0;
+            last_sync_us = steadyUs();
+        }
+        if (stopping) break;
+        if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(config_.idle_sleep_us));
+    }
+}
+
+size_t Journal::writeBatch() {
+    size_t n = 0;
+    while (n < buffer_.size() && ring_.pop(buffer_[n])) ++n;
+    if (n == 0) return 0;
+    const size_t bytes = n * sizeof(JournalRecord);
+    if (failed_.load(std::memory_order_relaxed)) {
+        dropped_.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+    if (!writeAll(fd_, buffer_.data(), bytes)) {
+        // Cut off whatever part of the batch made it, so the file still
+        // ends on a whole record.
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        dropped_.fetch_add(n, std::memory_order_relaxed);
+        (void)::ftruncate(fd_, end_);
+        (void)::lseek(fd_, end_, SEEK_SET);
+        failed_.store(true, std::memory_order_release);
+        return n;
+    }
+    end_ += static_cast<off_t>(bytes);
+    written_.fetch_add(n, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    return n;
+}
+
+void Journal::sync(uint64_t written) {
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+    if (::fsync(fd_) != 0) {
+        // What reached the disk is unknown; stop claiming durability.
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        failed_.store(true, std::memory_order_release);
+        return;
+    }
+    synced_.store(written, std::memory_order_release);
+}
+
+JournalReplayResult Journal::replay(const std::string& path, const BatchFn& apply, size_t batch) {
+    JournalReplayResult result;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return result;
+    unsigned char header[kHeaderSize];
+    if (readFull(fd, header, sizeof(header)) != sizeof(header) || !headerValid(header)) {
+        ::close(fd);
+        return result;
+    }
+    result.ok = true;
+
+    std::vector<JournalRecord> records(std::max<size_t>(1, batch));
+    for (;;) {
+        const size_t bytes = readFull(fd, records.data(), records.size() * sizeof(JournalRecord));
+        size_t n = bytes / sizeof(JournalRecord);
+        if (n * sizeof(JournalRecord) != bytes) result.truncated = true;
+        for (size_t i = 0; i < n; ++i) {
+            if (records[i].checksum != records[i].computeChecksum()) {
+                n = i;
+                result.truncated = true;
+                break;
+            }
+        }
+        if (n != 0) {
+            apply(records.data(), n);
+            result.records += n;
+        }
+        if (result.truncated || bytes < records.size() * sizeof(JournalRecord)) break;
+    }
+    ::close(fd);
+    return result;
+}
+
+} // namespace lob
@@ -0,0 +1,235 @@
+#include "lob/l2_publisher.hpp"
+
+#include "lob/concurrent_queue.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace lob {
+
+// -------- L2Ring ----------
+
+struct L2Ring::Header {
+    static constexpr uint64_t kMagic = 0x4c42324c52494e47ull;  // "LB2LRING"
+
+    uint64_t magic;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> tail;  // written by the publisher
+    alignas(64) std::atomic<uint64_t> head;  // written by the subscriber
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring counters must be address-free");
+
+size_t L2Ring::bytesFor(size_t capacity) noexcept {
+    return sizeof(Header) + detail::queueCapacity(capacity) * sizeof(L2Update);
+}
+
+L2Ring L2Ring::create(void* memory, size_t capacity) noexcept {
+    L2Ring r;
+    r.header_ = new (memory) Header{};
+    r.header_->capacity = detail::queueCapacity(capacity);
+    r.header_->tail.store(0, std::memory_order_relaxed);
+    r.header_->head.store(0, std::memory_order_relaxed);
+    r.slots_ = reinterpret_cast<L2Update*>(r.header_ + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.header_->magic = Header::kMagic;
+    return r;
+}
+
+L2Ring L2Ring::attach(void* memory, size_t bytes) noexcept {
+    L2Ring r;
+    auto* h = static_cast<Header*>(memory);
+    if (memory == nullptr || bytes < sizeof(Header) || h->magic != Header::kMagic ||
+        bytes < bytesFor(h->capacity)) {
+        return r;
+    }
+    r.header_ = h;
+    r.slots_ = reinterpret_cast<L2Update*>(h + 1);
+    return r;
+}
+
+size_t L2Ring::capacity() const noexcept { return header_ != nullptr ? header_->capacity : 0; }
+
+size_t L2Ring::freeSlots() const noexcept {
+    const uint64_t used = header_->tail.load(std::memory_order_relaxed) - header_->head.load(std::memory_order_acquire);
+    return static_cast<size_t>(header_->capacity - used);
+}
+
+bool L2Ring::push(const L2Update& u) noexcept {
+    const uint64_t t = header_->tail.load(std::memory_order_relaxed);
+    if (t - header_->head.load(std::memory_order_acquire) >= header_->capacity) return false;
+    slots_[t & (header_->capacity - 1)] = u;
+    header_->tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool L2Ring::pop(L2Update& out) noexcept {
+    const uint64_t h = header_->head.load(std::memory_order_relaxed);
+    if (h == header_->tail.load(std::memory_order_acquire)) return false;
+    out = slots_[h & (header_->capacity - 1)];
+    header_->head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+// -------- L2Subscriber ----------
+
+bool L2Subscriber::attach(const std::string& shm_name) {
+    // The reader advances `head`, so it needs a writable mapping.
+    if (!region_.open(shm_name, true)) return false;
+    ring_ = L2Ring::attach(region_.data(), region_.size());
+    if (!ring_.valid()) region_.close();
+    return ring_.valid();
+}
+
+// -------- L2Publisher ----------
+
+L2Publisher::L2Publisher(const L2PublisherConfig& config) : config_(config) {
+    config_.depth = std::max<uint32_t>(1, config_.depth);
+    for (auto& side : published_) side.reserve(config_.depth);
+    batch_.reserve(4 * config_.depth);
+}
+
+L2Publisher::~L2Publisher() = default;
+
+int L2Publisher::addSubscriber(const std::string& shm_name) {
+    auto sub = std::make_unique<Subscription>();
+    const size_t bytes = L2Ring::bytesFor(config_.ring_capacity);
+    const bool ok = shm_name.empty() ? sub->memory.allocate(bytes) : sub->memory.create(shm_name, bytes);
+    if (!ok) return -1;
+    sub->reader.ring_ = L2Ring::create(sub->memory.data(), config_.ring_capacity);
+
+    // Late joiners start from the current ladder.
+    batch_.clear();
+    for (Side side : {Side::BID, Side::ASK}) {
+        const auto& levels = published_[static_cast<size_t>(side)];
+        for (size_t i = 0; i < levels.size(); ++i) {
+            L2Update u;
+            u.sequence = sequence_;
+            u.price = levels[i].first;
+            u.quantity = levels[i].second;
+            u.rank = static_cast<uint16_t>(i + 1);
+            u.side = side;
+            batch_.push_back(u);
+        }
+    }
+    if (!batch_.empty()) {
+        batch_.back().flags = L2Update::END_OF_BATCH;
+        deliver(*sub, batch_);
+    }
+
+    auto free_slot = std::find(subscribers_.begin(), subscribers_.end(), nullptr);
+    if (free_slot != subscribers_.end()) {
+        *free_slot = std::move(sub);
+        return static_cast<int>(free_slot - subscribers_.begin());
+    }
+    subscribers_.push_back(std::move(sub));
+    return static_cast<int>(subscribers_.size() - 1);
+}
+
+void L2Publisher::removeSubscriber(int id) {
+    if (id >= 0 && static_cast<size_t>(id) < subscribers_.size()) subscribers_[static_cast<size_t>(id)].reset();
+}
+
+L2Subscriber* L2Publisher::subscriber(int id) noexcept {
+    if (id < 0 || static_cast<size_t>(id) >= subscribers_.size() || !subscribers_[static_cast<size_t>(id)]) {
+        return nullptr;
+    }
+    return &subscribers_[static_cast<size_t>(id)]->reader;
+}
+
+L2Publisher::SubscriberStats L2Publisher::stats(int id) const noexcept {
+    if (id < 0 || static_cast<size_t>(id) >= subscribers_.size() || !subscribers_[static_cast<size_t>(id)]) {
+        return {};
+    }
+    const Subscription& sub = *subscribers_[static_cast<size_t>(id)];
+    SubscriberStats s = sub.stats;
+    s.pending = sub.pending.size();
+    return s;
+}
+
+size_t L2Publisher::publish(const OrderBook& book, Timestamp timestamp) {
+    batch_.clear();
+    for (Side side : {Side::BID, Side::ASK}) {
+        scratch_.clear();
+        for (const PriceLevel& level : book.levels(side)) {
+            if (scratch_.size() == config_.depth) break;
+            scratch_.emplace_back(level.price, level.total_quantity);
+        }
+        diffSide(side, scratch_, timestamp);
+        published_[static_cast<size_t>(side)].swap(scratch_);
+    }
+    if (batch_.empty()) {
+        // Nothing new, but let conflated subscribers catch up.
+        for (auto& sub : subscribers_) {
+            if (sub && !sub->pending.empty()) drainPending(*sub);
+        }
+        return 0;
+    }
+    batch_.back().flags = L2Update::END_OF_BATCH;
+    for (auto& sub : subscribers_) {
+        if (sub) deliver(*sub, batch_);
+    }
+    return batch_.size();
+}
+
+void L2Publisher::diffSide(Side side, const std::vector<std::pair<Price, Quantity>>& now, Timestamp timestamp) {
+    const auto& old = published_[static_cast<size_t>(side)];
+    // Both ladders are sorted best first.
+    auto better = [side](Price a, Price b) { return side == Side::BID ? a > b : a < b; };
+    auto emit = [&](Price price, Quantity qty, size_t rank) {
+        L2Update u;
+        u.sequence = ++sequence_;
+        u.timestamp = timestamp;
+        u.price = price;
+        u.quantity = qty;
+        u.rank = static_cast<uint16_t>(rank);
+        u.side = side;
+        batch_.push_back(u);
+    };
+    size_t i = 0, j = 0;
+    while (i < old.size() || j < now.size()) {
+        if (j < now.size() && (i == old.size() || better(now[j].first, old[i].first))) {
+            emit(now[j].first, now[j].second, j + 1);  // new level
+            ++j;
+        } else if (i < old.size() && (j == now.size() || better(old[i].first, now[j].first))) {
+            emit(old[i].first, 0, 0);  // gone
+            ++i;
+        } else {
+            if (old[i].second != now[j].second) emit(now[j].first, now[j].second, j + 1);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void L2Publisher::deliver(Subscription& sub, const std::vector<L2Update>& updates) {
+    L2Ring& ring = sub.reader.ring_;
+    if (sub.pending.empty() && ring.freeSlots() >= updates.size()) {
+        for (const auto& u : updates) ring.push(u);
+        sub.stats.delivered += updates.size();
+        return;
+    }
+    for (const auto& u : updates) {
+        L2Update parked = u;
+        parked.flags = 0;
+        auto [it, inserted] = sub.pending.insert_or_assign({u.side, u.price}, parked);
+        if (!inserted) ++sub.stats.conflated;
+    }
+    drainPending(sub);
+}
+
+void L2Publisher::drainPending(Subscription& sub) {
+    L2Ring& ring = sub.reader.ring_;
+    size_t n = std::min(ring.freeSlots(), sub.pending.size());
+    if (n == 0) return;
+    const bool completes = n == sub.pending.size();
+    auto it = sub.pending.begin();
+    for (; n > 0; --n, ++it) {
+        L2Update u = it->second;
+        if (completes && n == 1) u.flags = L2Update::END_OF_BATCH;
+        ring.push(u);
+        ++sub.stats.delivered;
+    }
+    sub.pending.erase(sub.pending.begin(), it);
+}
+
+} // namespace lob
@@ -1,16 +1,22 @@
 #include "lob/backtester.hpp"
 #include "lob/event.hpp"
+#include "lob/synthetic.hpp"
 #include <iostream>
 
 using namespace lob;
 
-int main() {
+int main(int argc, char** argv) {
     Backtester bt;
     // Add a default market maker strategy. Parameters can be tuned later.
     bt.addStrategy(std::make_unique<MarketMakerStrategy>());
-    // Supply a path to a sample CSV file. This should be replaced with real data.
-    bt.setDataSource(std::make_unique<CSVDataSource>("data/sample_l3.csv"));
+    // Replay the CSV given on the command line, or a synthetic session when
+    // no real data is available.
+    if (argc > 1) {
+        bt.setDataSource(std::make_unique<CSVDataSource>(argv[1]));
+    } else {
+        bt.setDataSource(std::make_unique<SyntheticDataSource>(SyntheticMarketConfig::liquidEquity()));
+    }
     auto res = bt.run();
     std::cout << "Sharpe: " << res.sharpe << "  MaxDD: " << res.max_drawdown << "\n";
     return 0;
-}
\ No newline at end of file
+}
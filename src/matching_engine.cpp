@@ -0,0 +1,461 @@
+#include "lob/matching_engine.hpp"
+#include "lob/journal.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define LOB_CPU_PAUSE() _mm_pause()
+#else
+#define LOB_CPU_PAUSE() std::this_thread::yield()
+#endif
+
+namespace lob {
+
+bool pinCurrentThread(int cpu) noexcept {
+#if defined(__linux__)
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<size_t>(cpu), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+namespace {
+
+// Single-writer counter update: no locked read-modify-write needed.
+inline void bump(std::atomic<uint64_t>& c, uint64_t n = 1) noexcept {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// -------- BookSlot / Shard ----------
+
+struct MatchingEngine::BookSlot {
+    explicit BookSlot(const std::string& symbol) : book(symbol) {}
+    OrderBook book;
+    std::unordered_map<OrderId, ClientId> owners;
+};
+
+class MatchingEngine::Shard {
+public:
+    Shard(MatchingEngine& engine, uint32_t index, int cpu)
+        : engine_(engine), index_(index), cpu_(cpu), commands_(engine.config_.command_capacity) {
+        reports_.reserve(engine.config_.clients);
+        for (uint32_t c = 0; c < engine.config_.clients; ++c) {
+            reports_.push_back(std::make_unique<SpscQueue<EngineReport>>(engine.config_.report_capacity));
+        }
+    }
+
+    void start() {
+        stop_requested_.store(false, std::memory_order_relaxed);
+        thread_ = std::thread([this] { runLoop(); });
+    }
+
+    void stop() {
+        if (!thread_.joinable()) return;
+        stop_requested_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+
+    bool push(const EngineCommand& cmd) noexcept {
+        if (!commands_.push(cmd)) return false;
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    bool poll(ClientId client, EngineReport& out) noexcept { return reports_[client]->pop(out); }
+
+    // Applies a journaled command on the caller's thread while stopped.
+    void replay(const JournalRecord& record) {
+        replaying_ = true;
+        execute(record.toCommand(), record.timestamp);
+        replaying_ = false;
+    }
+
+    ShardLoad load() const noexcept {
+        ShardLoad l;
+        l.cpu = cpu_;
+        l.commands = commands_done_.load(std::memory_order_relaxed);
+        l.batches = batches_.load(std::memory_order_relaxed);
+        l.max_batch = max_batch_.load(std::memory_order_relaxed);
+        l.busy_ns = busy_ns_.load(std::memory_order_relaxed);
+        const uint64_t submitted = submitted_.load(std::memory_order_relaxed);
+        l.queue_depth = submitted > l.commands ? submitted - l.commands : 0;
+        l.reports = reports_sent_.load(std::memory_order_relaxed);
+        l.report_stalls = report_stalls_.load(std::memory_order_relaxed);
+        l.reports_dropped = reports_dropped_.load(std::memory_order_relaxed);
+        return l;
+    }
+
+private:
+    MatchingEngine& engine_;
+    uint32_t index_;
+    int cpu_;
+    MpscQueue<EngineCommand> commands_;
+    std::vector<std::unique_ptr<SpscQueue<EngineReport>>> reports_;  // per client
+    std::atomic<bool> stop_requested_{false};
+    std::thread thread_;
+    bool replaying_ = false;  // suppresses reports during recover()
+
+    alignas(64) std::atomic<uint64_t> submitted_{0};  // written by producers
+    alignas(64) std::atomic<uint64_t> commands_done_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> max_batch_{0};
+    std::atomic<uint64_t> busy_ns_{0};
+    std::atomic<uint64_t> reports_sent_{0};
+    std::atomic<uint64_t> report_stalls_{0};
+    std::atomic<uint64_t> reports_dropped_{0};
+
+    void runLoop() {
+        if (cpu_ >= 0) pinCurrentThread(cpu_);
+        // First touch of this shard's books happens here, after pinning.
+        for (SymbolId s = 0; s < engine_.route_.size(); ++s) {
+            if (engine_.route_[s] == index_ && !engine_.books_[s]) {
+                engine_.books_[s] = std::make_unique<BookSlot>(engine_.symbols_[s]);
+            }
+        }
+        const uint32_t idle_spins = engine_.config_.idle_spins;
+        uint32_t idle = 0;
+        for (;;) {
+            if (drainBatch() != 0) {
+                idle = 0;
+                continue;
+            }
+            // Exit only once a stop was requested and the queue is empty.
+            if (stop_requested_.load(std::memory_order_acquire)) {
+                if (drainBatch() == 0) break;
+                continue;
+            }
+            if (++idle < idle_spins) {
+                LOB_CPU_PAUSE();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t drainBatch() {
+        EngineCommand cmd;
+        if (!commands_.pop(cmd)) return 0;
+        const uint64_t t0 = nowNs();
+        const size_t max_batch = engine_.config_.max_batch;
+        size_t n = 0;
+        do {
+            apply(cmd);
+            ++n;
+        } while (n < max_batch && commands_.pop(cmd));
+        bump(busy_ns_, nowNs() - t0);
+        bump(commands_done_, n);
+        bump(batches_);
+        if (n > max_batch_.load(std::memory_order_relaxed)) max_batch_.store(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    void apply(const EngineCommand& cmd) {
+        bump(engine_.symbol_commands_[cmd.symbol]);
+        const uint64_t ts = nowNs();
+        if (execute(cmd, ts) && engine_.config_.journal != nullptr) {
+            engine_.config_.journal->append(JournalRecord::fromCommand(cmd, ts));
+        }
+    }
+
+    // Applies `cmd` at time `ts`, publishing its reports.  Returns whether
+    // the command was accepted.
+    bool execute(const EngineCommand& cmd, uint64_t ts) {
+        EngineReport r;
+        r.command = cmd.type;
+        r.symbol = cmd.symbol;
+        r.order_id = cmd.order_id;
+        r.price = cmd.price;
+        r.quantity = cmd.quantity;
+        r.submit_ns = cmd.submit_ns;
+
+        BookSlot* slot = engine_.books_[cmd.symbol].get();
+        OrderBook& book = slot->book;
+        auto& owners = slot->owners;
+
+        // Only the owner may modify or cancel a resting order.
+        auto owned = [&]() {
+            auto it = owners.find(cmd.order_id);
+            return it != owners.end() && it->second == cmd.client;
+        };
+
+        switch (cmd.type) {
+            case EngineCommand::ADD: {
+                const SubmitResult sr = book.submitOrder(Order{cmd.order_id, cmd.price, cmd.quantity, cmd.side, ts});
+                if (sr.status == SubmitResult::REJECTED) {
+                    r.type = EngineReport::REJECT;
+                    publish(cmd.client, r);
+                    return false;
+                }
+                owners[cmd.order_id] = cmd.client;
+                r.type = EngineReport::ACK;
+                publish(cmd.client, r);
+                publishFills(*slot, sr.executions, cmd);
+                if (sr.status != SubmitResult::RESTING) owners.erase(cmd.order_id);
+                return true;
+            }
+            case EngineCommand::MODIFY: {
+                const bool reprice = cmd.price != 0;
+                const bool ok = owned() && (reprice ? book.replaceOrder(cmd.order_id, cmd.price, cmd.quantity)
+                                                    : book.modifyOrder(cmd.order_id, cmd.quantity));
+                r.type = ok ? EngineReport::ACK : EngineReport::REJECT;
+                publish(cmd.client, r);
+                // A new price may cross the spread.
+                if (ok && reprice) publishFills(*slot, book.matchOrders(), cmd);
+                return ok;
+            }
+            case EngineCommand::CANCEL:
+                if (owned() && book.cancelOrder(cmd.order_id)) {
+                    owners.erase(cmd.order_id);
+                    r.type = EngineReport::ACK;
+                } else {
+                    r.type = EngineReport::REJECT;
+                }
+                publish(cmd.client, r);
+                return r.type == EngineReport::ACK;
+            case EngineCommand::MARKET:
+                r.type = EngineReport::ACK;
+                publish(cmd.client, r);
+                publishFills(*slot, book.processMarketOrder(cmd.side, cmd.quantity, ts), cmd);
+                return true;
+        }
+        return false;
+    }
+
+    void publishFills(BookSlot& slot, const std::vector<Execution>& execs, const EngineCommand& cause) {
+        EngineReport r;
+        r.type = EngineReport::FILL;
+        r.command = cause.type;
+        r.symbol = cause.symbol;
+        r.submit_ns = cause.submit_ns;
+        for (const auto& ex : execs) {
+            r.price = ex.price;
+            r.quantity = ex.quantity;
+            for (OrderId id : {ex.bid_id, ex.ask_id}) {
+                if (id == 0) {
+                    r.order_id = cause.order_id;  // market order aggressor
+                    publish(cause.client, r);
+                    continue;
+                }
+                auto it = slot.owners.find(id);
+                if (it == slot.owners.end()) continue;
+                r.order_id = id;
+                publish(it->second, r);
+                if (slot.book.getOrder(id) == nullptr) slot.owners.erase(it);
+            }
+        }
+    }
+
+    void publish(ClientId client, const EngineReport& report) {
+        if (replaying_) return;
+        EngineReport r = report;
+        r.publish_ns = nowNs();
+        auto& q = *reports_[client];
+        if (!q.push(r)) {
+            bump(report_stalls_);
+            while (!q.push(r)) {
+                if (stop_requested_.load(std::memory_order_acquire)) {
+                    bump(reports_dropped_);
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+        bump(reports_sent_);
+    }
+};
+
+// -------- MatchingEngine ----------
+
+uint64_t MatchingEngine::nowNs() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+uint32_t MatchingEngine::hashSymbol(const std::string& symbol) noexcept {
+    // FNV-1a: stable across platforms and standard libraries, so a symbol
+    // always lands on the same shard for a given shard count.
+    uint32_t h = 2166136261u;
+    for (char c : symbol) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+MatchingEngine::MatchingEngine(const MatchingEngineConfig& config)
+    : config_(config), poll_cursors_(config.clients) {
+    config_.shards = std::max<uint32_t>(1, config_.shards);
+    config_.max_batch = std::max<size_t>(1, config_.max_batch);
+    shards_.reserve(config_.shards);
+    for (uint32_t i = 0; i < config_.shards; ++i) {
+        const int cpu = config_.cpus.empty() ? -1 : config_.cpus[i % config_.cpus.size()];
+        shards_.push_back(std::make_unique<Shard>(*this, i, cpu));
+    }
+}
+
+MatchingEngine::~MatchingEngine() { stop(); }
+
+SymbolId MatchingEngine::addSymbol(const std::string& symbol) {
+    // Growing the tables would move them under submit() and the shards.
+    if (running_) return kInvalidSymbol;
+    auto it = symbol_ids_.find(symbol);
+    if (it != symbol_ids_.end()) return it->second;
+    const auto id = static_cast<SymbolId>(symbols_.size());
+    symbols_.push_back(symbol);
+    symbol_ids_.emplace(symbol, id);
+    route_.push_back(hashSymbol(symbol) % config_.shards);
+    books_.emplace_back();
+    return id;
+}
+
+bool MatchingEngine::findSymbol(const std::string& symbol, SymbolId& out) const {
+    auto it = symbol_ids_.find(symbol);
+    if (it == symbol_ids_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool MatchingEngine::assignShard(SymbolId symbol, uint32_t shard) {
+    if (running_ || symbol >= route_.size() || shard >= config_.shards) return false;
+    route_[symbol] = shard;  // the book, if any, is served by the new shard from where it lives
+    return true;
+}
+
+JournalReplayResult MatchingEngine::recover(const std::string& path) {
+    if (running_) return JournalReplayResult{};
+    return Journal::replay(path, [this](const JournalRecord* records, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const JournalRecord& rec = records[i];
+            if (rec.symbol >= route_.size()) continue;
+            auto& slot = books_[rec.symbol];
+            if (!slot) slot = std::make_unique<BookSlot>(symbols_[rec.symbol]);
+            shards_[route_[rec.symbol]]->replay(rec);
+        }
+    });
+}
+
+void MatchingEngine::start() {
+    if (running_) return;
+    // Per-symbol counters are fixed while running; grow them, keeping the
+    // totals so far, when symbols were added since the last run.
+    if (symbol_counts_size_ != symbols_.size()) {
+        auto counts = std::make_unique<std::atomic<uint64_t>[]>(symbols_.size());
+        for (size_t s = 0; s < symbols_.size(); ++s) {
+            const uint64_t prev = s < symbol_counts_size_ ? symbol_commands_[s].load(std::memory_order_relaxed) : 0;
+            counts[s].store(prev, std::memory_order_relaxed);
+        }
+        symbol_commands_ = std::move(counts);
+        symbol_counts_size_ = symbols_.size();
+    }
+    running_ = true;
+    for (auto& s : shards_) s->start();
+}
+
+void MatchingEngine::stop() {
+    if (!running_) return;
+    for (auto& s : shards_) s->stop();
+    running_ = false;
+}
+
+bool MatchingEngine::submit(EngineCommand cmd) noexcept {
+    if (cmd.client >= config_.clients || cmd.symbol >= route_.size()) return false;
+    cmd.submit_ns = nowNs();
+    return shards_[route_[cmd.symbol]]->push(cmd);
+}
+
+bool MatchingEngine::poll(ClientId client, EngineReport& out) noexcept {
+    if (client >= config_.clients) return false;
+    uint32_t& next = poll_cursors_[client].next;
+    const auto n = static_cast<uint32_t>(shards_.size());
+    for (uint32_t k = 0; k < n; ++k) {
+        const uint32_t s = next;
+        next = next + 1 == n ? 0 : next + 1;
+        if (shards_[s]->poll(client, out)) return true;
+    }
+    return false;
+}
+
+std::vector<MatchingEngine::ShardLoad> MatchingEngine::shardLoads() const {
+    std::vector<ShardLoad> out;
+    out.reserve(shards_.size());
+    for (const auto& s : shards_) out.push_back(s->load());
+    for (uint32_t shard : route_) ++out[shard].symbols;
+    return out;
+}
+
+uint64_t MatchingEngine::symbolCommands(SymbolId symbol) const noexcept {
+    if (symbol >= symbol_counts_size_) return 0;
+    return symbol_commands_[symbol].load(std::memory_order_relaxed);
+}
+
+std::vector<std::pair<SymbolId, uint64_t>> MatchingEngine::hottestSymbols(size_t n) const {
+    std::vector<std::pair<SymbolId, uint64_t>> all;
+    all.reserve(symbols_.size());
+    for (SymbolId s = 0; s < symbols_.size(); ++s) all.emplace_back(s, symbolCommands(s));
+    n = std::min(n, all.size());
+    std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(n), all.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+    all.resize(n);
+    return all;
+}
+
+const OrderBook* MatchingEngine::book(SymbolId symbol) const noexcept {
+    if (symbol >= books_.size() || !books_[symbol]) return nullptr;
+    return &books_[symbol]->book;
+}
+
+// -------- BookEngine ----------
+
+namespace {
+
+MatchingEngineConfig singleShard(const BookEngineConfig& c) {
+    MatchingEngineConfig m;
+    m.shards = 1;
+    if (c.cpu >= 0) m.cpus.push_back(c.cpu);
+    m.clients = c.clients;
+    m.command_capacity = c.command_capacity;
+    m.report_capacity = c.report_capacity;
+    m.max_batch = c.max_batch;
+    m.idle_spins = c.idle_spins;
+    return m;
+}
+
+} // namespace
+
+BookEngine::BookEngine(const std::string& symbol, const BookEngineConfig& config)
+    : empty_(symbol), engine_(singleShard(config)) {
+    engine_.addSymbol(symbol);
+}
+
+const OrderBook& BookEngine::book() const noexcept {
+    const OrderBook* b = engine_.book(0);
+    return b != nullptr ? *b : empty_;
+}
+
+BookEngine::Stats BookEngine::stats() const {
+    const auto l = engine_.shardLoads().front();
+    Stats s;
+    s.commands = l.commands;
+    s.batches = l.batches;
+    s.max_batch = l.max_batch;
+    s.reports = l.reports;
+    s.report_stalls = l.report_stalls;
+    s.reports_dropped = l.reports_dropped;
+    return s;
+}
+
+} // namespace lob
@@ -1,4 +1,5 @@
 #include "lob/order_book.hpp"
+#include "lob/alloc_tracker.hpp"
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -51,6 +52,20 @@ void PriceLevel::modifyOrder(Order* order, Quantity new_qty) noexcept {
     order->quantity = std::max(order->quantity, new_qty);
 }
 
+namespace {
+
+// splitmix64 finaliser
+inline uint64_t mix64(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
 // OrderBook implementation
 OrderBook::OrderBook(const std::string& symbol) 
     : symbol_(symbol) {
@@ -61,23 +76,22 @@ OrderBook::OrderBook(const std::string& symbol)
 }
 
 bool OrderBook::addOrder(Order order) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_ADD);
     auto start = std::chrono::steady_clock::now();
     
     // Check for duplicate order ID
-    if (orders_.find(order.id) != orders_.end()) {
+    if (orders_.find(order.id) != orders_.end() ||
+        (!stop_orders_.empty() && stop_orders_.find(order.id) != stop_orders_.end())) {
         return false;
     }
     
-    // Create order object
-    auto order_ptr = std::make_unique<Order>(std::move(order));
-    Order* raw_ptr = order_ptr.get();
+    // Store order (from the pool when one is free)
+    Order* raw_ptr = storeOrder(std::move(order));
     
     // Get or create price level
     PriceLevel* level = getOrCreateLevel(raw_ptr->price, raw_ptr->side);
-    level->addOrder(raw_ptr);
-    
-    // Store order
-    orders_[raw_ptr->id] = std::move(order_ptr);
+    enqueue(level, raw_ptr);
+    index(raw_ptr);
     
     // Update metrics
     ++metrics_.orders_added;
@@ -90,6 +104,7 @@ bool OrderBook::addOrder(Order order) noexcept {
 }
 
 bool OrderBook::modifyOrder(OrderId id, Quantity new_quantity) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_MODIFY);
     auto start = std::chrono::steady_clock::now();
     
     auto it = orders_.find(id);
@@ -98,17 +113,21 @@ bool OrderBook::modifyOrder(OrderId id, Quantity new_quantity) noexcept {
     }
     
     Order* order = it->second.get();
+    state_hash_ ^= hashOrder(*order);
     
     // If increasing quantity, move to back of queue (price‑time priority)
     if (new_quantity > order->remaining_quantity) {
         PriceLevel* level = order->level;
-        level->removeOrder(order);
+        dequeue(level, order);
         order->remaining_quantity = new_quantity;
         order->quantity = new_quantity;
-        level->addOrder(order);
+        enqueue(level, order);
     } else {
         // Decreasing quantity maintains queue position
+        addDepth(order->side, order->price,
+                 static_cast<int64_t>(new_quantity) - static_cast<int64_t>(order->remaining_quantity));
         order->level->modifyOrder(order, new_quantity);
+        state_hash_ ^= hashOrder(*order);
     }
     
     ++metrics_.orders_modified;
@@ -121,18 +140,21 @@ bool OrderBook::modifyOrder(OrderId id, Quantity new_quantity) noexcept {
 }
 
 bool OrderBook::cancelOrder(OrderId id) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_CANCEL);
     auto start = std::chrono::steady_clock::now();
     
     auto it = orders_.find(id);
     if (it == orders_.end()) {
-        return false;
+        return cancelStop(id);
     }
     
     Order* order = it->second.get();
     PriceLevel* level = order->level;
+    state_hash_ ^= hashOrder(*order);
     
     // Remove from level
-    level->removeOrder(order);
+    dequeue(level, order);
+    unindex(order);
     
     // Remove empty level
     if (level->empty()) {
@@ -140,7 +162,7 @@ bool OrderBook::cancelOrder(OrderId id) noexcept {
     }
     
     // Remove order
-    orders_.erase(it);
+    recycleOrder(it);
     
     ++metrics_.orders_canceled;
     invalidateCache();
@@ -151,33 +173,420 @@ bool OrderBook::cancelOrder(OrderId id) noexcept {
     return true;
 }
 
+bool OrderBook::replaceOrder(OrderId id, Price new_price, Quantity new_quantity, OrderId new_id) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_MODIFY);
+    auto start = std::chrono::steady_clock::now();
+    
+    if (new_quantity == 0) {
+        return false;
+    }
+    auto it = orders_.find(id);
+    if (it == orders_.end()) {
+        return false;
+    }
+    const bool rekey = new_id != 0 && new_id != id;
+    if (rekey && (orders_.find(new_id) != orders_.end() || stop_orders_.find(new_id) != stop_orders_.end())) {
+        return false;
+    }
+    
+    Order* order = it->second.get();
+    PriceLevel* level = order->level;
+    state_hash_ ^= hashOrder(*order);
+    
+    if (rekey) {
+        // Re-key the index node in place rather than erase and insert.
+        auto node = orders_.extract(it);
+        node.key() = new_id;
+        orders_.insert(std::move(node));
+        order->id = new_id;
+    }
+    
+    if (!rekey && new_price == order->price && new_quantity <= order->remaining_quantity) {
+        // Same price, no larger: keeps queue position
+        addDepth(order->side, order->price,
+                 static_cast<int64_t>(new_quantity) - static_cast<int64_t>(order->remaining_quantity));
+        level->modifyOrder(order, new_quantity);
+        state_hash_ ^= hashOrder(*order);
+    } else {
+        dequeue(level, order);
+        if (new_price != order->price) {
+            level = moveLevel(level, new_price);
+        }
+        order->price = new_price;
+        order->quantity = new_quantity;
+        order->remaining_quantity = new_quantity;
+        enqueue(level, order);
+    }
+    
+    ++metrics_.orders_modified;
+    invalidateCache();
+    
+    auto end = std::chrono::steady_clock::now();
+    metrics_.total_latency += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    
+    return true;
+}
+
+size_t OrderBook::cancelAll(uint32_t participant, std::vector<OrderId>* canceled) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_CANCEL);
+    auto start = std::chrono::steady_clock::now();
+    
+    if (participant == 0) {
+        return 0;
+    }
+    const size_t stops = cancelStops(participant, canceled);
+    auto head = participant_orders_.find(participant);
+    if (head == participant_orders_.end() || head->second == nullptr) {
+        return stops;
+    }
+    size_t n = 0;
+    for (Order* order = head->second; order != nullptr; ++n) {
+        Order* next = order->participant_next;
+        PriceLevel* level = order->level;
+        state_hash_ ^= hashOrder(*order);
+        if (canceled) canceled->push_back(order->id);
+        expiry_.cancel(order);
+        dequeue(level, order);
+        if (level->empty()) {
+            removeEmptyLevel(level->price, level->side);
+        }
+        recycleOrder(orders_.find(order->id));
+        order = next;
+    }
+    head->second = nullptr;
+    
+    metrics_.orders_canceled += n;
+    invalidateCache();
+    
+    auto end = std::chrono::steady_clock::now();
+    metrics_.total_latency += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    
+    return n + stops;
+}
+
+size_t OrderBook::cancelSide(Side side, std::vector<OrderId>* canceled) noexcept {
+    auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    const size_t n = sweepLevels(levels, levels.begin(), levels.end(), canceled);
+    return n + cancelStopsIf(stop_ladder_[static_cast<size_t>(side)],
+                             [](const StopEntry&, const Order&) { return true; }, canceled);
+}
+
+size_t OrderBook::cancelRange(Side side, Price from, Price to, std::vector<OrderId>* canceled) noexcept {
+    auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    const Price lo = std::min(from, to);
+    const Price hi = std::max(from, to);
+    // Levels run best first: bids high to low, asks low to high.
+    const Price first = (side == Side::BID) ? hi : lo;
+    const Price last = (side == Side::BID) ? lo : hi;
+    const size_t n = sweepLevels(levels, levels.lower_bound(first), levels.upper_bound(last), canceled);
+    return n + cancelStopsIf(stop_ladder_[static_cast<size_t>(side)],
+                             [lo, hi](const StopEntry& e, const Order&) {
+                                 return e.stop_price >= lo && e.stop_price <= hi;
+                             },
+                             canceled);
+}
+
+size_t OrderBook::sweepLevels(LevelMap& levels, LevelMap::iterator first, LevelMap::iterator last,
+                              std::vector<OrderId>* canceled) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_CANCEL);
+    auto start = std::chrono::steady_clock::now();
+    
+    size_t n = 0;
+    for (auto it = first; it != last; ++it) {
+        addDepth(it->second->side, it->first, -static_cast<int64_t>(it->second->total_quantity));
+        side_orders_[static_cast<size_t>(it->second->side)] -= it->second->order_count;
+        // Whole levels go, so the level lists need no unlinking.
+        for (Order* order = it->second->front(); order != nullptr; ++n) {
+            Order* next = order->next;
+            state_hash_ ^= hashOrder(*order);
+            if (canceled) canceled->push_back(order->id);
+            unindex(order);
+            recycleOrder(orders_.find(order->id));
+            order = next;
+        }
+    }
+    if (n == 0) {
+        return 0;
+    }
+    while (first != last) {
+        recycleLevel(levels, first++);
+    }
+    
+    metrics_.orders_canceled += n;
+    invalidateCache();
+    
+    auto end = std::chrono::steady_clock::now();
+    metrics_.total_latency += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    
+    return n;
+}
+
+SubmitResult OrderBook::submitOrder(Order order) noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_ADD);
+    auto start = std::chrono::steady_clock::now();
+    
+    SubmitResult result;
+    if (order.quantity == 0 || (order.tif == TimeInForce::GTD && order.expire_time <= clock_) ||
+        orders_.find(order.id) != orders_.end() || stop_orders_.find(order.id) != stop_orders_.end()) {
+        return result;
+    }
+    const bool stop = order.type == OrderType::STOP || order.type == OrderType::STOP_LIMIT;
+    if (stop) {
+        if (!stopTriggered(order)) {
+            parkStop(order);
+            result.status = SubmitResult::PENDING;
+            return result;
+        }
+        ++metrics_.stops_triggered;
+        result.triggered.push_back(order.id);
+    }
+    
+    result.status = execute(order, result.filled, result.executions);
+    if (!result.executions.empty()) {
+        releaseStops(result.executions, &result.triggered);
+    }
+    invalidateCache();
+    
+    auto end = std::chrono::steady_clock::now();
+    metrics_.total_latency += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    
+    return result;
+}
+
+size_t OrderBook::advanceTime(Timestamp now, std::vector<OrderId>* expired) noexcept {
+    if (now <= clock_) {
+        return 0;
+    }
+    clock_ = now;
+    if (expiry_.empty()) {
+        expiry_.advance(now, due_);  // only moves the wheel
+        return 0;
+    }
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_CANCEL);
+    due_.clear();
+    expiry_.advance(now, due_);
+    for (Order* order : due_) {
+        if (expired) expired->push_back(order->id);
+        if (order->type == OrderType::STOP || order->type == OrderType::STOP_LIMIT) {
+            dropStop(stop_orders_.find(order->id));  // still parked
+            continue;
+        }
+        PriceLevel* level = order->level;
+        state_hash_ ^= hashOrder(*order);
+        unlinkParticipant(order);
+        dequeue(level, order);
+        if (level->empty()) {
+            removeEmptyLevel(level->price, level->side);
+        }
+        recycleOrder(orders_.find(order->id));
+    }
+    metrics_.orders_expired += due_.size();
+    if (!due_.empty()) {
+        invalidateCache();
+    }
+    return due_.size();
+}
+
 std::vector<Execution> OrderBook::processMarketOrder(
     Side side, Quantity quantity, Timestamp timestamp) noexcept {
-    
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_MARKET);
+
     std::vector<Execution> executions;
     executions.reserve(10);  // Pre‑allocate for typical fills
+    const Price limit = (side == Side::BID) ? std::numeric_limits<Price>::max()
+                                            : std::numeric_limits<Price>::min();
+    sweep(side, limit, quantity, 0, timestamp, executions);
+    if (!executions.empty()) {
+        releaseStops(executions, nullptr);
+    }
+    invalidateCache();
+    return executions;
+}
+
+SubmitResult::Status OrderBook::execute(Order& order, Quantity& filled,
+                                        std::vector<Execution>& executions) noexcept {
+    if (order.type == OrderType::STOP) {
+        order.type = OrderType::MARKET;
+    } else if (order.type == OrderType::STOP_LIMIT) {
+        order.type = OrderType::LIMIT;
+    }
+    const bool market = order.type == OrderType::MARKET;
+    const Price limit = !market ? order.price
+                      : order.side == Side::BID ? std::numeric_limits<Price>::max()
+                                                : std::numeric_limits<Price>::min();
+    if (order.tif == TimeInForce::FOK && crossingDepth(order.side, limit, order.quantity) < order.quantity) {
+        return SubmitResult::REJECTED;
+    }
     
+    const Quantity left = sweep(order.side, limit, order.quantity, order.id, order.timestamp, executions);
+    filled = order.quantity - left;
+    if (left == 0) {
+        return SubmitResult::FILLED;
+    }
+    if (market || order.tif == TimeInForce::IOC) {
+        return SubmitResult::CANCELLED;
+    }
+    order.remaining_quantity = left;
+    Order* raw_ptr = storeOrder(std::move(order));
+    enqueue(getOrCreateLevel(raw_ptr->price, raw_ptr->side), raw_ptr);
+    index(raw_ptr);
+    ++metrics_.orders_added;
+    return SubmitResult::RESTING;
+}
+
+bool OrderBook::stopBefore(Side side, const StopEntry& a, const StopEntry& b) noexcept {
+    if (a.stop_price != b.stop_price) {
+        return side == Side::BID ? a.stop_price > b.stop_price : a.stop_price < b.stop_price;
+    }
+    return a.sequence > b.sequence;
+}
+
+bool OrderBook::stopTriggered(const Order& order) const noexcept {
+    if (last_trade_price_ == 0) {
+        return false;
+    }
+    return order.side == Side::BID ? last_trade_price_ >= order.stop_price
+                                   : last_trade_price_ <= order.stop_price;
+}
+
+void OrderBook::parkStop(const Order& order) noexcept {
+    Order& parked = stop_orders_.emplace(order.id, order).first->second;
+    parked.remaining_quantity = parked.quantity;
+    parked.sequence = ++stop_seq_;
+    const Side side = parked.side;
+    const StopEntry entry{parked.stop_price, parked.sequence, parked.id};
+    auto& ladder = stop_ladder_[static_cast<size_t>(side)];
+    ladder.insert(std::upper_bound(ladder.begin(), ladder.end(), entry,
+                                   [side](const StopEntry& a, const StopEntry& b) { return stopBefore(side, a, b); }),
+                  entry);
+    // Map nodes do not move, so a parked GTD stop can sit in the wheel.
+    if (parked.tif == TimeInForce::GTD) {
+        expiry_.schedule(&parked);
+    }
+}
+
+bool OrderBook::cancelStop(OrderId id) noexcept {
+    auto it = stop_orders_.find(id);
+    if (it == stop_orders_.end()) {
+        return false;
+    }
+    dropStop(it);
+    ++metrics_.orders_canceled;
+    return true;
+}
+
+void OrderBook::dropStop(std::unordered_map<OrderId, Order>::iterator it) noexcept {
+    const Side side = it->second.side;
+    const StopEntry entry{it->second.stop_price, it->second.sequence, it->first};
+    auto& ladder = stop_ladder_[static_cast<size_t>(side)];
+    auto pos = std::lower_bound(ladder.begin(), ladder.end(), entry,
+                                [side](const StopEntry& a, const StopEntry& b) { return stopBefore(side, a, b); });
+    if (pos != ladder.end() && pos->id == entry.id) {
+        ladder.erase(pos);
+    }
+    expiry_.cancel(&it->second);
+    stop_orders_.erase(it);
+}
+
+template <typename Pred>
+size_t OrderBook::cancelStopsIf(std::vector<StopEntry>& ladder, Pred pred, std::vector<OrderId>* canceled) noexcept {
+    size_t n = 0;
+    // Keeps ladder order; ids are reported in firing order.
+    auto keep = std::remove_if(ladder.rbegin(), ladder.rend(), [&](const StopEntry& e) {
+        auto it = stop_orders_.find(e.id);
+        if (!pred(e, it->second)) {
+            return false;
+        }
+        if (canceled) canceled->push_back(e.id);
+        expiry_.cancel(&it->second);
+        stop_orders_.erase(it);
+        ++n;
+        return true;
+    });
+    ladder.erase(ladder.begin(), keep.base());
+    metrics_.orders_canceled += n;
+    return n;
+}
+
+size_t OrderBook::cancelStops(uint32_t participant, std::vector<OrderId>* canceled) noexcept {
+    if (stop_orders_.empty()) {
+        return 0;
+    }
+    size_t n = 0;
+    for (auto& ladder : stop_ladder_) {
+        n += cancelStopsIf(
+            ladder, [participant](const StopEntry&, const Order& o) { return o.participant_id == participant; },
+            canceled);
+    }
+    return n;
+}
+
+void OrderBook::releaseStops(std::vector<Execution>& executions, std::vector<OrderId>* triggered) noexcept {
+    // Each round fires every stop the current last price has crossed; the
+    // trades they make may cross more, which fire in the next round.
+    while (!stop_orders_.empty()) {
+        stop_batch_.clear();
+        auto& buys = stop_ladder_[static_cast<size_t>(Side::BID)];
+        while (!buys.empty() && last_trade_price_ >= buys.back().stop_price) {
+            stop_batch_.push_back(buys.back());
+            buys.pop_back();
+        }
+        auto& sells = stop_ladder_[static_cast<size_t>(Side::ASK)];
+        while (!sells.empty() && last_trade_price_ <= sells.back().stop_price) {
+            stop_batch_.push_back(sells.back());
+            sells.pop_back();
+        }
+        if (stop_batch_.empty()) {
+            break;
+        }
+        // Arrival order across both sides and all crossed prices.
+        if (stop_batch_.size() > 1) {
+            std::sort(stop_batch_.begin(), stop_batch_.end(),
+                      [](const StopEntry& a, const StopEntry& b) { return a.sequence < b.sequence; });
+        }
+        for (const StopEntry& entry : stop_batch_) {
+            auto it = stop_orders_.find(entry.id);
+            // Expired stops already left through advanceTime().
+            expiry_.cancel(&it->second);
+            Order order = it->second;
+            stop_orders_.erase(it);
+            ++metrics_.stops_triggered;
+            if (triggered) triggered->push_back(order.id);
+            Quantity filled = 0;
+            execute(order, filled, executions);
+        }
+    }
+}
+
+Quantity OrderBook::sweep(Side side, Price limit, Quantity quantity, OrderId aggressor, Timestamp timestamp,
+                          std::vector<Execution>& executions) noexcept {
     auto& opposite_levels = (side == Side::BID) ? ask_levels_ : bid_levels_;
     Quantity remaining = quantity;
     
     while (remaining > 0 && !opposite_levels.empty()) {
         auto& [price, level] = *opposite_levels.begin();
+        if (side == Side::BID ? price > limit : price < limit) {
+            break;  // no longer crosses
+        }
         
         while (remaining > 0 && !level->empty()) {
             Order* order = level->front();
             Quantity fill_qty = std::min(remaining, order->remaining_quantity);
             
             // Create execution
+            last_trade_price_ = price;
             if (side == Side::BID) {
-                executions.emplace_back(0, order->id, price, fill_qty, timestamp);
+                executions.emplace_back(aggressor, order->id, price, fill_qty, timestamp);
             } else {
-                executions.emplace_back(order->id, 0, price, fill_qty, timestamp);
+                executions.emplace_back(order->id, aggressor, price, fill_qty, timestamp);
             }
             
             // Update quantities
+            state_hash_ ^= hashOrder(*order);
             remaining -= fill_qty;
             order->remaining_quantity -= fill_qty;
             level->total_quantity -= fill_qty;
+            addDepth(level->side, price, -static_cast<int64_t>(fill_qty));
             
             metrics_.total_volume += fill_qty;
             ++metrics_.orders_matched;
@@ -185,22 +594,41 @@ std::vector<Execution> OrderBook::processMarketOrder(
             // Remove filled order
             if (order->isFilled()) {
                 OrderId filled_id = order->id;
-                level->removeOrder(order);
-                orders_.erase(filled_id);
+                dequeue(level.get(), order);
+                unindex(order);
+                recycleOrder(orders_.find(filled_id));
+            } else {
+                state_hash_ ^= hashOrder(*order);
             }
         }
         
         // Remove empty level
         if (level->empty()) {
-            opposite_levels.erase(opposite_levels.begin());
+            recycleLevel(opposite_levels, opposite_levels.begin());
         }
     }
-    
-    invalidateCache();
-    return executions;
+    return remaining;
+}
+
+Quantity OrderBook::crossingDepth(Side side, Price limit, Quantity needed) const noexcept {
+    const Side opposite = (side == Side::BID) ? Side::ASK : Side::BID;
+    if (depth_[static_cast<size_t>(opposite)].exact()) {
+        return static_cast<Quantity>(std::min<uint64_t>(depthAtOrBetter(opposite, limit), needed));
+    }
+    // Too wide to index: walk the levels until enough is found.
+    const auto& opposite_levels = (side == Side::BID) ? ask_levels_ : bid_levels_;
+    uint64_t depth = 0;
+    for (const auto& [price, level] : opposite_levels) {
+        if (depth >= needed || (side == Side::BID ? price > limit : price < limit)) {
+            break;
+        }
+        depth += level->total_quantity;
+    }
+    return static_cast<Quantity>(std::min<uint64_t>(depth, needed));
 }
 
 std::vector<Execution> OrderBook::matchOrders() noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_MATCH);
     std::vector<Execution> executions;
     
     while (!bid_levels_.empty() && !ask_levels_.empty()) {
@@ -225,12 +653,16 @@ std::vector<Execution> OrderBook::matchOrders() noexcept {
             // Create execution
             executions.emplace_back(bid->id, ask->id, match_price, 
                                    match_qty, std::max(bid->timestamp, ask->timestamp));
+            last_trade_price_ = match_price;
             
             // Update orders
+            state_hash_ ^= hashOrder(*bid) ^ hashOrder(*ask);
             bid->remaining_quantity -= match_qty;
             ask->remaining_quantity -= match_qty;
             bid_level->total_quantity -= match_qty;
             ask_level->total_quantity -= match_qty;
+            addDepth(Side::BID, bid_level->price, -static_cast<int64_t>(match_qty));
+            addDepth(Side::ASK, ask_level->price, -static_cast<int64_t>(match_qty));
             
             metrics_.total_volume += match_qty;
             ++metrics_.orders_matched;
@@ -238,26 +670,33 @@ std::vector<Execution> OrderBook::matchOrders() noexcept {
             // Remove filled orders
             if (bid->isFilled()) {
                 OrderId bid_id = bid->id;
-                bid_level->removeOrder(bid);
-                orders_.erase(bid_id);
+                dequeue(bid_level.get(), bid);
+                unindex(bid);
+                recycleOrder(orders_.find(bid_id));
+            } else {
+                state_hash_ ^= hashOrder(*bid);
             }
             if (ask->isFilled()) {
                 OrderId ask_id = ask->id;
-                ask_level->removeOrder(ask);
-                orders_.erase(ask_id);
+                dequeue(ask_level.get(), ask);
+                unindex(ask);
+                recycleOrder(orders_.find(ask_id));
+            } else {
+                state_hash_ ^= hashOrder(*ask);
             }
         }
         
         // Remove empty levels
         if (bid_level->empty()) {
-            bid_levels_.erase(bid_levels_.begin());
+            recycleLevel(bid_levels_, bid_levels_.begin());
         }
         if (ask_level->empty()) {
-            ask_levels_.erase(ask_levels_.begin());
+            recycleLevel(ask_levels_, ask_levels_.begin());
         }
     }
     
     if (!executions.empty()) {
+        releaseStops(executions, nullptr);
         invalidateCache();
     }
     
@@ -266,7 +705,11 @@ std::vector<Execution> OrderBook::matchOrders() noexcept {
 
 const Order* OrderBook::getOrder(OrderId id) const noexcept {
     auto it = orders_.find(id);
-    return (it != orders_.end()) ? it->second.get() : nullptr;
+    if (it != orders_.end()) {
+        return it->second.get();
+    }
+    auto stop = stop_orders_.find(id);
+    return (stop != stop_orders_.end()) ? &stop->second : nullptr;
 }
 
 double OrderBook::getMicroPrice(int levels) const noexcept {
@@ -327,8 +770,8 @@ double OrderBook::getOrderImbalance(int levels) const noexcept {
     }
     
     // Imbalance: (bid - ask) / (bid + ask)
-    return static_cast<double>(bid_volume - ask_volume) / 
-           static_cast<double>(bid_volume + ask_volume);
+    return (static_cast<double>(bid_volume) - static_cast<double>(ask_volume)) / 
+           (static_cast<double>(bid_volume) + static_cast<double>(ask_volume));
 }
 
 Quantity OrderBook::getQueuePosition(OrderId id) const noexcept {
@@ -357,20 +800,20 @@ Quantity OrderBook::getQueuePosition(OrderId id) const noexcept {
 BookStats OrderBook::getStats() const noexcept {
     BookStats stats;
     
+    // Totals come from the incrementally maintained aggregates; only the
+    // touch-derived fields look at the top levels.
     if (!bid_levels_.empty()) {
         stats.best_bid = bid_levels_.begin()->first;
         stats.bid_levels = bid_levels_.size();
-        for (const auto& [price, level] : bid_levels_) {
-            stats.bid_volume += level->total_quantity;
-        }
+        stats.bid_volume = static_cast<Quantity>(depth_[static_cast<size_t>(Side::BID)].total());
+        stats.bid_orders = side_orders_[static_cast<size_t>(Side::BID)];
     }
     
     if (!ask_levels_.empty()) {
         stats.best_ask = ask_levels_.begin()->first;
         stats.ask_levels = ask_levels_.size();
-        for (const auto& [price, level] : ask_levels_) {
-            stats.ask_volume += level->total_quantity;
-        }
+        stats.ask_volume = static_cast<Quantity>(depth_[static_cast<size_t>(Side::ASK)].total());
+        stats.ask_orders = side_orders_[static_cast<size_t>(Side::ASK)];
     }
     
     stats.spread = getSpread();
@@ -382,46 +825,245 @@ BookStats OrderBook::getStats() const noexcept {
     return stats;
 }
 
+uint64_t OrderBook::depthWithin(Side side, Price ticks) const noexcept {
+    const auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    if (levels.empty() || ticks < 0) {
+        return 0;
+    }
+    const Price touch = levels.begin()->first;
+    return depthAtOrBetter(side, side == Side::BID ? touch - ticks : touch + ticks);
+}
+
+uint64_t OrderBook::depthAtOrBetter(Side side, Price price) const noexcept {
+    const DepthIndex& depth = depth_[static_cast<size_t>(side)];
+    if (depth.exact()) {
+        return depth.depthThrough(price);
+    }
+    const auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    uint64_t total = 0;
+    for (auto it = levels.begin(); it != levels.end() && !levels.key_comp()(price, it->first); ++it) {
+        total += it->second->total_quantity;
+    }
+    return total;
+}
+
+Price OrderBook::priceToFill(Side side, uint64_t quantity) const noexcept {
+    const DepthIndex& depth = depth_[static_cast<size_t>(side)];
+    Price price = 0;
+    if (depth.exact()) {
+        return depth.priceFor(quantity, price) ? price : 0;
+    }
+    const auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    uint64_t total = 0;
+    for (const auto& [level_price, level] : levels) {
+        total += level->total_quantity;
+        if (quantity != 0 && total >= quantity) {
+            return level_price;
+        }
+    }
+    return 0;
+}
+
+MarketImpact OrderBook::estimateMarketImpact(Side side, Quantity quantity) const noexcept {
+    const Side resting = (side == Side::BID) ? Side::ASK : Side::BID;
+    const DepthIndex& depth = depth_[static_cast<size_t>(resting)];
+    const auto& levels = (resting == Side::BID) ? bid_levels_ : ask_levels_;
+    MarketImpact impact;
+    if (quantity == 0 || levels.empty()) {
+        return impact;
+    }
+    if (depth.exact()) {
+        Price worst = 0;
+        if (!depth.priceFor(quantity, worst)) {
+            worst = std::prev(levels.end())->first;  // the whole side
+        }
+        // Everything strictly better than the worst level, then part of it.
+        const Price inside = (resting == Side::BID) ? worst + 1 : worst - 1;
+        const uint64_t before = depth.depthThrough(inside);
+        const uint64_t at_worst = std::min<uint64_t>(depth.depthThrough(worst) - before, quantity - before);
+        impact.filled = static_cast<Quantity>(before + at_worst);
+        impact.worst_price = worst;
+        impact.notional = depth.notionalThrough(inside) + static_cast<int64_t>(at_worst) * worst;
+    } else {
+        for (const auto& [price, level] : levels) {
+            const Quantity take = std::min(quantity - impact.filled, level->total_quantity);
+            impact.filled += take;
+            impact.worst_price = price;
+            impact.notional += static_cast<int64_t>(take) * price;
+            if (impact.filled == quantity) break;
+        }
+    }
+    if (impact.filled != 0) {
+        impact.vwap = static_cast<double>(impact.notional) / impact.filled;
+    }
+    return impact;
+}
+
+LevelOrders OrderBook::levelOrders(Price price, Side side) const noexcept {
+    const auto& level_map = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    auto it = level_map.find(price);
+    return LevelOrders{it != level_map.end() ? it->second.get() : nullptr};
+}
+
+size_t OrderBook::fillAggregated(Side side, LevelInfo* out, size_t max_levels) const noexcept {
+    size_t n = 0;
+    for (const PriceLevel& level : levels(side)) {
+        if (n == max_levels) break;
+        out[n++] = LevelInfo{level.price, level.total_quantity, level.order_count};
+    }
+    return n;
+}
+
 std::vector<std::pair<Price, Quantity>> 
 OrderBook::getAggregatedBook(Side side, int levels) const noexcept {
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_QUERY);
     std::vector<std::pair<Price, Quantity>> result;
-    result.reserve(levels);
-    
-    const auto& level_map = (side == Side::BID) ? bid_levels_ : ask_levels_;
+    const Levels view = this->levels(side);
+    result.reserve(std::min(static_cast<size_t>(std::max(levels, 0)), view.size()));
     
     int count = 0;
-    for (const auto& [price, level] : level_map) {
+    for (const PriceLevel& level : view) {
         if (++count > levels) break;
-        result.emplace_back(price, level->total_quantity);
+        result.emplace_back(level.price, level.total_quantity);
     }
     
     return result;
 }
 
 std::vector<Order> OrderBook::getOrdersAtLevel(Price price, Side side) const noexcept {
-    std::vector<Order> result;
-    
-    const auto& level_map = (side == Side::BID) ? bid_levels_ : ask_levels_;
-    auto it = level_map.find(price);
-    
-    if (it != level_map.end()) {
-        const Order* current = it->second->front();
-        while (current) {
-            result.push_back(*current);
-            current = current->next;
-        }
-    }
-    
-    return result;
+    AllocScopeGuard alloc_scope(AllocScope::BOOK_QUERY);
+    const LevelOrders orders = levelOrders(price, side);
+    return std::vector<Order>(orders.begin(), orders.end());
 }
 
 void OrderBook::clear() noexcept {
+    participant_orders_.clear();
     orders_.clear();
     bid_levels_.clear();
     ask_levels_.clear();
+    decltype(spare_orders_)().swap(spare_orders_);
+    decltype(spare_levels_)().swap(spare_levels_);
+    peak_orders_ = peak_levels_ = 0;
+    resetState();
+}
+
+void OrderBook::reset() noexcept {
+    last_session_ = BookSizing{peak_orders_, peak_levels_};
+    spare_orders_.reserve(spare_orders_.size() + orders_.size());
+    while (!orders_.empty()) {
+        recycleOrder(orders_.begin());
+    }
+    spare_levels_.reserve(spare_levels_.size() + bid_levels_.size() + ask_levels_.size());
+    for (LevelMap* levels : {&bid_levels_, &ask_levels_}) {
+        while (!levels->empty()) {
+            recycleLevel(*levels, levels->begin());
+        }
+    }
+    // Participants keep their (now empty) list heads.
+    for (auto& [participant, head] : participant_orders_) head = nullptr;
+    peak_orders_ = peak_levels_ = 0;
+    resetState();
+}
+
+void OrderBook::reserve(const BookSizing& sizing) noexcept {
+    orders_.reserve(sizing.orders);
+    spare_orders_.reserve(sizing.orders);
+    OrderMap order_nodes;
+    for (size_t n = orders_.size() + spare_orders_.size(); n < sizing.orders; ++n) {
+        spare_orders_.push_back(order_nodes.extract(order_nodes.emplace(0, std::make_unique<Order>()).first));
+    }
+    spare_levels_.reserve(sizing.levels);
+    LevelMap level_nodes;
+    for (size_t n = bid_levels_.size() + ask_levels_.size() + spare_levels_.size(); n < sizing.levels; ++n) {
+        spare_levels_.push_back(
+            level_nodes.extract(level_nodes.emplace(0, std::make_unique<PriceLevel>(0, Side::BID)).first));
+    }
+}
+
+void OrderBook::resetState() noexcept {
+    expiry_.clear();
+    clock_ = 0;
+    for (auto& depth : depth_) depth.clear();
+    side_orders_[0] = side_orders_[1] = 0;
+    stop_orders_.clear();
+    for (auto& ladder : stop_ladder_) ladder.clear();
+    stop_seq_ = 0;
+    last_trade_price_ = 0;
+    state_hash_ = 0;
+    enqueue_seq_ = 0;
     invalidateCache();
 }
 
+uint64_t OrderBook::recomputeStateHash() const noexcept {
+    uint64_t h = 0;
+    for (const auto& [id, order] : orders_) h ^= hashOrder(*order);
+    return h;
+}
+
+void OrderBook::enqueue(PriceLevel* level, Order* order) noexcept {
+    order->sequence = ++enqueue_seq_;
+    level->addOrder(order);
+    addDepth(order->side, order->price, order->remaining_quantity);
+    ++side_orders_[static_cast<size_t>(order->side)];
+    state_hash_ ^= hashOrder(*order);
+}
+
+void OrderBook::dequeue(PriceLevel* level, Order* order) noexcept {
+    addDepth(order->side, order->price, -static_cast<int64_t>(order->remaining_quantity));
+    --side_orders_[static_cast<size_t>(order->side)];
+    level->removeOrder(order);
+}
+
+void OrderBook::index(Order* order) noexcept {
+    linkParticipant(order);
+    order->timer_slot = TimerWheel::kUnscheduled;
+    if (order->tif == TimeInForce::GTD && order->expire_time != 0) {
+        expiry_.schedule(order);
+    }
+}
+
+void OrderBook::unindex(Order* order) noexcept {
+    unlinkParticipant(order);
+    expiry_.cancel(order);
+}
+
+void OrderBook::linkParticipant(Order* order) noexcept {
+    order->participant_prev = nullptr;
+    order->participant_next = nullptr;
+    if (order->participant_id == 0) {
+        return;
+    }
+    Order*& head = participant_orders_[order->participant_id];
+    order->participant_next = head;
+    if (head) head->participant_prev = order;
+    head = order;
+}
+
+void OrderBook::unlinkParticipant(Order* order) noexcept {
+    if (order->participant_id == 0) {
+        return;
+    }
+    if (order->participant_prev) {
+        order->participant_prev->participant_next = order->participant_next;
+    } else {
+        // Emptied lists keep their entry so the participant's next order
+        // does not allocate.
+        participant_orders_.find(order->participant_id)->second = order->participant_next;
+    }
+    if (order->participant_next) {
+        order->participant_next->participant_prev = order->participant_prev;
+    }
+    order->participant_next = nullptr;
+    order->participant_prev = nullptr;
+}
+
+uint64_t OrderBook::hashOrder(const Order& o) noexcept {
+    uint64_t h = mix64(o.id);
+    h = mix64(h ^ static_cast<uint64_t>(o.price));
+    h = mix64(h ^ ((static_cast<uint64_t>(o.remaining_quantity) << 1) | static_cast<uint64_t>(o.side)));
+    return mix64(h ^ o.sequence);
+}
+
 void OrderBook::updateCache() const noexcept {
     cached_best_bid_ = bid_levels_.empty() ? 0 : bid_levels_.begin()->first;
     cached_best_ask_ = ask_levels_.empty() ? 0 : ask_levels_.begin()->first;
@@ -436,16 +1078,71 @@ PriceLevel* OrderBook::getOrCreateLevel(Price price, Side side) noexcept {
         return it->second.get();
     }
     
-    auto level = std::make_unique<PriceLevel>(price, side);
-    PriceLevel* ptr = level.get();
-    levels[price] = std::move(level);
+    PriceLevel* ptr;
+    if (!spare_levels_.empty()) {
+        auto node = std::move(spare_levels_.back());
+        spare_levels_.pop_back();
+        node.key() = price;
+        *node.mapped() = PriceLevel(price, side);
+        ptr = node.mapped().get();
+        levels.insert(std::move(node));
+    } else {
+        auto level = std::make_unique<PriceLevel>(price, side);
+        ptr = level.get();
+        levels.emplace(price, std::move(level));
+    }
+    peak_levels_ = std::max(peak_levels_, bid_levels_.size() + ask_levels_.size());
     
     return ptr;
 }
 
+PriceLevel* OrderBook::moveLevel(PriceLevel* from, Price price) noexcept {
+    if (!from->empty()) {
+        return getOrCreateLevel(price, from->side);
+    }
+    auto& levels = (from->side == Side::BID) ? bid_levels_ : ask_levels_;
+    auto it = levels.find(price);
+    if (it != levels.end()) {
+        recycleLevel(levels, levels.find(from->price));
+        return it->second.get();
+    }
+    // The emptied level becomes the new one: no free, no allocation.
+    auto node = levels.extract(from->price);
+    node.key() = price;
+    from->price = price;
+    levels.insert(std::move(node));
+    return from;
+}
+
 void OrderBook::removeEmptyLevel(Price price, Side side) noexcept {
     auto& levels = (side == Side::BID) ? bid_levels_ : ask_levels_;
-    levels.erase(price);
+    recycleLevel(levels, levels.find(price));
+}
+
+void OrderBook::recycleLevel(LevelMap& levels, LevelMap::iterator it) noexcept {
+    spare_levels_.push_back(levels.extract(it));
+}
+
+Order* OrderBook::storeOrder(Order&& order) noexcept {
+    Order* stored;
+    if (!spare_orders_.empty()) {
+        auto node = std::move(spare_orders_.back());
+        spare_orders_.pop_back();
+        node.key() = order.id;
+        *node.mapped() = std::move(order);
+        stored = node.mapped().get();
+        orders_.insert(std::move(node));
+    } else {
+        auto order_ptr = std::make_unique<Order>(std::move(order));
+        stored = order_ptr.get();
+        orders_.emplace(stored->id, std::move(order_ptr));
+    }
+    peak_orders_ = std::max(peak_orders_, orders_.size());
+    return stored;
+}
+
+void OrderBook::recycleOrder(OrderMap::iterator it) noexcept {
+    spare_orders_.push_back(orders_.extract(it));
 }
 
 } // namespace lob
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "lob/perf_counters.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace lob {
+
+#if defined(__linux__)
+
+namespace {
+
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr EventSpec kEventSpecs[kHwEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int openEvent(const EventSpec& spec, int group_fd) noexcept {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = group_fd < 0;  // the leader starts the whole group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */,
+                                    group_fd, 0UL));
+}
+
+} // namespace
+
+HwCounterGroup::HwCounterGroup() {
+    fds_.fill(-1);
+    for (size_t i = 0; i < kHwEventCount; ++i) {
+        const int fd = openEvent(kEventSpecs[i], leader_);
+        if (fd < 0) {
+            // Unsupported events stay at zero; the next one may still lead.
+            if (leader_ < 0 && error_.empty()) error_ = std::strerror(errno);
+            continue;
+        }
+        if (leader_ < 0) leader_ = fd;
+        fds_[i] = fd;
+        slot_[i] = opened_++;
+    }
+    if (leader_ < 0) {
+        if (error_.empty()) error_ = "no hardware events available";
+        return;
+    }
+    error_.clear();
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+HwCounterGroup::~HwCounterGroup() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+HwCounterValues HwCounterGroup::read() const noexcept {
+    HwCounterValues v;
+    if (leader_ < 0) return v;
+    // PERF_FORMAT_GROUP layout: { u64 nr; u64 values[nr]; }
+    uint64_t buf[1 + kHwEventCount] = {};
+    const ssize_t want = static_cast<ssize_t>(sizeof(uint64_t) * (1 + opened_));
+    if (::read(leader_, buf, sizeof(buf)) < want) return v;
+    for (size_t i = 0; i < kHwEventCount; ++i) {
+        if (fds_[i] >= 0) v.events[i] = buf[1 + slot_[i]];
+    }
+    v.samples = 1;
+    return v;
+}
+
+#else
+
+HwCounterGroup::HwCounterGroup() : error_("hardware counters require Linux perf_event_open") {
+    fds_.fill(-1);
+}
+
+HwCounterGroup::~HwCounterGroup() = default;
+
+HwCounterValues HwCounterGroup::read() const noexcept { return {}; }
+
+#endif
+
+} // namespace lob
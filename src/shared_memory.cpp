@@ -0,0 +1,84 @@
+#include "lob/shared_memory.hpp"
+
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob {
+
+SharedMemoryRegion::~SharedMemoryRegion() { close(); }
+
+SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion&& other) noexcept { *this = std::move(other); }
+
+SharedMemoryRegion& SharedMemoryRegion::operator=(SharedMemoryRegion&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        name_ = std::move(other.name_);
+        owner_ = std::exchange(other.owner_, false);
+    }
+    return *this;
+}
+
+bool SharedMemoryRegion::create(const std::string& name, size_t size) {
+    close();
+    ::shm_unlink(name.c_str());  // stale object from a crashed run
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return false;
+    void* p = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    data_ = p;
+    size_ = size;
+    name_ = name;
+    owner_ = true;
+    return true;
+}
+
+bool SharedMemoryRegion::open(const std::string& name, bool writable) {
+    close();
+    const int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st {};
+    void* p = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        p = ::mmap(nullptr, static_cast<size_t>(st.st_size), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = p;
+    size_ = static_cast<size_t>(st.st_size);
+    name_ = name;
+    return true;
+}
+
+bool SharedMemoryRegion::allocate(size_t size) {
+    close();
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return false;
+    data_ = p;
+    size_ = size;
+    return true;
+}
+
+void SharedMemoryRegion::close() noexcept {
+    if (data_ != nullptr) ::munmap(data_, size_);
+    if (owner_) ::shm_unlink(name_.c_str());
+    data_ = nullptr;
+    size_ = 0;
+    name_.clear();
+    owner_ = false;
+}
+
+} // namespace lob
@@ -0,0 +1,289 @@
+#include "lob/shm_feed.hpp"
+
+#include "lob/concurrent_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace lob {
+
+namespace shm_feed {
+
+constexpr uint64_t kMagic = 0x4c4f424645454431ull;  // "LOBFEED1"
+constexpr size_t kMaxSymbols = 256;
+constexpr size_t kSymbolBytes = 32;  // NUL-terminated
+constexpr size_t kWords = sizeof(FeedRecord) / sizeof(uint64_t);
+
+struct Header {
+    uint64_t magic;
+    uint64_t capacity;
+    uint64_t record_size;
+    alignas(64) std::atomic<uint64_t> write_seq;  // records published
+    std::atomic<uint32_t> closed;
+    std::atomic<uint32_t> symbol_count;
+    char symbols[kMaxSymbols][kSymbolBytes];
+};
+
+// Seqlock slot.  `seq` is 2(n+1) once record n is complete and odd while
+// it is being written, so a reader can tell "not yet", "ready" and
+// "overwritten" apart.  The payload is copied through relaxed atomic
+// words so a concurrent overwrite is a detected retry, not a data race.
+struct alignas(64) Slot {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> words[kWords];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "feed counters must be address-free");
+
+size_t bytesFor(uint64_t capacity) noexcept { return sizeof(Header) + capacity * sizeof(Slot); }
+
+} // namespace shm_feed
+
+using shm_feed::Header;
+using shm_feed::Slot;
+
+// -------- FeedRecord ----------
+
+bool FeedRecord::fromEvent(const Event& e, uint32_t symbol, FeedRecord& out) noexcept {
+    out = FeedRecord{};
+    out.timestamp = e.timestamp;
+    out.symbol = symbol;
+    out.event_type = e.type;
+    switch (e.type) {
+        case Event::MARKET_DATA:
+            if (e.market_update) {
+                const MarketDataUpdate& u = *e.market_update;
+                out.update_type = u.type;
+                out.side = u.side;
+                out.price = u.price;
+                out.quantity = u.quantity;
+                out.order_id = u.order_id;
+            } else {
+                out.update_type = MarketDataUpdate::SNAPSHOT;  // placeholder row without payload
+                out.reserved = 1;
+            }
+            return true;
+        case Event::FILL:
+            if (!e.execution) return false;
+            out.order_id = e.execution->bid_id;
+            out.aux_id = e.execution->ask_id;
+            out.price = e.execution->price;
+            out.quantity = e.execution->quantity;
+            return true;
+        case Event::END_OF_DAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Event FeedRecord::toEvent(const std::string& symbol_name) const {
+    Event e{};
+    e.type = event_type;
+    e.timestamp = timestamp;
+    e.symbol = symbol_name;
+    if (event_type == Event::MARKET_DATA && reserved == 0) {
+        MarketDataUpdate u{};
+        u.type = update_type;
+        u.side = side;
+        u.price = price;
+        u.quantity = quantity;
+        u.order_id = order_id;
+        u.timestamp = timestamp;
+        e.market_update = u;
+    } else if (event_type == Event::FILL) {
+        e.execution = Execution{order_id, aux_id, price, quantity, timestamp};
+    }
+    return e;
+}
+
+// -------- ShmFeedPublisher ----------
+
+ShmFeedPublisher::~ShmFeedPublisher() { close(); }
+
+bool ShmFeedPublisher::create(const std::string& name, size_t capacity) {
+    const uint64_t cap = detail::queueCapacity(capacity);
+    if (!region_.create(name, shm_feed::bytesFor(cap))) return false;
+    header_ = new (region_.data()) Header{};
+    slots_ = reinterpret_cast<Slot*>(header_ + 1);
+    for (uint64_t i = 0; i < cap; ++i) new (&slots_[i]) Slot{};
+    header_->capacity = cap;
+    header_->record_size = sizeof(FeedRecord);
+    mask_ = cap - 1;
+    next_ = 0;
+    symbols_.clear();
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = shm_feed::kMagic;
+    return true;
+}
+
+uint32_t ShmFeedPublisher::symbolIndex(const std::string& symbol) {
+    auto it = symbols_.find(symbol);
+    if (it != symbols_.end()) return it->second;
+    const uint32_t index = header_->symbol_count.load(std::memory_order_relaxed);
+    if (index >= shm_feed::kMaxSymbols || symbol.size() >= shm_feed::kSymbolBytes) return ~0u;
+    std::memcpy(header_->symbols[index], symbol.c_str(), symbol.size() + 1);
+    header_->symbol_count.store(index + 1, std::memory_order_release);
+    symbols_.emplace(symbol, index);
+    return index;
+}
+
+bool ShmFeedPublisher::publish(const Event& event) {
+    if (header_ == nullptr) return false;
+    const uint32_t symbol = symbolIndex(event.symbol);
+    FeedRecord r;
+    return symbol != ~0u && FeedRecord::fromEvent(event, symbol, r) && publish(r);
+}
+
+bool ShmFeedPublisher::publish(const FeedRecord& record) noexcept {
+    if (header_ == nullptr) return false;
+    Slot& slot = slots_[next_ & mask_];
+    uint64_t words[shm_feed::kWords];
+    std::memcpy(words, &record, sizeof(words));
+    slot.seq.store(2 * (next_ + 1) - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < shm_feed::kWords; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+    slot.seq.store(2 * (next_ + 1), std::memory_order_release);
+    header_->write_seq.store(++next_, std::memory_order_release);
+    return true;
+}
+
+uint64_t ShmFeedPublisher::pump(DataSource& source) {
+    uint64_t n = 0;
+    while (source.hasNext()) {
+        if (publish(source.getNext())) ++n;
+    }
+    return n;
+}
+
+void ShmFeedPublisher::close() noexcept {
+    if (header_ != nullptr) header_->closed.store(1, std::memory_order_release);
+}
+
+// -------- ShmFeedReader ----------
+
+bool ShmFeedReader::open(const std::string& name, bool from_oldest) {
+    header_ = nullptr;
+    symbol_names_.clear();
+    // Read-only: the reader's cursor lives in this process.
+    if (!region_.open(name, false) || region_.size() < sizeof(Header)) return false;
+    const auto* h = static_cast<const Header*>(region_.data());
+    if (h->magic != shm_feed::kMagic || h->record_size != sizeof(FeedRecord) ||
+        region_.size() < shm_feed::bytesFor(h->capacity)) {
+        region_.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    header_ = h;
+    slots_ = reinterpret_cast<const Slot*>(h + 1);
+    mask_ = h->capacity - 1;
+    lost_ = overruns_ = 0;
+    rewind(from_oldest);
+    return true;
+}
+
+void ShmFeedReader::rewind(bool from_oldest) noexcept {
+    if (header_ == nullptr) return;
+    const uint64_t written = header_->write_seq.load(std::memory_order_acquire);
+    // Leave one slot of slack: the oldest slot may be mid-overwrite.
+    const uint64_t retained = header_->capacity - 1;
+    cursor_ = !from_oldest ? written : (written > retained ? written - retained : 0);
+}
+
+ShmFeedReader::Status ShmFeedReader::poll(FeedRecord& out) noexcept {
+    if (header_ == nullptr) return Status::END;
+    const Slot& slot = slots_[cursor_ & mask_];
+    const uint64_t expected = 2 * (cursor_ + 1);
+    const uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+    if (s1 == expected) {
+        uint64_t words[shm_feed::kWords];
+        for (size_t i = 0; i < shm_feed::kWords; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == s1) {
+            std::memcpy(&out, words, sizeof(out));
+            ++cursor_;
+            return Status::OK;
+        }
+    } else if (s1 < expected - 1) {
+        // Slot still holds an older lap: nothing new yet, unless closed.
+        if (header_->closed.load(std::memory_order_acquire) != 0 &&
+            cursor_ >= header_->write_seq.load(std::memory_order_acquire)) {
+            return Status::END;
+        }
+        return Status::EMPTY;
+    } else if (s1 == expected - 1) {
+        return Status::EMPTY;  // being written right now
+    }
+    // Lapped by the writer (or overwritten while copying).
+    const uint64_t before = cursor_;
+    rewind(true);
+    lost_ += cursor_ - before;
+    ++overruns_;
+    return Status::OVERRUN;
+}
+
+const std::string& ShmFeedReader::symbolName(uint32_t index) {
+    if (index >= symbol_names_.size() && header_ != nullptr) {
+        const uint32_t count = header_->symbol_count.load(std::memory_order_acquire);
+        for (auto i = static_cast<uint32_t>(symbol_names_.size()); i < count; ++i) {
+            symbol_names_.emplace_back(header_->symbols[i]);
+        }
+    }
+    return index < symbol_names_.size() ? symbol_names_[index] : unknown_;
+}
+
+// -------- ShmFeedSource ----------
+
+ShmFeedSource::ShmFeedSource(const std::string& name, bool from_oldest, uint64_t idle_timeout_ms)
+    : name_(name), from_oldest_(from_oldest), idle_timeout_ms_(idle_timeout_ms) {
+    attached_ = reader_.open(name_, from_oldest_);
+}
+
+bool ShmFeedSource::hasNext() const {
+    if (has_pending_) return true;
+    if (!attached_ || ended_) return false;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t spins = 0;; ++spins) {
+        switch (reader_.poll(pending_)) {
+            case ShmFeedReader::Status::OK:
+                has_pending_ = true;
+                return true;
+            case ShmFeedReader::Status::END:
+                ended_ = true;
+                return false;
+            case ShmFeedReader::Status::OVERRUN:
+                continue;
+            case ShmFeedReader::Status::EMPTY:
+                break;
+        }
+        if (spins < 64) continue;
+        std::this_thread::yield();
+        if (idle_timeout_ms_ != 0 && (spins & 1023) == 0 &&
+            std::chrono::steady_clock::now() - start > std::chrono::milliseconds(idle_timeout_ms_)) {
+            return false;
+        }
+    }
+}
+
+Event ShmFeedSource::getNext() {
+    if (!hasNext()) return Event{};
+    has_pending_ = false;
+    return pending_.toEvent(reader_.symbolName(pending_.symbol));
+}
+
+void ShmFeedSource::reset() {
+    has_pending_ = false;
+    ended_ = false;
+    if (!attached_) {
+        attached_ = reader_.open(name_, from_oldest_);
+    } else {
+        reader_.rewind(from_oldest_);
+    }
+}
+
+} // namespace lob
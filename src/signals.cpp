@@ -16,30 +16,31 @@ double OrderImbalanceSignal::getVolumeImbalance(const OrderBook& book) const {
 }
 double OrderImbalanceSignal::getOrderCountImbalance(const OrderBook& book) const {
     // approximate by treating each level's order_count equal weight via aggregated book
-    auto bids = book.getAggregatedBook(Side::BID, levels_);
-    auto asks = book.getAggregatedBook(Side::ASK, levels_);
-    double bcnt = static_cast<double>(bids.size());
-    double acnt = static_cast<double>(asks.size());
+    const auto depth = static_cast<size_t>(std::max(levels_, 0));
+    const auto bcnt = std::min(book.levels(Side::BID).size(), depth);
+    const auto acnt = std::min(book.levels(Side::ASK).size(), depth);
     return calculateImbalance(static_cast<Quantity>(bcnt), static_cast<Quantity>(acnt));
 }
 double OrderImbalanceSignal::getWeightedImbalance(const OrderBook& book) const {
     // volume imbalance weighted by inverse distance from touch
-    auto bids = book.getAggregatedBook(Side::BID, levels_);
-    auto asks = book.getAggregatedBook(Side::ASK, levels_);
+    const auto bids = book.levels(Side::BID);
+    const auto asks = book.levels(Side::ASK);
     if (bids.empty() || asks.empty()) return 0.0;
-    const auto best_bid = bids.front().first;
-    const auto best_ask = asks.front().first;
+    const auto best_bid = bids.begin()->price;
+    const auto best_ask = asks.begin()->price;
 
     double bw = 0.0, aw = 0.0;
-    for (std::size_t i=0;i<bids.size();++i) {
-        auto [p, q] = bids[i];
-        const double w = 1.0 / (1.0 + static_cast<double>(best_bid - p));
-        bw += w * static_cast<double>(q);
+    int n = 0;
+    for (const PriceLevel& level : bids) {
+        if (++n > levels_) break;
+        const double w = 1.0 / (1.0 + static_cast<double>(best_bid - level.price));
+        bw += w * static_cast<double>(level.total_quantity);
     }
-    for (std::size_t i=0;i<asks.size();++i) {
-        auto [p, q] = asks[i];
-        const double w = 1.0 / (1.0 + static_cast<double>(p - best_ask));
-        aw += w * static_cast<double>(q);
+    n = 0;
+    for (const PriceLevel& level : asks) {
+        if (++n > levels_) break;
+        const double w = 1.0 / (1.0 + static_cast<double>(level.price - best_ask));
+        aw += w * static_cast<double>(level.total_quantity);
     }
     return calculateImbalance(static_cast<Quantity>(bw), static_cast<Quantity>(aw));
 }
@@ -82,20 +83,20 @@ double BookPressureSignal::calculateAggression(const Order& ord, const OrderBook
     const auto best_bid = book.getBestBid();
     const auto best_ask = book.getBestAsk();
     const auto spread = (best_bid==0 || best_ask==0) ? 1 : (best_ask - best_bid);
-    if (ord.isBuy()) return static_cast<double>(ord.price - best_bid) / std::max(1, spread);
-    return static_cast<double>(best_ask - ord.price) / std::max(1, spread);
+    if (ord.isBuy()) return static_cast<double>(ord.price - best_bid) / std::max<Price>(1, spread);
+    return static_cast<double>(best_ask - ord.price) / std::max<Price>(1, spread);
 }
 void BookPressureSignal::update(const OrderBook& book) {
     // Take front orders on both sides as recent "aggressive quoting" proxies
-    auto bids = book.getAggregatedBook(Side::BID, 1);
-    auto asks = book.getAggregatedBook(Side::ASK, 1);
+    const auto bids = book.levels(Side::BID);
+    const auto asks = book.levels(Side::ASK);
     if (!bids.empty()) {
         // fabricate an order shell
-        Order tmp{}; tmp.side = Side::BID; tmp.price = bids.front().first; tmp.timestamp = 0;
+        Order tmp{}; tmp.side = Side::BID; tmp.price = bids.begin()->price; tmp.timestamp = 0;
         recent_events_.push_back({0, Side::BID, calculateAggression(tmp, book)});
     }
     if (!asks.empty()) {
-        Order tmp{}; tmp.side = Side::ASK; tmp.price = asks.front().first; tmp.timestamp = 0;
+        Order tmp{}; tmp.side = Side::ASK; tmp.price = asks.begin()->price; tmp.timestamp = 0;
         recent_events_.push_back({0, Side::ASK, calculateAggression(tmp, book)});
     }
     while (static_cast<int>(recent_events_.size()) > lookback_events_) recent_events_.pop_front();
@@ -257,10 +258,10 @@ FeatureExtractor::Features FeatureExtractor::extractFeatures(const OrderBook& bo
     f.spread_pct = (stats.mid_price>0.0)? stats.spread/std::max(1e-6, stats.mid_price):0.0;
     f.bid_volume = stats.bid_volume; f.ask_volume = stats.ask_volume;
     f.volume_imbalance = stats.imbalance;
-    auto b1 = book.getAggregatedBook(Side::BID,1); auto a1 = book.getAggregatedBook(Side::ASK,1);
-    f.bid_depth_1 = b1.empty()?0.0:b1[0].second; f.ask_depth_1 = a1.empty()?0.0:a1[0].second;
-    auto b5 = book.getAggregatedBook(Side::BID,5); auto a5 = book.getAggregatedBook(Side::ASK,5);
-    double s5b=0,s5a=0; for(auto& p:b5)s5b+=p.second; for(auto& p:a5)s5a+=p.second; f.bid_depth_5 = s5b; f.ask_depth_5 = s5a;
+    LevelInfo b5[5], a5[5];
+    const size_t nb = book.fillAggregated(Side::BID, b5); const size_t na = book.fillAggregated(Side::ASK, a5);
+    f.bid_depth_1 = nb==0?0.0:b5[0].quantity; f.ask_depth_1 = na==0?0.0:a5[0].quantity;
+    double s5b=0,s5a=0; for(size_t i=0;i<nb;++i)s5b+=b5[i].quantity; for(size_t i=0;i<na;++i)s5a+=a5[i].quantity; f.bid_depth_5 = s5b; f.ask_depth_5 = s5a;
     f.microprice = book.getMicroPrice(1);
     f.book_pressure = stats.imbalance; // proxy
     f.queue_imbalance = stats.imbalance;
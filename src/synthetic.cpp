@@ -0,0 +1,551 @@
+#include "lob/synthetic.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+
+namespace lob {
+
+namespace {
+
+// xoshiro256** seeded through splitmix64.  The standard <random>
+// distributions are implementation-defined, so fixed algorithms are
+// used to keep streams identical across compilers and platforms.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) noexcept {
+        for (auto& word : s_) word = splitmix(seed);
+    }
+
+    uint64_t next() noexcept {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    double uniform() noexcept { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    double exponential(double rate) noexcept { return -std::log1p(-uniform()) / rate; }
+    uint64_t below(uint64_t n) noexcept { return next() % n; }
+
+private:
+    uint64_t s_[4];
+
+    static uint64_t rotl(uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+    static uint64_t splitmix(uint64_t& x) noexcept {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+constexpr double kNanosPerSecond = 1e9;
+
+} // namespace
+
+// -------- Presets ----------
+
+SyntheticMarketConfig SyntheticMarketConfig::liquidEquity() {
+    SyntheticMarketConfig c;
+    c.name = "liquid_equity";
+    c.event_rate = 2000.0;
+    c.mix = {0.45, 0.42, 0.08, 0.05};
+    c.target_orders = 1500;
+    c.hawkes_jump = 0.1;  // branching ratio 100/s * 0.1 / 20 = 0.5
+    c.hawkes_decay = 20.0;
+    c.initial_mid = 15000;
+    c.depth = 20;
+    c.touch_decay = 0.7;
+    c.target_queue = 3000;
+    c.min_qty = 100;
+    c.max_qty = 1000;
+    c.market_qty_mean = 300.0;
+    c.initial_orders_per_level = 8;
+    return c;
+}
+
+SyntheticMarketConfig SyntheticMarketConfig::smallCap() {
+    SyntheticMarketConfig c;
+    c.name = "small_cap";
+    c.event_rate = 50.0;
+    c.mix = {0.42, 0.30, 0.06, 0.22};
+    c.target_orders = 150;
+    c.hawkes_jump = 0.27;  // branching ratio 11/s * 0.27 / 5 = 0.6
+    c.hawkes_decay = 5.0;
+    c.initial_mid = 512;
+    c.depth = 60;
+    c.touch_decay = 0.92;
+    c.inside_prob = 0.3;
+    c.target_queue = 1000;
+    c.min_qty = 100;
+    c.max_qty = 500;
+    c.market_qty_mean = 200.0;
+    c.initial_orders_per_level = 1;
+    return c;
+}
+
+SyntheticMarketConfig SyntheticMarketConfig::crypto() {
+    SyntheticMarketConfig c;
+    c.name = "crypto";
+    c.event_rate = 5000.0;
+    c.mix = {0.48, 0.47, 0.03, 0.02};
+    c.target_orders = 3000;
+    c.hawkes_jump = 0.35;  // branching ratio 100/s * 0.35 / 50 = 0.7
+    c.hawkes_decay = 50.0;
+    c.initial_mid = 6500000;
+    c.depth = 250;
+    c.touch_decay = 0.98;
+    c.inside_prob = 0.05;
+    c.target_queue = 20000;
+    c.min_qty = 1;
+    c.max_qty = 5000;
+    c.market_qty_mean = 50.0;
+    c.initial_orders_per_level = 3;
+    return c;
+}
+
+bool SyntheticMarketConfig::preset(const std::string& name, SyntheticMarketConfig& out) {
+    for (auto& c : {liquidEquity(), smallCap(), crypto()}) {
+        if (c.name == name) {
+            out = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SyntheticMarketConfig::valid() const noexcept {
+    return depth > 0 && initial_orders_per_level >= 0 && min_qty > 0 && min_qty <= max_qty &&
+           initial_mid > depth && event_rate >= 0.0 && duration <= UINT64_MAX - start_time;
+}
+
+// -------- Per-symbol model ----------
+
+// Shadow book for one symbol.  It mirrors OrderBook's FIFO semantics
+// closely enough that cancels and modifies always reference resting
+// orders and market orders consume exactly the same queue positions.
+// Level queues are lazily compacted: cancelled or re-queued entries are
+// recognised by a stale version and skipped.
+struct SyntheticMarketGenerator::SymbolState {
+    struct Resting {
+        Price price;
+        Quantity qty;
+        Side side;
+        uint32_t version;
+        uint32_t live_index;
+    };
+    struct Entry {
+        OrderId id;
+        uint32_t version;
+    };
+    struct Level {
+        uint64_t qty = 0;
+        uint32_t count = 0;
+        size_t head = 0;
+        std::vector<Entry> fifo;
+    };
+    using Ladder = std::map<Price, Level, PriceCompare>;
+
+    const SyntheticMarketConfig& cfg;
+    Rng rng;
+    OrderId next_id;
+    Timestamp now;
+    double excitation = 0.0;
+    Timestamp excitation_time;
+    double base_rate;
+    uint64_t seed_remaining;
+
+    std::unordered_map<OrderId, Resting> orders;
+    std::vector<OrderId> live;
+    Ladder bids{PriceCompare{true}};
+    Ladder asks{PriceCompare{false}};
+
+    SymbolState(const SyntheticMarketConfig& c, uint32_t index)
+        : cfg(c), rng(c.seed ^ (0x9e3779b97f4a7c15ULL * (index + 1))),
+          next_id((static_cast<OrderId>(index) << 40) + 1), now(c.start_time), excitation_time(c.start_time) {
+        const double total = cfg.mix.add + cfg.mix.cancel + cfg.mix.modify + cfg.mix.market;
+        base_rate = total > 0.0 ? cfg.event_rate / total : 0.0;
+        seed_remaining = static_cast<uint64_t>(std::max(0, cfg.depth)) *
+                         static_cast<uint64_t>(std::max(0, cfg.initial_orders_per_level)) * 2;
+        orders.reserve(cfg.target_orders * 2);
+        live.reserve(cfg.target_orders * 2);
+    }
+
+    Ladder& ladder(Side s) { return s == Side::BID ? bids : asks; }
+
+    double excitationAt(Timestamp t) const {
+        if (excitation == 0.0) return 0.0;
+        const double dt = static_cast<double>(t - excitation_time) / kNanosPerSecond;
+        return excitation * std::exp(-cfg.hawkes_decay * dt);
+    }
+
+    // Per-type intensities at time t, in events per second.
+    void intensities(Timestamp t, double out[4]) const {
+        const double scale = base_rate * (1.0 + excitationAt(t));
+        const double fill = static_cast<double>(live.size()) / std::max(1U, cfg.target_orders);
+        out[0] = scale * cfg.mix.add;
+        out[1] = scale * cfg.mix.cancel * fill;
+        out[2] = scale * cfg.mix.modify * fill;
+        out[3] = scale * cfg.mix.market;
+    }
+
+    static double sum(const double r[4]) { return r[0] + r[1] + r[2] + r[3]; }
+
+    // Advances the clock to the next accepted event (Ogata thinning; the
+    // intensity is non-increasing between events so the current value is
+    // a valid upper bound).  Returns false if the process has died out.
+    bool advance() {
+        if (seed_remaining > 0) return true;
+        double r[4];
+        for (;;) {
+            intensities(now, r);
+            const double upper = sum(r);
+            if (upper <= 0.0) return false;
+            now += static_cast<Timestamp>(rng.exponential(upper) * kNanosPerSecond) + 1;
+            if (excitation == 0.0) return true;
+            intensities(now, r);
+            if (rng.uniform() * upper <= sum(r)) return true;
+        }
+    }
+
+    void enqueue(OrderId id, Resting& o) {
+        Level& level = ladder(o.side)[o.price];
+        level.fifo.push_back({id, o.version});
+        level.qty += o.qty;
+        ++level.count;
+    }
+
+    void dequeue(const Resting& o, Quantity qty, bool remove) {
+        auto& lad = ladder(o.side);
+        auto it = lad.find(o.price);
+        Level& level = it->second;
+        level.qty -= qty;
+        if (!remove) return;
+        if (--level.count == 0) {
+            lad.erase(it);
+        } else if (level.fifo.size() - level.head > 2 * static_cast<size_t>(level.count) + 32) {
+            compact(level);
+        }
+    }
+
+    void compact(Level& level) {
+        size_t out = 0;
+        for (size_t i = level.head; i < level.fifo.size(); ++i) {
+            auto it = orders.find(level.fifo[i].id);
+            if (it != orders.end() && it->second.version == level.fifo[i].version) {
+                level.fifo[out++] = level.fifo[i];
+            }
+        }
+        level.fifo.resize(out);
+        level.head = 0;
+    }
+
+    void forget(OrderId id, const Resting& o) {
+        const uint32_t idx = o.live_index;
+        live[idx] = live.back();
+        orders[live[idx]].live_index = idx;
+        live.pop_back();
+        orders.erase(id);
+    }
+
+    Quantity quantity() {
+        return cfg.min_qty + static_cast<Quantity>(rng.below(cfg.max_qty - cfg.min_qty + 1ULL));
+    }
+
+    Side side() { return rng.uniform() < 0.5 ? Side::BID : Side::ASK; }
+
+    Price touch(Side s) const {
+        const auto& lad = s == Side::BID ? bids : asks;
+        return lad.empty() ? 0 : lad.begin()->first;
+    }
+
+    Price limitPrice(Side s) {
+        Price bid = touch(Side::BID);
+        Price ask = touch(Side::ASK);
+        if (bid == 0) bid = (ask != 0 ? ask : cfg.initial_mid) - 1;
+        if (ask == 0) ask = bid + 2;
+        if (ask - bid > 1 && rng.uniform() < cfg.inside_prob) {
+            return s == Side::BID ? bid + 1 : ask - 1;
+        }
+        // Geometric distance from the touch, thinned where the queue is
+        // already long so that thin levels refill faster.
+        Price px = 0;
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            int d = 0;
+            if (cfg.touch_decay > 0.0) {
+                const double u = std::max(rng.uniform(), 1e-12);
+                d = std::min(static_cast<int>(std::log(u) / std::log(cfg.touch_decay)), cfg.depth - 1);
+            }
+            px = s == Side::BID ? std::max<Price>(1, bid - d) : ask + d;
+            const auto& lad = ladder(s);
+            auto it = lad.find(px);
+            const double q = it == lad.end() ? 0.0 : static_cast<double>(it->second.qty);
+            if (rng.uniform() * (1.0 + q / std::max(1U, cfg.target_queue)) < 1.0) break;
+        }
+        return px;
+    }
+
+    void emitAdd(Side s, Price px, Quantity qty, MarketDataUpdate& u) {
+        const OrderId id = next_id++;
+        Resting o{px, qty, s, 0, static_cast<uint32_t>(live.size())};
+        live.push_back(id);
+        enqueue(id, o);
+        orders.emplace(id, o);
+        u.type = MarketDataUpdate::ADD_ORDER;
+        u.side = s;
+        u.price = px;
+        u.quantity = qty;
+        u.order_id = id;
+    }
+
+    void emitSeed(MarketDataUpdate& u) {
+        // Alternate sides from the touch outwards.
+        const uint64_t total = seed_remaining--;
+        const uint64_t k = static_cast<uint64_t>(cfg.depth) * static_cast<uint64_t>(cfg.initial_orders_per_level) * 2 - total;
+        const Side s = (k % 2 == 0) ? Side::BID : Side::ASK;
+        const auto d = static_cast<Price>(k / 2 / static_cast<uint64_t>(cfg.initial_orders_per_level));
+        emitAdd(s, s == Side::BID ? cfg.initial_mid - 1 - d : cfg.initial_mid + 1 + d, quantity(), u);
+    }
+
+    void emitCancel(MarketDataUpdate& u) {
+        const OrderId id = live[rng.below(live.size())];
+        const Resting o = orders[id];
+        dequeue(o, o.qty, true);
+        forget(id, o);
+        u.type = MarketDataUpdate::CANCEL_ORDER;
+        u.side = o.side;
+        u.price = o.price;
+        u.quantity = o.qty;
+        u.order_id = id;
+    }
+
+    void emitModify(MarketDataUpdate& u) {
+        const OrderId id = live[rng.below(live.size())];
+        Resting& o = orders[id];
+        Quantity qty;
+        if (rng.uniform() < cfg.modify_up_prob) {
+            // Size increases lose queue priority, as in OrderBook::modifyOrder.
+            qty = o.qty + quantity() / 2 + 1;
+            dequeue(o, o.qty, false);
+            ++o.version;
+            ladder(o.side)[o.price].count -= 1;
+            o.qty = qty;
+            enqueue(id, o);
+        } else {
+            if (o.qty <= 1) {
+                emitCancel(u);
+                return;
+            }
+            qty = o.qty / 2;
+            dequeue(o, o.qty - qty, false);
+            o.qty = qty;
+        }
+        u.type = MarketDataUpdate::MODIFY_ORDER;
+        u.side = o.side;
+        u.price = o.price;
+        u.quantity = qty;
+        u.order_id = id;
+    }
+
+    void emitMarket(MarketDataUpdate& u) {
+        Side aggressor = side();
+        if (ladder(aggressor == Side::BID ? Side::ASK : Side::BID).empty()) {
+            aggressor = aggressor == Side::BID ? Side::ASK : Side::BID;
+        }
+        auto& opp = ladder(aggressor == Side::BID ? Side::ASK : Side::BID);
+        if (opp.empty()) {
+            const Side s = side();
+            emitAdd(s, limitPrice(s), quantity(), u);
+            return;
+        }
+        const auto wanted =
+            static_cast<Quantity>(std::max(1.0, rng.exponential(1.0 / std::max(1.0, cfg.market_qty_mean))));
+        Quantity remaining = wanted;
+        Price last_px = 0;
+        while (remaining > 0 && !opp.empty()) {
+            auto lit = opp.begin();
+            Level& level = lit->second;
+            last_px = lit->first;
+            while (remaining > 0 && level.count > 0) {
+                const Entry e = level.fifo[level.head];
+                auto oit = orders.find(e.id);
+                if (oit == orders.end() || oit->second.version != e.version) {
+                    ++level.head;
+                    continue;
+                }
+                Resting& o = oit->second;
+                const Quantity fill = std::min(remaining, o.qty);
+                remaining -= fill;
+                o.qty -= fill;
+                level.qty -= fill;
+                if (o.qty == 0) {
+                    ++level.head;
+                    --level.count;
+                    forget(e.id, o);
+                }
+            }
+            if (level.count == 0) opp.erase(lit);
+        }
+        excitation = excitationAt(now) + cfg.hawkes_jump;
+        excitation_time = now;
+        u.type = MarketDataUpdate::TRADE;
+        u.side = aggressor;
+        u.price = last_px;
+        u.quantity = wanted - remaining;
+        u.order_id = 0;
+    }
+
+    void emit(MarketDataUpdate& u) {
+        u = MarketDataUpdate{};
+        u.timestamp = now;
+        if (seed_remaining > 0) {
+            emitSeed(u);
+            return;
+        }
+        double r[4];
+        intensities(now, r);
+        double x = rng.uniform() * sum(r);
+        if (live.empty() || (x -= r[0]) < 0.0) {
+            const Side s = side();
+            emitAdd(s, limitPrice(s), quantity(), u);
+        } else if ((x -= r[1]) < 0.0) {
+            emitCancel(u);
+        } else if ((x -= r[2]) < 0.0) {
+            emitModify(u);
+        } else {
+            emitMarket(u);
+        }
+    }
+};
+
+// -------- SyntheticMarketGenerator ----------
+
+SyntheticMarketGenerator::SyntheticMarketGenerator(SyntheticMarketConfig config)
+    : config_(std::move(config)), end_time_(config_.start_time + config_.duration) {
+    if (!config_.valid()) return;
+    symbol_names_.reserve(config_.symbols);
+    states_.reserve(config_.symbols);
+    for (uint32_t i = 0; i < config_.symbols; ++i) {
+        char suffix[16];
+        auto res = std::to_chars(suffix, suffix + sizeof(suffix), i);
+        std::string name = config_.symbol_prefix;
+        const auto digits = static_cast<size_t>(res.ptr - suffix);
+        if (digits < 4) name.append(4 - digits, '0');
+        name.append(suffix, res.ptr);
+        symbol_names_.push_back(std::move(name));
+        states_.push_back(std::make_unique<SymbolState>(config_, i));
+        if (states_.back()->advance()) heap_.emplace_back(states_.back()->now, i);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), std::greater<>());
+}
+
+SyntheticMarketGenerator::~SyntheticMarketGenerator() = default;
+
+bool SyntheticMarketGenerator::next(SyntheticUpdate& out) {
+    if (heap_.empty()) return false;
+    if (config_.max_events != 0 && events_ >= config_.max_events) return false;
+
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+    const auto [ts, index] = heap_.back();
+    if (ts > end_time_) {
+        heap_.clear();  // every remaining symbol is at least this late
+        return false;
+    }
+    heap_.pop_back();
+
+    SymbolState& state = *states_[index];
+    state.emit(out.update);
+    out.symbol = index;
+    if (state.advance()) {
+        heap_.emplace_back(state.now, index);
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+    }
+    ++events_;
+    return true;
+}
+
+uint64_t SyntheticMarketGenerator::writeCSV(std::ostream& os) {
+    static const char* const kTypes[] = {"ADD", "MODIFY", "CANCEL", "MARKET", "CLEAR", "SNAPSHOT"};
+    os << "timestamp_ns,symbol,type,side,price,quantity,order_id\n";
+
+    // Rows are formatted with to_chars into a large buffer; iostream
+    // formatting would dominate generation time otherwise.
+    std::vector<char> buf(1 << 16);
+    size_t pos = 0;
+    auto flush = [&] {
+        os.write(buf.data(), static_cast<std::streamsize>(pos));
+        pos = 0;
+    };
+    auto put = [&](const char* s, size_t n) {
+        if (pos + n > buf.size()) flush();
+        std::copy(s, s + n, buf.data() + pos);
+        pos += n;
+    };
+    auto num = [&](auto v) {
+        // Room for any 64-bit integer, so to_chars cannot run out of space.
+        if (buf.size() - pos < 24) flush();
+        auto res = std::to_chars(buf.data() + pos, buf.data() + buf.size(), v);
+        pos = static_cast<size_t>(res.ptr - buf.data());
+    };
+
+    uint64_t rows = 0;
+    SyntheticUpdate su;
+    while (next(su)) {
+        const MarketDataUpdate& u = su.update;
+        const std::string& sym = symbol_names_[su.symbol];
+        const char* type = kTypes[u.type];
+        num(u.timestamp);
+        put(",", 1);
+        put(sym.data(), sym.size());
+        put(",", 1);
+        put(type, std::char_traits<char>::length(type));
+        put(u.side == Side::BID ? ",BID," : ",ASK,", 5);
+        num(u.price);
+        put(",", 1);
+        num(u.quantity);
+        put(",", 1);
+        num(u.order_id);
+        put("\n", 1);
+        ++rows;
+        if (pos > buf.size() - 128) flush();
+    }
+    flush();
+    return rows;
+}
+
+// -------- SyntheticDataSource ----------
+
+SyntheticDataSource::SyntheticDataSource(SyntheticMarketConfig config) : config_(std::move(config)) {
+    reset();
+}
+
+bool SyntheticDataSource::hasNext() const { return has_pending_; }
+
+Event SyntheticDataSource::getNext() {
+    Event e{};
+    e.type = Event::MARKET_DATA;
+    e.timestamp = pending_.update.timestamp;
+    e.symbol = generator_->symbolName(pending_.symbol);
+    e.market_update = pending_.update;
+    advance();
+    return e;
+}
+
+void SyntheticDataSource::reset() {
+    generator_ = std::make_unique<SyntheticMarketGenerator>(config_);
+    advance();
+}
+
+void SyntheticDataSource::advance() { has_pending_ = generator_->next(pending_); }
+
+} // namespace lob
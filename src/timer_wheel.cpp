@@ -0,0 +1,133 @@
+#include "lob/timer_wheel.hpp"
+#include "lob/order_book.hpp"
+
+#include <algorithm>
+
+namespace lob {
+
+TimerWheel::TimerWheel(Timestamp tick_ns) noexcept : tick_(std::max<Timestamp>(1, tick_ns)) {}
+
+void TimerWheel::schedule(Order* order) noexcept {
+    if (!slots_) {
+        slots_ = std::make_unique<Order*[]>(kLevels * kSlots);
+    }
+    place(order);
+    ++size_;
+}
+
+void TimerWheel::cancel(Order* order) noexcept {
+    if (order->timer_slot == kUnscheduled) {
+        return;
+    }
+    unlink(order);
+    --size_;
+}
+
+void TimerWheel::place(Order* order) noexcept {
+    const uint64_t expire_tick = order->expire_time / tick_;
+    if (expire_tick <= now_tick_) {
+        // Due now (or overdue): the current slot is re-checked by advance().
+        link(order, static_cast<uint32_t>(now_tick_ & (kSlots - 1)));
+        return;
+    }
+    const uint64_t delta = expire_tick - now_tick_;
+    for (uint32_t level = 0; level < kLevels; ++level) {
+        const uint32_t shift = level * kSlotBits;
+        if (delta < (uint64_t{1} << (shift + kSlotBits)) || level + 1 == kLevels) {
+            // Beyond the outermost span: park in the farthest slot and
+            // re-file when it cascades.
+            const uint64_t at = level + 1 == kLevels && delta >> (shift + kSlotBits) != 0
+                                    ? now_tick_ + ((uint64_t{1} << (shift + kSlotBits)) - 1)
+                                    : expire_tick;
+            link(order, level * kSlots + static_cast<uint32_t>((at >> shift) & (kSlots - 1)));
+            return;
+        }
+    }
+}
+
+void TimerWheel::link(Order* order, uint32_t slot) noexcept {
+    Order*& head = slots_[slot];
+    order->timer_slot = slot;
+    order->timer_prev = nullptr;
+    order->timer_next = head;
+    if (head) head->timer_prev = order;
+    head = order;
+    ++level_size_[slot / kSlots];
+}
+
+void TimerWheel::unlink(Order* order) noexcept {
+    if (order->timer_prev) {
+        order->timer_prev->timer_next = order->timer_next;
+    } else {
+        slots_[order->timer_slot] = order->timer_next;
+    }
+    if (order->timer_next) {
+        order->timer_next->timer_prev = order->timer_prev;
+    }
+    --level_size_[order->timer_slot / kSlots];
+    order->timer_slot = kUnscheduled;
+    order->timer_next = nullptr;
+    order->timer_prev = nullptr;
+}
+
+void TimerWheel::cascade(uint32_t level) noexcept {
+    const uint32_t slot = level * kSlots + static_cast<uint32_t>((now_tick_ >> (level * kSlotBits)) & (kSlots - 1));
+    Order* order = slots_[slot];
+    while (order) {
+        Order* next = order->timer_next;
+        unlink(order);
+        place(order);
+        order = next;
+    }
+}
+
+void TimerWheel::collect(uint32_t slot, Timestamp now, std::vector<Order*>& due) {
+    Order* order = slots_[slot];
+    while (order) {
+        Order* next = order->timer_next;
+        if (order->expire_time <= now) {
+            unlink(order);
+            --size_;
+            due.push_back(order);
+        }
+        order = next;
+    }
+}
+
+void TimerWheel::advance(Timestamp now, std::vector<Order*>& due) {
+    const uint64_t target = now / tick_;
+    if (size_ == 0) {
+        now_tick_ = std::max(now_tick_, target);
+        return;
+    }
+    // Orders due later within the current tick stay in its slot.
+    collect(static_cast<uint32_t>(now_tick_ & (kSlots - 1)), now, due);
+    while (now_tick_ < target && size_ != 0) {
+        // Skip to just before the next boundary of the innermost occupied
+        // level; the levels below it are empty, so no cascade is missed.
+        uint32_t lowest = 0;
+        while (lowest < kLevels && level_size_[lowest] == 0) ++lowest;
+        if (lowest > 0) {
+            const uint32_t shift = lowest < kLevels ? lowest * kSlotBits : 0;
+            const uint64_t boundary = lowest < kLevels ? ((now_tick_ >> shift) + 1) << shift : target + 1;
+            if (boundary > target) break;
+            now_tick_ = boundary - 1;
+        }
+        ++now_tick_;
+        for (uint32_t level = 1; level < kLevels; ++level) {
+            if ((now_tick_ & ((uint64_t{1} << (level * kSlotBits)) - 1)) != 0) break;
+            cascade(level);
+        }
+        collect(static_cast<uint32_t>(now_tick_ & (kSlots - 1)), now, due);
+    }
+    now_tick_ = std::max(now_tick_, target);
+}
+
+void TimerWheel::clear() noexcept {
+    if (slots_) std::fill(slots_.get(), slots_.get() + kLevels * kSlots, nullptr);
+    level_size_.fill(0);
+    size_ = 0;
+    now_tick_ = 0;
+}
+
+} // namespace lob
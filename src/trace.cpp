@@ -0,0 +1,119 @@
+#include "lob/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+
+namespace lob {
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+struct ThreadSlot {
+    std::shared_ptr<TraceBuffer> buffer;  // keeps the ring alive across restarts
+    uint64_t generation = ~uint64_t{0};
+};
+
+thread_local ThreadSlot t_slot;
+
+} // namespace
+
+// -------- TraceBuffer ----------
+
+TraceBuffer::TraceBuffer(size_t capacity, uint32_t thread_id)
+    : spans_(roundUpPow2(std::max<size_t>(capacity, 1))), mask_(spans_.size() - 1), thread_id_(thread_id) {}
+
+uint64_t TraceBuffer::dropped() const noexcept {
+    const uint64_t n = recorded();
+    return n > spans_.size() ? n - spans_.size() : 0;
+}
+
+std::vector<TraceSpanRecord> TraceBuffer::spans() const {
+    const uint64_t n = recorded();
+    const uint64_t first = n - std::min<uint64_t>(n, spans_.size());
+    std::vector<TraceSpanRecord> out;
+    out.reserve(static_cast<size_t>(n - first));
+    for (uint64_t i = first; i < n; ++i) out.push_back(spans_[static_cast<size_t>(i) & mask_]);
+    return out;
+}
+
+// -------- Tracer ----------
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t Tracer::nowNs() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void Tracer::start(const TraceConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.sample_every = std::max<uint32_t>(1, config_.sample_every);
+    config_.burst = std::clamp<uint32_t>(config_.burst, 1, config_.sample_every);
+    buffers_.clear();
+    origin_ns_ = nowNs();
+    generation_.fetch_add(1, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_release);
+}
+
+TraceBuffer* Tracer::threadBuffer() {
+    if (!enabled()) return nullptr;
+    const uint64_t gen = generation_.load(std::memory_order_acquire);
+    if (t_slot.generation != gen) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        t_slot.buffer = std::make_shared<TraceBuffer>(config_.buffer_capacity,
+                                                      static_cast<uint32_t>(buffers_.size() + 1));
+        t_slot.generation = gen;
+        buffers_.push_back(t_slot.buffer);
+    }
+    return t_slot.buffer.get();
+}
+
+size_t Tracer::writeChromeJson(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t written = 0;
+    uint64_t dropped = 0;
+    char buf[192];
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto sep = [&]() {
+        if (!first) os << ",\n";
+        first = false;
+    };
+    for (const auto& b : buffers_) {
+        sep();
+        std::snprintf(buf, sizeof(buf),
+                      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"replay-%u\"}}",
+                      b->threadId(), b->threadId());
+        os << buf;
+        dropped += b->dropped();
+        for (const auto& s : b->spans()) {
+            // Chrome trace timestamps are microseconds; keep ns resolution.
+            const uint64_t ts = s.begin_ns - std::min(s.begin_ns, origin_ns_);
+            sep();
+            std::snprintf(buf, sizeof(buf),
+                          "{\"name\":\"%s\",\"cat\":\"replay\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                          s.name, b->threadId(), static_cast<double>(ts) * 1e-3,
+                          static_cast<double>(s.end_ns - s.begin_ns) * 1e-3);
+            os << buf;
+            ++written;
+        }
+    }
+    std::snprintf(buf, sizeof(buf), "],\"otherData\":{\"sample_every\":%u,\"burst\":%u,\"dropped_spans\":%llu}}",
+                  config_.sample_every, config_.burst, static_cast<unsigned long long>(dropped));
+    os << buf;
+    return written;
+}
+
+} // namespace lob
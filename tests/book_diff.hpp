@@ -0,0 +1,296 @@
+#pragma once
+
+// Differential testing of order book engines.  A byte string is decoded
+// into add/modify/cancel/market/match operations that are applied to two
+// engines in lockstep; after every operation the harness compares the
+// return values, executions, top-N depth on both sides, order counts and
+// the queue position of every live order.  Shared by the randomized unit
+// test (tests/test_book_diff.cpp) and the libFuzzer entry point
+// (fuzz/fuzz_order_book.cpp).
+//
+// Engines only need OrderBook's public operation and query signatures,
+// so an optimized implementation can be checked against OrderBook, and
+// OrderBook itself is checked against NaiveBook, a deliberately simple
+// model of its price-time semantics.
+
+#include "lob/order_book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lob::testing {
+
+// Straightforward model of OrderBook: per-price FIFO vectors and linear
+// scans.  Mirrors OrderBook exactly, including its edge cases (no
+// matching on add, quantity increases losing queue priority, zero
+// quantity orders resting until touched).
+class NaiveBook {
+public:
+    bool addOrder(const Order& o) {
+        if (find(o.id) != nullptr) return false;
+        side(o.side)[o.price].push_back(Resting{o.id, o.quantity, o.remaining_quantity, o.timestamp});
+        ++count_;
+        return true;
+    }
+
+    bool modifyOrder(OrderId id, Quantity qty) {
+        Side s;
+        Price px;
+        Resting* r = find(id, &s, &px);
+        if (r == nullptr) return false;
+        if (qty > r->remaining) {
+            Resting moved = *r;
+            moved.quantity = moved.remaining = qty;
+            auto& q = side(s)[px];
+            q.erase(q.begin() + (r - q.data()));
+            q.push_back(moved);
+        } else {
+            r->remaining = qty;
+            r->quantity = std::max(r->quantity, qty);
+        }
+        return true;
+    }
+
+    bool cancelOrder(OrderId id) {
+        Side s;
+        Price px;
+        Resting* r = find(id, &s, &px);
+        if (r == nullptr) return false;
+        auto& levels = side(s);
+        auto& q = levels[px];
+        q.erase(q.begin() + (r - q.data()));
+        if (q.empty()) levels.erase(px);
+        --count_;
+        return true;
+    }
+
+    std::vector<Execution> processMarketOrder(Side aggressor, Quantity qty, Timestamp ts) {
+        std::vector<Execution> out;
+        const Side passive = aggressor == Side::BID ? Side::ASK : Side::BID;
+        auto& levels = side(passive);
+        while (qty > 0 && !levels.empty()) {
+            auto it = best(passive);
+            auto& q = it->second;
+            while (qty > 0 && !q.empty()) {
+                Resting& r = q.front();
+                const Quantity fill = std::min(qty, r.remaining);
+                if (aggressor == Side::BID) {
+                    out.emplace_back(0, r.id, it->first, fill, ts);
+                } else {
+                    out.emplace_back(r.id, 0, it->first, fill, ts);
+                }
+                qty -= fill;
+                r.remaining -= fill;
+                if (r.remaining == 0) {
+                    q.erase(q.begin());
+                    --count_;
+                }
+            }
+            if (q.empty()) levels.erase(it);
+        }
+        return out;
+    }
+
+    std::vector<Execution> matchOrders() {
+        std::vector<Execution> out;
+        while (!bids_.empty() && !asks_.empty()) {
+            auto bit = best(Side::BID);
+            auto ait = best(Side::ASK);
+            if (bit->first < ait->first) break;
+            auto& bq = bit->second;
+            auto& aq = ait->second;
+            while (!bq.empty() && !aq.empty()) {
+                Resting& b = bq.front();
+                Resting& a = aq.front();
+                const Price px = b.timestamp < a.timestamp ? bit->first : ait->first;
+                const Quantity qty = std::min(b.remaining, a.remaining);
+                out.emplace_back(b.id, a.id, px, qty, std::max(b.timestamp, a.timestamp));
+                b.remaining -= qty;
+                a.remaining -= qty;
+                if (b.remaining == 0) {
+                    bq.erase(bq.begin());
+                    --count_;
+                }
+                if (a.remaining == 0) {
+                    aq.erase(aq.begin());
+                    --count_;
+                }
+            }
+            if (bq.empty()) bids_.erase(bit);
+            if (aq.empty()) asks_.erase(ait);
+        }
+        return out;
+    }
+
+    std::vector<std::pair<Price, Quantity>> getAggregatedBook(Side s, int n) const {
+        std::vector<std::pair<Price, Quantity>> out;
+        auto add = [&](Price px, const std::vector<Resting>& q) {
+            Quantity total = 0;
+            for (const auto& r : q) total += r.remaining;
+            out.emplace_back(px, total);
+        };
+        if (s == Side::BID) {
+            for (auto it = bids_.rbegin(); it != bids_.rend() && static_cast<int>(out.size()) < n; ++it)
+                add(it->first, it->second);
+        } else {
+            for (auto it = asks_.begin(); it != asks_.end() && static_cast<int>(out.size()) < n; ++it)
+                add(it->first, it->second);
+        }
+        return out;
+    }
+
+    Quantity getQueuePosition(OrderId id) const {
+        for (const auto* levels : {&bids_, &asks_}) {
+            for (const auto& [px, q] : *levels) {
+                Quantity ahead = 0;
+                for (const auto& r : q) {
+                    if (r.id == id) return ahead;
+                    ahead += r.remaining;
+                }
+            }
+        }
+        return 0;
+    }
+
+    size_t orderCount() const { return count_; }
+
+private:
+    struct Resting {
+        OrderId id;
+        Quantity quantity;
+        Quantity remaining;
+        Timestamp timestamp;
+    };
+    using Levels = std::map<Price, std::vector<Resting>>;  // ascending for both sides
+    Levels bids_;
+    Levels asks_;
+    size_t count_ = 0;
+
+    Levels& side(Side s) { return s == Side::BID ? bids_ : asks_; }
+    Levels::iterator best(Side s) { return s == Side::BID ? std::prev(bids_.end()) : asks_.begin(); }
+
+    Resting* find(OrderId id, Side* s = nullptr, Price* px = nullptr) {
+        for (Side sd : {Side::BID, Side::ASK}) {
+            for (auto& [p, q] : side(sd)) {
+                for (auto& r : q) {
+                    if (r.id != id) continue;
+                    if (s != nullptr) *s = sd;
+                    if (px != nullptr) *px = p;
+                    return &r;
+                }
+            }
+        }
+        return nullptr;
+    }
+};
+
+// One decoded operation.
+struct BookOp {
+    enum Kind : uint8_t { ADD, MODIFY, CANCEL, MARKET, MATCH };
+    Kind kind;
+    Side side;
+    OrderId id;
+    Price price;
+    Quantity quantity;
+};
+
+// Decodes 5 bytes per operation.  Ids, prices and quantities are drawn
+// from small ranges so that duplicates, unknown ids, crossed books and
+// queue contention are all common.
+inline std::vector<BookOp> decodeOps(const uint8_t* data, size_t size) {
+    std::vector<BookOp> ops;
+    ops.reserve(size / 5);
+    for (size_t i = 0; i + 5 <= size; i += 5) {
+        const uint8_t* b = data + i;
+        BookOp op{};
+        switch (b[0] % 10) {
+            case 0: case 1: case 2: case 3: op.kind = BookOp::ADD; break;
+            case 4: case 5: op.kind = BookOp::CANCEL; break;
+            case 6: case 7: op.kind = BookOp::MODIFY; break;
+            case 8: op.kind = BookOp::MARKET; break;
+            default: op.kind = BookOp::MATCH; break;
+        }
+        op.side = (b[0] & 0x80) != 0 ? Side::ASK : Side::BID;
+        op.id = 1 + b[1] % 64;
+        op.price = 10000 + static_cast<Price>(b[2] % 32) - 16;
+        op.quantity = static_cast<Quantity>(b[3] % 16 + (b[4] % 4) * 50);
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+// Applies `ops` to both engines and returns an empty string when they
+// agree after every step, otherwise a description of the first mismatch.
+template <typename Reference, typename Candidate>
+std::string runDifferential(const std::vector<BookOp>& ops, Reference& ref, Candidate& cand, int depth = 5) {
+    std::ostringstream why;
+    auto sameExecs = [](const std::vector<Execution>& a, const std::vector<Execution>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t k = 0; k < a.size(); ++k) {
+            if (a[k].bid_id != b[k].bid_id || a[k].ask_id != b[k].ask_id || a[k].price != b[k].price ||
+                a[k].quantity != b[k].quantity || a[k].timestamp != b[k].timestamp)
+                return false;
+        }
+        return true;
+    };
+
+    Timestamp ts = 1;
+    for (size_t step = 0; step < ops.size(); ++step) {
+        const BookOp& op = ops[step];
+        why << "step " << step << " op " << static_cast<int>(op.kind) << " id " << op.id << ": ";
+        switch (op.kind) {
+            case BookOp::ADD: {
+                const Order o{op.id, op.price, op.quantity, op.side, ts};
+                const bool a = ref.addOrder(o);
+                const bool b = cand.addOrder(o);
+                if (a != b) return why.str() + "addOrder result differs";
+                break;
+            }
+            case BookOp::MODIFY: {
+                const bool a = ref.modifyOrder(op.id, op.quantity);
+                const bool b = cand.modifyOrder(op.id, op.quantity);
+                if (a != b) return why.str() + "modifyOrder result differs";
+                break;
+            }
+            case BookOp::CANCEL: {
+                const bool a = ref.cancelOrder(op.id);
+                const bool b = cand.cancelOrder(op.id);
+                if (a != b) return why.str() + "cancelOrder result differs";
+                break;
+            }
+            case BookOp::MARKET: {
+                const auto a = ref.processMarketOrder(op.side, op.quantity, ts);
+                const auto b = cand.processMarketOrder(op.side, op.quantity, ts);
+                if (!sameExecs(a, b)) return why.str() + "market order executions differ";
+                break;
+            }
+            case BookOp::MATCH: {
+                const auto a = ref.matchOrders();
+                const auto b = cand.matchOrders();
+                if (!sameExecs(a, b)) return why.str() + "matchOrders executions differ";
+                break;
+            }
+        }
+        ++ts;
+
+        if (ref.orderCount() != cand.orderCount()) return why.str() + "order count differs";
+        for (Side s : {Side::BID, Side::ASK}) {
+            if (ref.getAggregatedBook(s, depth) != cand.getAggregatedBook(s, depth))
+                return why.str() + (s == Side::BID ? "bid depth differs" : "ask depth differs");
+        }
+        for (OrderId id = 1; id <= 64; ++id) {
+            if (ref.getQueuePosition(id) != cand.getQueuePosition(id)) {
+                why << "queue position of order " << id << " differs";
+                return why.str();
+            }
+        }
+        why.str("");
+    }
+    return {};
+}
+
+} // namespace lob::testing
@@ -0,0 +1,79 @@
+#pragma once
+
+// Random order flow for book-level property tests.  Each step() applies
+// one add, cancel, modify, replace, submit, match, market or range
+// cancel operation around `mid`; the tests check their invariants
+// between steps.  Shared by tests/test_order_book.cpp,
+// tests/test_depth_index.cpp and tests/test_l2_publisher.cpp.
+
+#include "lob/order_book.hpp"
+
+#include <cstdint>
+#include <random>
+
+namespace lob::testing {
+
+class RandomBookOps {
+public:
+    // Resting orders are priced 1..width ticks off `mid` on their own
+    // side.  Without `trading` only passive operations are drawn, so
+    // nothing trades and a seed always rebuilds the same book; with it,
+    // marketable submits, market orders and matchOrders() take liquidity,
+    // and moving `mid` between steps leaves crossed orders to match.
+    RandomBookOps(uint64_t seed, Price start_mid, Price width, bool trading = true)
+        : mid(start_mid), rng_(seed), width_(width), trading_(trading) {}
+
+    Price mid;
+
+    [[nodiscard]] std::mt19937_64& rng() noexcept { return rng_; }
+
+    void step(OrderBook& b) {
+        const Side side = (rng_() & 1) ? Side::BID : Side::ASK;
+        const Price px = price(side);
+        const auto qty = static_cast<Quantity>(1 + rng_() % 200);
+        const OrderId id = 1 + rng_() % next_id_;
+        switch (rng_() % 10) {
+            case 0: case 1: case 2: {
+                const OrderId new_id = next_id_++;
+                (void)b.addOrder(Order{new_id, px, qty, side, new_id});
+                break;
+            }
+            case 3: (void)b.cancelOrder(id); break;
+            case 4: (void)b.modifyOrder(id, qty); break;
+            case 5: {
+                const Order* o = b.getOrder(id);
+                if (o != nullptr) (void)b.replaceOrder(id, price(o->side), qty);
+                break;
+            }
+            case 6: {
+                if (!trading_) break;
+                // Marketable: the same distance through the mid.
+                const OrderId new_id = next_id_++;
+                (void)b.submitOrder(Order{new_id, 2 * mid - px, qty, side, new_id});
+                break;
+            }
+            case 7:
+                if (trading_) (void)b.matchOrders();
+                break;
+            case 8:
+                if (trading_) (void)b.processMarketOrder(side, qty, next_id_);
+                break;
+            default:
+                if (rng_() % 10 == 0) (void)b.cancelRange(side, px - 2, px + 2);
+                break;
+        }
+    }
+
+private:
+    std::mt19937_64 rng_;
+    Price width_;
+    bool trading_;
+    OrderId next_id_ = 1;
+
+    Price price(Side side) {
+        const auto offset = 1 + static_cast<Price>(rng_() % static_cast<uint64_t>(width_));
+        return side == Side::BID ? mid - offset : mid + offset;
+    }
+};
+
+} // namespace lob::testing
@@ -1,6 +1,7 @@
 #include <catch2/catch_all.hpp>
 #include "lob/backtester.hpp"
 #include "lob/event.hpp"
+#include "lob/synthetic.hpp"
 
 using namespace lob;
 
@@ -9,4 +10,250 @@ TEST_CASE("Backtester can run empty CSV") {
     // Intentionally no data source -> run should return default result
     auto res = bt.run();
     REQUIRE(res.num_trades == 0);
-}
\ No newline at end of file
+}
+TEST_CASE("Stage profiling attributes every event") {
+    auto cfg = SyntheticMarketConfig::liquidEquity();
+    cfg.max_events = 2000;
+    Backtester bt;
+    bt.setStageProfiling(true);
+    bt.addStrategy(std::make_unique<MomentumStrategy>());
+    bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+    bt.run();
+    const auto& ps = bt.getPerformanceStats();
+    REQUIRE(ps.events_processed == 2000);
+    REQUIRE(ps.stage(PipelineStage::PARSE).count() == 2000);
+    REQUIRE(ps.stage(PipelineStage::BOOK_UPDATE).count() == 2000);
+    REQUIRE(ps.stage(PipelineStage::SIGNAL_UPDATE).count() == 2000);
+    REQUIRE(ps.stage(PipelineStage::STRATEGY).count() == 2000);
+    REQUIRE(ps.total_matching_time.count() > 0);
+    REQUIRE(ps.stage(PipelineStage::BOOK_UPDATE).percentile(0.99) <= ps.stage(PipelineStage::BOOK_UPDATE).max());
+}
+TEST_CASE("Allocation tracking attributes heap use to book operations") {
+    const auto base = alloc_tracking::snapshot();
+    OrderBook book{"TEST"};
+    REQUIRE(book.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(book.cancelOrder(1));
+    const auto delta = alloc_tracking::snapshot() - base;
+    if (alloc_tracking::compiled()) {
+        // New order node plus a new price level
+        REQUIRE(delta[AllocScope::BOOK_ADD].allocations >= 2);
+        // The cancelled order and its level go back to the book's pools.
+        REQUIRE(delta[AllocScope::BOOK_CANCEL].deallocations == 0);
+    } else {
+        REQUIRE(delta.totalAllocations() == 0);
+    }
+}
+TEST_CASE("Hardware counters degrade gracefully when unavailable") {
+    auto cfg = SyntheticMarketConfig::liquidEquity();
+    cfg.max_events = 1000;
+    Backtester bt;
+    bt.setHardwareCounters(true);
+    bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+    bt.run();
+    const auto& ps = bt.getPerformanceStats();
+    const auto& book = ps.counters(PipelineStage::BOOK_UPDATE);
+    if (ps.hw_counters_available) {
+        REQUIRE(book.samples == 1000);
+        REQUIRE(ps.counters(PipelineStage::SIGNAL_UPDATE).samples == 1000);
+    } else {
+        REQUIRE(book.samples == 0);
+        REQUIRE(book[HwEvent::INSTRUCTIONS] == 0);
+        REQUIRE_FALSE(HwCounterGroup().error().empty());
+    }
+}
+TEST_CASE("Per-symbol state hash streams are reproducible") {
+    auto cfg = SyntheticMarketConfig::smallCap();
+    cfg.symbols = 3;
+    cfg.max_events = 3000;
+    auto replay = [&]() {
+        Backtester bt;
+        bt.setStateHashInterval(100);
+        bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+        bt.run();
+        return bt.getStateHashes();
+    };
+    const auto a = replay();
+    const auto b = replay();
+    REQUIRE(a.size() == 3);
+    for (const auto& [sym, stream] : a) {
+        const auto& other = b.at(sym);
+        REQUIRE(stream.events == other.events);
+        REQUIRE(stream.samples.size() == stream.events / 100);
+        for (size_t i = 0; i < stream.samples.size(); ++i) {
+            REQUIRE(stream.samples[i].event == other.samples[i].event);
+            REQUIRE(stream.samples[i].hash == other.samples[i].hash);
+        }
+    }
+}
+namespace {
+
+class VectorSource : public DataSource {
+public:
+    explicit VectorSource(std::vector<Event> events) : events_(std::move(events)) {}
+    bool hasNext() const override { return next_ < events_.size(); }
+    Event getNext() override { return events_[next_++]; }
+    void reset() override { next_ = 0; }
+
+private:
+    std::vector<Event> events_;
+    size_t next_ = 0;
+};
+
+Event addEvent(const std::string& sym, Timestamp ts, OrderId id, Side side, Price px) {
+    Event e{};
+    e.type = Event::MARKET_DATA;
+    e.timestamp = ts;
+    e.symbol = sym;
+    e.market_update = MarketDataUpdate{MarketDataUpdate::ADD_ORDER, side, px, 100, id, ts};
+    return e;
+}
+
+// Records what each callback saw of the book.
+class RecordingStrategy : public Strategy {
+public:
+    struct Call {
+        uint32_t updates;
+        Price best_bid;
+        bool touch_changed;
+    };
+    std::vector<Call> calls;
+
+    void onMarketData(const MarketDataUpdate&, const OrderBook& book, Portfolio&) override {
+        calls.push_back({1, book.getBestBid(), false});
+    }
+    void onMarketDataBatch(const MarketDataBatch& batch, const OrderBook& book, Portfolio&) override {
+        calls.push_back({batch.updates, book.getBestBid(), batch.touchChanged()});
+    }
+    void onSignal(const Signal&, const OrderBook&, Portfolio&) override {}
+    void onFill(const Execution&, Portfolio&) override {}
+};
+
+} // namespace
+
+TEST_CASE("Timestamp coalescing calls strategies once per burst on the final book") {
+    std::vector<Event> events = {
+        addEvent("AAA", 10, 1, Side::BID, 100), addEvent("AAA", 10, 2, Side::BID, 101),
+        addEvent("AAA", 10, 3, Side::ASK, 105), addEvent("BBB", 10, 4, Side::BID, 50),
+        addEvent("AAA", 20, 5, Side::BID, 99),  addEvent("AAA", 25, 6, Side::BID, 102),
+    };
+    Event eod{};
+    eod.type = Event::END_OF_DAY;
+    eod.timestamp = 25;
+    events.push_back(eod);
+    events.push_back(addEvent("AAA", 25, 7, Side::BID, 103));
+
+    Backtester bt;
+    bt.setTimestampCoalescing(true);
+    auto strat = std::make_unique<RecordingStrategy>();
+    auto* rec = strat.get();
+    bt.addStrategy(std::move(strat));
+    bt.setDataSource(std::make_unique<VectorSource>(events));
+    bt.run();
+
+    // Bursts: {AAA x3, BBB} at 10, AAA at 20, AAA at 25; END_OF_DAY then
+    // closes the burst before the last add.
+    REQUIRE(rec->calls.size() == 5);
+    CHECK(rec->calls[0].updates == 3);
+    CHECK(rec->calls[0].best_bid == 101);  // never sees the half-applied book
+    CHECK(rec->calls[0].touch_changed);
+    CHECK(rec->calls[1].updates == 1);
+    CHECK(rec->calls[1].best_bid == 50);
+    CHECK_FALSE(rec->calls[2].touch_changed);  // 99 joined behind 101
+    CHECK(rec->calls[3].best_bid == 102);
+    CHECK(rec->calls[4].best_bid == 103);
+    const auto& ps = bt.getPerformanceStats();
+    CHECK(ps.events_processed == 7);
+    CHECK(ps.market_data_callbacks == 5);
+
+    // With an epsilon the updates at 20 and 25 merge as well.
+    Backtester wide;
+    wide.setTimestampCoalescing(true, 10);
+    wide.setDataSource(std::make_unique<VectorSource>(events));
+    wide.run();
+    CHECK(wide.getPerformanceStats().market_data_callbacks == 4);
+}
+
+TEST_CASE("Timestamp coalescing leaves book states unchanged") {
+    auto cfg = SyntheticMarketConfig::liquidEquity();
+    cfg.symbols = 2;
+    cfg.max_events = 5000;
+    auto replay = [&](bool coalesce) {
+        Backtester bt;
+        bt.setStateHashInterval(1);
+        bt.setTimestampCoalescing(coalesce, 1000000);  // 1 ms
+        bt.addStrategy(std::make_unique<MomentumStrategy>());
+        bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+        bt.run();
+        return std::make_pair(bt.getStateHashes(), bt.getPerformanceStats().market_data_callbacks);
+    };
+    const auto [plain, plain_calls] = replay(false);
+    const auto [merged, merged_calls] = replay(true);
+    CHECK(plain_calls == 5000);
+    CHECK(merged_calls < plain_calls);
+    REQUIRE(plain.size() == merged.size());
+    for (const auto& [sym, stream] : plain) {
+        const auto& other = merged.at(sym);
+        REQUIRE(stream.samples.size() == other.samples.size());
+        bool same = true;
+        for (size_t i = 0; i < stream.samples.size(); ++i) same = same && stream.samples[i].hash == other.samples[i].hash;
+        CHECK(same);
+    }
+}
+
+TEST_CASE("Warm-up rebuilds the book without running the pipeline") {
+    auto cfg = SyntheticMarketConfig::liquidEquity();
+    cfg.symbols = 2;
+    cfg.max_events = 4000;
+    struct Replay {
+        std::unordered_map<std::string, Backtester::StateHashStream> hashes;
+        Backtester::PerformanceStats stats;
+        std::vector<RecordingStrategy::Call> calls;
+    };
+    auto replay = [&](Timestamp until, uint64_t events) {
+        Backtester bt;
+        bt.setStateHashInterval(1);
+        bt.setStageProfiling(true);
+        bt.setWarmUp(until, events);
+        auto strat = std::make_unique<RecordingStrategy>();
+        auto* rec = strat.get();
+        bt.addStrategy(std::move(strat));
+        bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+        bt.run();
+        return Replay{bt.getStateHashes(), bt.getPerformanceStats(), rec->calls};
+    };
+    const Replay full_run = replay(0, 0);
+    const Replay warm_run = replay(0, 1500);
+    const auto& full = full_run.hashes;
+    const auto& warm = warm_run.hashes;
+    const auto& full_stats = full_run.stats;
+    const auto& warm_stats = warm_run.stats;
+
+    CHECK(full_stats.warm_up_events == 0);
+    CHECK(warm_stats.warm_up_events == 1500);
+    CHECK(warm_stats.events_processed == 2500);
+    CHECK(warm_stats.stage(PipelineStage::SIGNAL_UPDATE).count() == 2500);
+    CHECK(warm_stats.stage(PipelineStage::BOOK_UPDATE).count() == 2500);
+    CHECK(warm_run.calls.size() == 2500);
+    // Books end up identical, and so do the callbacks after the warm-up.
+    REQUIRE(full.size() == warm.size());
+    for (const auto& [sym, stream] : full) {
+        const auto& other = warm.at(sym);
+        REQUIRE(stream.samples.size() == other.samples.size());
+        CHECK(stream.samples.back().hash == other.samples.back().hash);
+    }
+    bool same_tail = true;
+    for (size_t i = 0; i < warm_run.calls.size(); ++i) {
+        same_tail = same_tail && warm_run.calls[i].best_bid == full_run.calls[1500 + i].best_bid;
+    }
+    CHECK(same_tail);
+
+    // A time bound keeps every update before it away from the strategies.
+    const Timestamp cutoff = cfg.start_time + 500000000ULL;  // 0.5 s after the open
+    Backtester timed;
+    timed.setWarmUp(cutoff);
+    timed.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+    timed.run();
+    const auto& ts = timed.getPerformanceStats();
+    CHECK(ts.warm_up_events > 0);
+    CHECK(ts.warm_up_events + ts.events_processed == 4000);
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_all.hpp>
+#include "book_diff.hpp"
+
+#include <random>
+
+using namespace lob;
+using namespace lob::testing;
+
+namespace {
+
+std::vector<BookOp> randomOps(uint64_t seed, size_t count) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> bytes(count * 5);
+    for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+    return decodeOps(bytes.data(), bytes.size());
+}
+
+// OrderBook with a plausible bug: every modify re-queues the order, so
+// quantity decreases lose time priority too.
+class RequeueOnModifyBook : public OrderBook {
+public:
+    using OrderBook::OrderBook;
+    bool modifyOrder(OrderId id, Quantity qty) {
+        const Order* o = getOrder(id);
+        if (o == nullptr) return false;
+        Order copy{o->id, o->price, qty, o->side, o->timestamp};
+        return cancelOrder(id) && addOrder(copy);
+    }
+};
+
+} // namespace
+
+TEST_CASE("OrderBook matches the reference model on random sequences") {
+    for (uint64_t seed = 1; seed <= 200; ++seed) {
+        OrderBook book{"DIFF"};
+        NaiveBook model;
+        const std::string diff = runDifferential(randomOps(seed, 500), model, book);
+        INFO("seed " << seed);
+        REQUIRE(diff.empty());
+    }
+}
+
+TEST_CASE("Differential harness reports diverging engines") {
+    bool caught = false;
+    for (uint64_t seed = 1; seed <= 50 && !caught; ++seed) {
+        OrderBook book{"REF"};
+        RequeueOnModifyBook buggy{"BUG"};
+        caught = !runDifferential(randomOps(seed, 500), book, buggy).empty();
+    }
+    REQUIRE(caught);
+}
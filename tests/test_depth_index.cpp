@@ -0,0 +1,175 @@
+#include <catch2/catch_all.hpp>
+#include "lob/order_book.hpp"
+#include "book_ops.hpp"
+
+#include <random>
+
+using namespace lob;
+
+namespace {
+
+constexpr int kAllLevels = 10000;
+
+// Reference answers from a walk over the aggregated book.
+uint64_t depthWalk(const OrderBook& b, Side side, Price price) {
+    uint64_t total = 0;
+    for (const auto& [px, qty] : b.getAggregatedBook(side, kAllLevels)) {
+        if (side == Side::BID ? px < price : px > price) break;
+        total += qty;
+    }
+    return total;
+}
+
+MarketImpact impactWalk(const OrderBook& b, Side side, Quantity quantity) {
+    MarketImpact impact;
+    for (const auto& [px, qty] : b.getAggregatedBook(side == Side::BID ? Side::ASK : Side::BID, kAllLevels)) {
+        if (impact.filled == quantity) break;
+        const Quantity take = std::min(quantity - impact.filled, qty);
+        impact.filled += take;
+        impact.worst_price = px;
+        impact.notional += static_cast<int64_t>(take) * px;
+    }
+    return impact;
+}
+
+void checkAgainstWalk(const OrderBook& b, std::mt19937_64& rng) {
+    for (Side side : {Side::BID, Side::ASK}) {
+        const auto levels = b.getAggregatedBook(side, kAllLevels);
+        uint64_t total = 0;
+        for (const auto& level : levels) total += level.second;
+        const Price ticks = static_cast<Price>(rng() % 40);
+        const uint64_t within = levels.empty() ? 0
+                              : depthWalk(b, side, side == Side::BID ? levels[0].first - ticks : levels[0].first + ticks);
+        REQUIRE(b.depthWithin(side, ticks) == within);
+
+        const Price probe = levels.empty() ? 10000 : levels[rng() % levels.size()].first;
+        REQUIRE(b.depthAtOrBetter(side, probe) == depthWalk(b, side, probe));
+
+        const uint64_t want = 1 + rng() % (total + 10);
+        Price expected_price = 0;
+        uint64_t running = 0;
+        for (const auto& [px, qty] : levels) {
+            running += qty;
+            if (running >= want) {
+                expected_price = px;
+                break;
+            }
+        }
+        REQUIRE(b.priceToFill(side, want) == expected_price);
+
+        const auto qty = static_cast<Quantity>(1 + rng() % 3000);
+        const MarketImpact got = b.estimateMarketImpact(side, qty);
+        const MarketImpact ref = impactWalk(b, side, qty);
+        REQUIRE(got.filled == ref.filled);
+        REQUIRE(got.notional == ref.notional);
+        if (ref.filled != 0) REQUIRE(got.worst_price == ref.worst_price);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Depth index agrees with a walk over the levels") {
+    lob::testing::RandomBookOps ops(21, 10000, 60);
+    OrderBook b{"TEST"};
+    for (int i = 0; i < 20000; ++i) {
+        // The mid drifts far enough to grow the index windows repeatedly.
+        ops.mid += static_cast<Price>(ops.rng()() % 41) - 20;
+        ops.step(b);
+        if (i % 50 == 0) checkAgainstWalk(b, ops.rng());
+    }
+    checkAgainstWalk(b, ops.rng());
+    b.clear();
+    REQUIRE(b.depthWithin(Side::BID, 100) == 0);
+    REQUIRE(b.estimateMarketImpact(Side::BID, 10).filled == 0);
+}
+
+TEST_CASE("Market impact estimate matches the sweep it predicts") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 101, 100, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, 101, 50, Side::ASK, 2}));
+    REQUIRE(b.addOrder(Order{3, 103, 200, Side::ASK, 3}));
+    REQUIRE(b.addOrder(Order{4, 99, 10, Side::BID, 4}));
+
+    REQUIRE(b.depthWithin(Side::ASK, 0) == 150);
+    REQUIRE(b.depthWithin(Side::ASK, 1) == 150);
+    REQUIRE(b.depthWithin(Side::ASK, 2) == 350);
+    REQUIRE(b.priceToFill(Side::ASK, 151) == 103);
+    REQUIRE(b.priceToFill(Side::ASK, 351) == 0);
+
+    const uint64_t before = b.stateHash();
+    const MarketImpact impact = b.estimateMarketImpact(Side::BID, 250);
+    REQUIRE(b.stateHash() == before);  // dry run
+    REQUIRE(impact.filled == 250);
+    REQUIRE(impact.worst_price == 103);
+    REQUIRE(impact.notional == 150 * 101 + 100 * 103);
+    REQUIRE(impact.vwap == static_cast<double>(150 * 101 + 100 * 103) / 250);
+
+    // FOK checks read the same index, market orders included.
+    Order fok{6, 0, 351, Side::BID, 6};
+    fok.type = OrderType::MARKET;
+    fok.tif = TimeInForce::FOK;
+    REQUIRE(b.submitOrder(fok).status == SubmitResult::REJECTED);
+    fok.type = OrderType::LIMIT;
+    fok.price = 101;
+    fok.quantity = 151;
+    REQUIRE(b.submitOrder(fok).status == SubmitResult::REJECTED);
+    REQUIRE(b.stateHash() == before);
+
+    int64_t notional = 0;
+    Quantity filled = 0;
+    for (const Execution& e : b.processMarketOrder(Side::BID, 250, 5)) {
+        notional += static_cast<int64_t>(e.quantity) * e.price;
+        filled += e.quantity;
+    }
+    REQUIRE(filled == impact.filled);
+    REQUIRE(notional == impact.notional);
+
+    // Asking for more than the side holds reports what it would get.
+    const MarketImpact all = b.estimateMarketImpact(Side::BID, 1000);
+    REQUIRE(all.filled == 100);
+    REQUIRE(all.worst_price == 103);
+}
+
+TEST_CASE("Depth queries fall back to the levels for very wide books") {
+    OrderBook b{"TEST"};
+    const Price far = 100 + static_cast<Price>(DepthIndex::kMaxSpan) * 2;
+    REQUIRE(b.addOrder(Order{1, 100, 10, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, far, 20, Side::ASK, 2}));
+    REQUIRE(b.addOrder(Order{3, 101, 30, Side::ASK, 3}));
+    REQUIRE(b.depthAtOrBetter(Side::ASK, 101) == 40);
+    REQUIRE(b.depthWithin(Side::ASK, 5) == 40);
+    REQUIRE(b.priceToFill(Side::ASK, 45) == far);
+    const MarketImpact impact = b.estimateMarketImpact(Side::BID, 45);
+    REQUIRE(impact.filled == 45);
+    REQUIRE(impact.notional == 10 * 100 + 30 * 101 + 5 * far);
+    Order fok{5, 101, 41, Side::BID, 5};
+    fok.tif = TimeInForce::FOK;
+    REQUIRE(b.submitOrder(fok).status == SubmitResult::REJECTED);
+    fok.quantity = 40;
+    REQUIRE(b.submitOrder(fok).status == SubmitResult::FILLED);
+
+    // clear() makes the side indexable again.
+    b.clear();
+    REQUIRE(b.addOrder(Order{4, 100, 10, Side::ASK, 4}));
+    REQUIRE(b.depthWithin(Side::ASK, 0) == 10);
+}
+
+TEST_CASE("Depth index grows its window in both directions") {
+    DepthIndex asks(false);
+    DepthIndex bids(true);
+    for (Price p : {5000, 3000, 9000, 100, 20000}) {
+        asks.add(p, p);
+        bids.add(p, p);
+    }
+    REQUIRE(asks.exact());
+    REQUIRE(asks.total() == 37100);
+    REQUIRE(asks.depthThrough(3000) == 3100);
+    REQUIRE(bids.depthThrough(3000) == 37000);
+    REQUIRE(asks.notionalThrough(100) == 100 * 100);
+    Price p = 0;
+    REQUIRE(bids.priceFor(20001, p));
+    REQUIRE(p == 9000);
+    REQUIRE(asks.priceFor(37100, p));
+    REQUIRE(p == 20000);
+    REQUIRE_FALSE(asks.priceFor(37101, p));
+}
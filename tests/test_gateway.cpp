@@ -0,0 +1,150 @@
+#include <catch2/catch_all.hpp>
+#include "lob/gateway.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+using namespace lob;
+using wire::MsgType;
+using wire::RejectReason;
+
+namespace {
+
+std::vector<GatewayMessage> receive(GatewayClient& c, size_t n) {
+    std::vector<GatewayMessage> out;
+    GatewayMessage m;
+    while (out.size() < n && c.next(m)) out.push_back(m);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Gateway round-trips orders over TCP loopback") {
+    MatchingEngineConfig ecfg;
+    ecfg.clients = 2;
+    MatchingEngine engine(ecfg);
+    engine.addSymbol("AAA");
+    engine.addSymbol("BBB");
+    engine.start();
+    GatewayConfig gcfg;
+    gcfg.max_connections = 2;
+    Gateway gw(engine, gcfg);
+    REQUIRE(gw.start());
+    REQUIRE(gw.port() != 0);
+
+    GatewayClient seller, buyer;
+    REQUIRE(seller.connectTcp(gw.port()));
+    REQUIRE(buyer.connectTcp(gw.port()));
+
+    seller.newOrder(1, 1, Side::ASK, 10100, 50);
+    seller.newOrder(2, 1, Side::ASK, 10200, 50);
+    seller.replace(2, 1, 20);
+    REQUIRE(seller.flush());
+    auto acks = receive(seller, 3);
+    REQUIRE(acks.size() == 3);
+    for (const auto& a : acks) REQUIRE(a.type == MsgType::ACK);
+    REQUIRE(acks[2].command == MsgType::REPLACE);
+    REQUIRE(acks[2].order_id == 2);
+
+    // The buyer may reuse the seller's client order ids.
+    buyer.marketOrder(1, 1, Side::BID, 60);
+    REQUIRE(buyer.flush());
+    auto msgs = receive(buyer, 3);
+    REQUIRE(msgs.size() == 3);
+    REQUIRE(msgs[0].type == MsgType::ACK);
+    REQUIRE(msgs[1].type == MsgType::FILL);
+    REQUIRE(msgs[1].price == 10100);
+    REQUIRE(msgs[1].quantity == 50);
+    REQUIRE(msgs[2].quantity == 10);
+    REQUIRE(msgs[2].symbol == 1);
+    for (size_t i = 0; i < msgs.size(); ++i) REQUIRE(msgs[i].seq == i + 1);
+    auto fills = receive(seller, 2);
+    REQUIRE(fills.size() == 2);
+    REQUIRE(fills[0].order_id == 1);
+    REQUIRE(fills[1].order_id == 2);
+
+    seller.cancel(2, 1);
+    seller.cancel(2, 1);   // already gone
+    seller.cancel(3, 9);   // unknown symbol
+    REQUIRE(seller.flush());
+    auto cancels = receive(seller, 3);
+    REQUIRE(cancels.size() == 3);
+    // The gateway rejects bad messages inline, so that reject may overtake
+    // the engine's replies.
+    std::vector<RejectReason> reasons;
+    for (const auto& c : cancels) reasons.push_back(c.reason);
+    std::sort(reasons.begin(), reasons.end());
+    REQUIRE(reasons == std::vector<RejectReason>{RejectReason::NONE, RejectReason::ENGINE, RejectReason::BAD_MESSAGE});
+    REQUIRE(seller.sequenceGaps() == 0);
+
+    // A third connection finds no free slot and is closed.
+    GatewayClient extra;
+    REQUIRE(extra.connectTcp(gw.port()));
+    GatewayMessage m;
+    REQUIRE_FALSE(extra.next(m));
+
+    gw.stop();
+    engine.stop();
+    REQUIRE(gw.stats().accepted == 2);
+    REQUIRE(gw.stats().refused == 1);
+    REQUIRE(gw.stats().bad_messages == 1);
+    REQUIRE(engine.book(1)->orderCount() == 0);
+}
+
+TEST_CASE("Gateway reports sequence gaps over a Unix socket") {
+    const std::string path = (std::filesystem::temp_directory_path() / "lob_test_gateway.sock").string();
+    MatchingEngine engine;
+    engine.addSymbol("AAA");
+    engine.start();
+    GatewayConfig gcfg;
+    gcfg.unix_path = path;
+    Gateway gw(engine, gcfg);
+    REQUIRE(gw.start());
+
+    GatewayClient c;
+    REQUIRE(c.connectUnix(path));
+    c.newOrder(1, 0, Side::BID, 100, 10);
+    c.setNextSeq(5);
+    c.newOrder(2, 0, Side::BID, 100, 10);
+    REQUIRE(c.flush());
+    auto msgs = receive(c, 3);
+    REQUIRE(msgs.size() == 3);
+    size_t gaps = 0, acks = 0;
+    for (const auto& m : msgs) {
+        if (m.type == MsgType::REJECT && m.reason == RejectReason::SEQUENCE_GAP) ++gaps;
+        if (m.type == MsgType::ACK) ++acks;  // the out-of-sequence order is still processed
+    }
+    REQUIRE(gaps == 1);
+    REQUIRE(acks == 2);
+
+    // Reconnecting takes the freed slot with fresh sequence numbers, but
+    // not the previous session's orders: its ids are free to reuse.
+    c.close();
+    REQUIRE(c.connectUnix(path));
+    c.cancel(1, 0);
+    c.newOrder(1, 0, Side::ASK, 100, 4);
+    REQUIRE(c.flush());
+    auto again = receive(c, 3);
+    REQUIRE(again.size() == 3);
+    REQUIRE(again[0].seq == 1);
+    REQUIRE(again[0].type == MsgType::REJECT);
+    REQUIRE(again[0].reason == RejectReason::ENGINE);
+    REQUIRE(again[1].type == MsgType::ACK);
+    // Only the aggressor side of the cross is this session's to hear about.
+    REQUIRE(again[2].type == MsgType::FILL);
+    REQUIRE(again[2].order_id == 1);
+    REQUIRE(again[2].quantity == 4);
+    c.cancel(1, 0);  // filled on arrival
+    REQUIRE(c.flush());
+    auto last = receive(c, 1);
+    REQUIRE(last.size() == 1);
+    REQUIRE(last[0].type == MsgType::REJECT);
+    REQUIRE(last[0].seq == 4);
+
+    gw.stop();
+    engine.stop();
+    REQUIRE(gw.stats().sequence_gaps == 1);
+    REQUIRE(engine.book(0)->orderCount() == 2);
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
@@ -0,0 +1,258 @@
+#include <catch2/catch_all.hpp>
+#include "lob/journal.hpp"
+#include "lob/matching_engine.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <sys/resource.h>
+
+using namespace lob;
+
+namespace {
+
+std::string tempJournal(const char* name) {
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+std::vector<JournalRecord> readAll(const std::string& path, JournalReplayResult& result) {
+    std::vector<JournalRecord> out;
+    result = Journal::replay(path, [&](const JournalRecord* r, size_t n) { out.insert(out.end(), r, r + n); }, 7);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Journal round-trips records from concurrent producers") {
+    const std::string path = tempJournal("lob_test_journal_roundtrip.bin");
+    JournalConfig cfg;
+    cfg.ring_capacity = 64;  // force producers to wait on the writer
+    cfg.sync_every = 4;
+    {
+        Journal j(cfg);
+        REQUIRE(j.open(path, true));
+        std::vector<std::thread> producers;
+        for (ClientId c = 0; c < 3; ++c) {
+            producers.emplace_back([&j, c] {
+                for (OrderId i = 1; i <= 1000; ++i) {
+                    EngineCommand cmd;
+                    cmd.client = c;
+                    cmd.order_id = i;
+                    cmd.price = static_cast<Price>(i);
+                    j.append(JournalRecord::fromCommand(cmd, i));
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        REQUIRE(j.flush());
+        const auto st = j.stats();
+        REQUIRE(st.appended == 3000);
+        REQUIRE(st.written == 3000);
+        REQUIRE(st.syncs >= 1);
+        REQUIRE(st.write_errors == 0);
+    }
+    JournalReplayResult res;
+    const auto records = readAll(path, res);
+    REQUIRE(res.ok);
+    REQUIRE_FALSE(res.truncated);
+    REQUIRE(records.size() == 3000);
+    std::vector<OrderId> last(3, 0);
+    for (const auto& r : records) {
+        REQUIRE(r.order_id == last[r.client] + 1);  // per-producer order is kept
+        REQUIRE(r.timestamp == r.order_id);
+        last[r.client] = r.order_id;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Journal ignores and cuts a torn tail") {
+    const std::string path = tempJournal("lob_test_journal_torn.bin");
+    {
+        Journal j;
+        REQUIRE(j.open(path));
+        for (OrderId i = 1; i <= 10; ++i) {
+            EngineCommand cmd;
+            cmd.order_id = i;
+            j.append(JournalRecord::fromCommand(cmd, i));
+        }
+    }
+    // Simulate a crash mid-write: half a record, then a corrupt one.
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(JournalRecord) / 2);
+    JournalReplayResult res;
+    REQUIRE(readAll(path, res).size() == 9);
+    REQUIRE(res.ok);
+    REQUIRE(res.truncated);
+
+    {
+        Journal j;
+        REQUIRE(j.open(path));  // appends after the last good record
+        EngineCommand cmd;
+        cmd.order_id = 42;
+        j.append(JournalRecord::fromCommand(cmd, 42));
+    }
+    const auto records = readAll(path, res);
+    REQUIRE_FALSE(res.truncated);
+    REQUIRE(records.size() == 10);
+    REQUIRE(records.back().order_id == 42);
+
+    std::ofstream(path, std::ios::binary) << "not a journal";
+    REQUIRE_FALSE(Journal::replay(path, [](const JournalRecord*, size_t) {}).ok);
+    Journal j;
+    REQUIRE_FALSE(j.open(path));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Concurrent flushes all complete without periodic syncs") {
+    const std::string path = tempJournal("lob_test_journal_flush.bin");
+    JournalConfig cfg;
+    cfg.sync_every = 0;
+    cfg.sync_interval_us = 0;
+    Journal j(cfg);
+    REQUIRE(j.open(path, true));
+    std::vector<std::thread> flushers;
+    for (int t = 0; t < 4; ++t) {
+        flushers.emplace_back([&j, t] {
+            for (OrderId i = 1; i <= 200; ++i) {
+                EngineCommand cmd;
+                cmd.order_id = i;
+                cmd.client = static_cast<ClientId>(t);
+                j.append(JournalRecord::fromCommand(cmd, i));
+                if (i % 10 == 0) REQUIRE(j.flush());
+            }
+        });
+    }
+    for (auto& t : flushers) t.join();
+    REQUIRE(j.stats().written == 800);
+    j.close();
+    REQUIRE_FALSE(j.flush());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("A failed write leaves whole records and fails flush") {
+    const std::string path = tempJournal("lob_test_journal_full.bin");
+    // Cap the file a record and a half past the header; the write that
+    // crosses the cap comes back short and the next one with EFBIG.
+    rlimit old_limit{};
+    REQUIRE(::getrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit = old_limit;
+    limit.rlim_cur = 16 + sizeof(JournalRecord) * 3 / 2;
+    {
+        Journal j;
+        REQUIRE(j.open(path, true));
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+        for (OrderId i = 1; i <= 20; ++i) {
+            EngineCommand cmd;
+            cmd.order_id = i;
+            j.append(JournalRecord::fromCommand(cmd, i));
+        }
+        REQUIRE_FALSE(j.flush());
+        REQUIRE(j.failed());
+        j.close();
+        REQUIRE(::setrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+        const auto st = j.stats();
+        REQUIRE(st.write_errors >= 1);
+        REQUIRE(st.written + st.dropped == 20);
+        REQUIRE(st.written <= 1);
+    }
+    std::signal(SIGXFSZ, old_handler);
+    JournalReplayResult res;
+    const auto records = readAll(path, res);
+    REQUIRE(res.ok);
+    REQUIRE_FALSE(res.truncated);
+    REQUIRE(records.size() <= 1);
+    REQUIRE(std::filesystem::file_size(path) == 16 + records.size() * sizeof(JournalRecord));
+
+    // Reopening clears the failure.
+    Journal j;
+    REQUIRE(j.open(path));
+    REQUIRE_FALSE(j.failed());
+    EngineCommand cmd;
+    cmd.order_id = 99;
+    j.append(JournalRecord::fromCommand(cmd, 99));
+    REQUIRE(j.flush());
+    j.close();
+    REQUIRE(readAll(path, res).back().order_id == 99);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Matching engine recovers its books from the journal") {
+    const std::string path = tempJournal("lob_test_journal_engine.bin");
+    MatchingEngineConfig cfg;
+    cfg.shards = 2;
+    cfg.clients = 2;
+    std::vector<uint64_t> hashes;
+    std::vector<size_t> counts;
+    {
+        Journal journal;
+        REQUIRE(journal.open(path, true));
+        cfg.journal = &journal;
+        MatchingEngine engine(cfg);
+        for (int s = 0; s < 4; ++s) engine.addSymbol("SYM" + std::to_string(s));
+        engine.start();
+        for (OrderId i = 1; i <= 400; ++i) {
+            EngineCommand c;
+            c.client = static_cast<ClientId>(i % 2);
+            c.symbol = static_cast<SymbolId>(i % 4);
+            c.order_id = i;
+            c.side = (i / 4) % 2 ? Side::BID : Side::ASK;
+            c.price = 10000 + static_cast<Price>(i % 7) - 3;
+            c.quantity = static_cast<Quantity>(10 + i % 13);
+            switch (i % 10) {
+                case 7: c.type = EngineCommand::MARKET; break;
+                case 8: c.type = EngineCommand::CANCEL; c.order_id = i - 4; break;
+                case 9: c.type = EngineCommand::MODIFY; c.order_id = i - 8; c.quantity = 3; break;
+                default: break;
+            }
+            while (!engine.submit(c)) std::this_thread::yield();
+        }
+        engine.stop();
+        journal.close();
+        for (SymbolId s = 0; s < 4; ++s) {
+            hashes.push_back(engine.book(s)->stateHash());
+            counts.push_back(engine.book(s)->orderCount());
+        }
+    }
+
+    cfg.journal = nullptr;
+    MatchingEngine recovered(cfg);
+    for (int s = 0; s < 4; ++s) recovered.addSymbol("SYM" + std::to_string(s));
+    const JournalReplayResult res = recovered.recover(path);
+    REQUIRE(res.ok);
+    REQUIRE(res.records > 0);
+    for (SymbolId s = 0; s < 4; ++s) {
+        REQUIRE(recovered.book(s)->stateHash() == hashes[s]);
+        REQUIRE(recovered.book(s)->orderCount() == counts[s]);
+    }
+
+    // Ownership is recovered too: only the original client may cancel.
+    OrderId resting = 0;
+    for (OrderId i = 1; i <= 400 && resting == 0; ++i) {
+        if (recovered.book(static_cast<SymbolId>(i % 4))->getOrder(i) != nullptr) resting = i;
+    }
+    REQUIRE(resting != 0);
+    const auto owner = static_cast<ClientId>(resting % 2);
+    recovered.start();
+    EngineCommand cancel;
+    cancel.type = EngineCommand::CANCEL;
+    cancel.order_id = resting;
+    cancel.symbol = static_cast<SymbolId>(resting % 4);
+    cancel.client = 1 - owner;
+    REQUIRE(recovered.submit(cancel));
+    cancel.client = owner;
+    REQUIRE(recovered.submit(cancel));
+    recovered.stop();
+    EngineReport r;
+    REQUIRE(recovered.poll(1 - owner, r));
+    REQUIRE(r.type == EngineReport::REJECT);
+    REQUIRE(recovered.poll(owner, r));
+    REQUIRE(r.type == EngineReport::ACK);
+    std::filesystem::remove(path);
+}
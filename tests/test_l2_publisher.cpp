@@ -0,0 +1,162 @@
+#include <catch2/catch_all.hpp>
+#include "lob/l2_publisher.hpp"
+#include "book_ops.hpp"
+
+#include <algorithm>
+#include <map>
+
+using namespace lob;
+
+namespace {
+
+// Subscriber-side ladder rebuilt from L2 deltas.
+struct Ladder {
+    std::map<Price, Quantity> side[2];
+    uint64_t updates = 0;
+    bool consistent = true;  // last update seen closed a batch
+
+    void apply(const L2Update& u) {
+        auto& levels = side[static_cast<size_t>(u.side)];
+        if (u.quantity == 0) {
+            levels.erase(u.price);
+        } else {
+            levels[u.price] = u.quantity;
+        }
+        consistent = (u.flags & L2Update::END_OF_BATCH) != 0;
+        ++updates;
+    }
+    void drain(L2Subscriber& s) {
+        L2Update u;
+        while (s.poll(u)) apply(u);
+    }
+    [[nodiscard]] bool matches(const OrderBook& book, int depth) const {
+        for (Side s : {Side::BID, Side::ASK}) {
+            auto expected = book.getAggregatedBook(s, depth);
+            std::vector<std::pair<Price, Quantity>> got(side[static_cast<size_t>(s)].begin(),
+                                                        side[static_cast<size_t>(s)].end());
+            if (s == Side::BID) std::reverse(got.begin(), got.end());
+            if (got != expected) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+TEST_CASE("L2 publisher emits only changed levels") {
+    OrderBook book("TEST");
+    L2PublisherConfig cfg;
+    cfg.depth = 3;
+    L2Publisher pub(cfg);
+    const int id = pub.addSubscriber();
+    REQUIRE(id >= 0);
+    L2Subscriber& sub = *pub.subscriber(id);
+    L2Update u;
+
+    REQUIRE(book.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(book.addOrder(Order{2, 100, 5, Side::BID, 2}));
+    REQUIRE(book.addOrder(Order{3, 105, 7, Side::ASK, 3}));
+    REQUIRE(pub.publish(book, 3) == 2);
+    REQUIRE(sub.poll(u));
+    REQUIRE((u.side == Side::BID && u.price == 100 && u.quantity == 15 && u.rank == 1 && u.flags == 0));
+    REQUIRE(sub.poll(u));
+    REQUIRE((u.side == Side::ASK && u.price == 105 && u.rank == 1 && u.flags == L2Update::END_OF_BATCH));
+    REQUIRE(u.timestamp == 3);
+    REQUIRE_FALSE(sub.poll(u));
+
+    REQUIRE(pub.publish(book, 4) == 0);  // unchanged book
+    REQUIRE_FALSE(sub.poll(u));
+
+    // A better bid is new at rank 1; the old touch only shifts and is not re-sent.
+    REQUIRE(book.addOrder(Order{4, 101, 1, Side::BID, 5}));
+    REQUIRE(pub.publish(book, 5) == 1);
+    REQUIRE(sub.poll(u));
+    REQUIRE((u.price == 101 && u.rank == 1));
+
+    // Pushing a level past the depth removes it from the feed.
+    REQUIRE(book.addOrder(Order{5, 102, 1, Side::BID, 6}));
+    REQUIRE(book.addOrder(Order{6, 103, 1, Side::BID, 7}));
+    REQUIRE(pub.publish(book, 7) == 3);
+    Ladder ladder;
+    ladder.side[0] = {{100, 15}, {101, 1}};
+    ladder.side[1] = {{105, 7}};
+    ladder.drain(sub);
+    REQUIRE(ladder.consistent);
+    REQUIRE(ladder.matches(book, 3));
+    REQUIRE(ladder.side[0].count(100) == 0);
+}
+
+TEST_CASE("L2 deltas rebuild the book for every subscriber") {
+    OrderBook book("TEST");
+    L2PublisherConfig cfg;
+    cfg.depth = 5;
+    L2Publisher pub(cfg);
+    const int early = pub.addSubscriber();
+    lob::testing::RandomBookOps ops(11, 10000, 30);
+    Timestamp t = 1;
+    Ladder a, b;
+    int late = -1;
+    for (int i = 0; i < 3000; ++i) {
+        ops.step(book);
+        (void)pub.publish(book, ++t);
+        if (i == 1500) late = pub.addSubscriber();  // joins with a snapshot
+        a.drain(*pub.subscriber(early));
+        REQUIRE(a.consistent);
+        REQUIRE(a.matches(book, 5));
+        if (late >= 0) {
+            b.drain(*pub.subscriber(late));
+            REQUIRE(b.matches(book, 5));
+        }
+    }
+    REQUIRE(pub.stats(early).conflated == 0);
+}
+
+TEST_CASE("Slow L2 subscribers are conflated, not backlogged") {
+    OrderBook book("TEST");
+    L2PublisherConfig cfg;
+    cfg.depth = 10;
+    cfg.ring_capacity = 8;
+    L2Publisher pub(cfg);
+    const int fast = pub.addSubscriber();
+    const int slow = pub.addSubscriber();
+    lob::testing::RandomBookOps ops(5, 10000, 30);
+    Timestamp t = 1;
+    Ladder f, s;
+    for (int i = 0; i < 2000; ++i) {
+        ops.step(book);
+        (void)pub.publish(book, ++t);
+        f.drain(*pub.subscriber(fast));
+        if (i % 50 == 0) s.drain(*pub.subscriber(slow));
+    }
+    // Let the slow reader catch up; conflated levels drain as space frees.
+    for (int i = 0; i < 100 && (pub.stats(slow).pending != 0 || !s.consistent); ++i) {
+        s.drain(*pub.subscriber(slow));
+        (void)pub.publish(book, t);
+    }
+    s.drain(*pub.subscriber(slow));
+    REQUIRE(pub.stats(slow).conflated > 0);
+    REQUIRE(pub.stats(slow).pending == 0);
+    REQUIRE(s.updates < f.updates);
+    REQUIRE(s.consistent);
+    REQUIRE(s.matches(book, 10));
+    REQUIRE(f.matches(book, 10));
+}
+
+TEST_CASE("L2 subscriber reads a POSIX shared-memory ring") {
+    OrderBook book("TEST");
+    L2Publisher pub;
+    const int id = pub.addSubscriber("/lob_test_l2_publisher");
+    REQUIRE(id >= 0);
+    L2Subscriber remote;
+    REQUIRE(remote.attach("/lob_test_l2_publisher"));
+    REQUIRE(book.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(pub.publish(book, 1) == 1);
+    L2Update u;
+    REQUIRE(remote.poll(u));
+    REQUIRE(u.price == 100);
+    REQUIRE_FALSE(pub.subscriber(id)->poll(u));  // same ring, already consumed
+    pub.removeSubscriber(id);
+    REQUIRE(pub.subscriber(id) == nullptr);
+    L2Subscriber gone;
+    REQUIRE_FALSE(gone.attach("/lob_test_l2_publisher"));
+}
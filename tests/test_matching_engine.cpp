@@ -0,0 +1,261 @@
+#include <catch2/catch_all.hpp>
+#include "lob/concurrent_queue.hpp"
+#include "lob/matching_engine.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lob;
+
+TEST_CASE("MPSC queue delivers every item from concurrent producers") {
+    MpscQueue<uint64_t> q(64);
+    constexpr uint64_t kPerProducer = 20000;
+    std::vector<std::thread> producers;
+    for (uint64_t p = 0; p < 4; ++p) {
+        producers.emplace_back([&q, p] {
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                while (!q.push(p * kPerProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+    std::vector<uint64_t> last(4, 0);
+    uint64_t received = 0, v = 0;
+    while (received < 4 * kPerProducer) {
+        if (!q.pop(v)) continue;
+        const uint64_t p = v / kPerProducer;
+        REQUIRE(v % kPerProducer + 1 > last[p]);  // per-producer FIFO
+        last[p] = v % kPerProducer + 1;
+        ++received;
+    }
+    for (auto& t : producers) t.join();
+    REQUIRE_FALSE(q.pop(v));
+}
+
+TEST_CASE("Book engine matches commands from several client threads") {
+    BookEngineConfig cfg;
+    cfg.clients = 2;
+    BookEngine engine("TEST", cfg);
+    engine.start();
+
+    // Client 0 rests 100 asks; client 1 lifts them with market orders.
+    std::thread seller([&] {
+        for (OrderId id = 1; id <= 100; ++id) {
+            EngineCommand c;
+            c.client = 0;
+            c.order_id = id;
+            c.side = Side::ASK;
+            c.price = 10000 + static_cast<Price>(id);
+            c.quantity = 10;
+            while (!engine.submit(c)) std::this_thread::yield();
+        }
+    });
+    seller.join();
+    std::thread buyer([&] {
+        for (OrderId id = 1001; id <= 1050; ++id) {
+            EngineCommand c;
+            c.type = EngineCommand::MARKET;
+            c.client = 1;
+            c.order_id = id;
+            c.side = Side::BID;
+            c.quantity = 20;
+            while (!engine.submit(c)) std::this_thread::yield();
+        }
+    });
+    buyer.join();
+    engine.stop();
+
+    Quantity sold = 0, bought = 0;
+    uint64_t acks = 0;
+    EngineReport r;
+    while (engine.poll(0, r)) {
+        if (r.type == EngineReport::FILL) sold += r.quantity;
+        if (r.type == EngineReport::ACK) ++acks;
+        REQUIRE(r.publish_ns >= r.submit_ns);
+    }
+    while (engine.poll(1, r)) {
+        if (r.type == EngineReport::FILL) bought += r.quantity;
+    }
+    REQUIRE(acks == 100);
+    REQUIRE(sold == 1000);
+    REQUIRE(bought == 1000);
+    REQUIRE(engine.book().orderCount() == 0);
+    REQUIRE(engine.stats().commands == 150);
+}
+
+TEST_CASE("Book engine rejects commands on orders owned by another client") {
+    BookEngineConfig cfg;
+    cfg.clients = 2;
+    BookEngine engine("TEST", cfg);
+    engine.start();
+    EngineCommand add;
+    add.client = 0;
+    add.order_id = 7;
+    add.price = 100;
+    add.quantity = 5;
+    REQUIRE(engine.submit(add));
+    EngineCommand cancel;
+    cancel.type = EngineCommand::CANCEL;
+    cancel.client = 1;
+    cancel.order_id = 7;
+    REQUIRE(engine.submit(cancel));
+    cancel.client = 5;  // unknown client
+    REQUIRE_FALSE(engine.submit(cancel));
+    engine.stop();
+
+    EngineReport r;
+    REQUIRE(engine.poll(1, r));
+    REQUIRE(r.type == EngineReport::REJECT);
+    REQUIRE(engine.book().orderCount() == 1);
+}
+
+TEST_CASE("Book engine reprices an order and matches it when it crosses") {
+    BookEngineConfig cfg;
+    cfg.clients = 2;
+    BookEngine engine("TEST", cfg);
+    engine.start();
+    EngineCommand bid;
+    bid.client = 0;
+    bid.order_id = 1;
+    bid.price = 99;
+    bid.quantity = 10;
+    REQUIRE(engine.submit(bid));
+    EngineCommand ask = bid;
+    ask.client = 1;
+    ask.order_id = 2;
+    ask.side = Side::ASK;
+    ask.price = 101;
+    REQUIRE(engine.submit(ask));
+    EngineCommand amend;
+    amend.type = EngineCommand::MODIFY;
+    amend.client = 0;
+    amend.order_id = 1;
+    amend.price = 101;
+    amend.quantity = 4;
+    REQUIRE(engine.submit(amend));
+    engine.stop();
+
+    REQUIRE(engine.book().getOrder(1) == nullptr);
+    REQUIRE(engine.book().getOrder(2)->remaining_quantity == 6);
+    EngineReport r;
+    int fills = 0;
+    while (engine.poll(0, r)) {
+        if (r.type == EngineReport::FILL) {
+            ++fills;
+            REQUIRE(r.quantity == 4);
+            REQUIRE(r.command == EngineCommand::MODIFY);
+        }
+    }
+    REQUIRE(fills == 1);
+}
+
+TEST_CASE("Matching engine routes symbols to their shards") {
+    MatchingEngineConfig cfg;
+    cfg.shards = 3;
+    cfg.clients = 2;
+    MatchingEngine engine(cfg);
+    std::vector<SymbolId> ids;
+    for (int s = 0; s < 12; ++s) ids.push_back(engine.addSymbol("SYM" + std::to_string(s)));
+    REQUIRE(engine.addSymbol("SYM3") == ids[3]);
+    SymbolId found = 0;
+    REQUIRE(engine.findSymbol("SYM7", found));
+    REQUIRE(found == ids[7]);
+    REQUIRE_FALSE(engine.findSymbol("NOPE", found));
+    for (SymbolId id : ids) {
+        REQUIRE(engine.shardOf(id) == MatchingEngine::hashSymbol("SYM" + std::to_string(id)) % 3);
+    }
+    engine.start();
+
+    // Each symbol gets (id + 1) resting asks from client 0, then client 1
+    // sweeps them with one market order.
+    for (SymbolId id : ids) {
+        for (OrderId k = 0; k <= id; ++k) {
+            EngineCommand c;
+            c.client = 0;
+            c.symbol = id;
+            c.order_id = id * 100 + k + 1;
+            c.side = Side::ASK;
+            c.price = 10000 + static_cast<Price>(k);
+            c.quantity = 5;
+            while (!engine.submit(c)) std::this_thread::yield();
+        }
+    }
+    EngineCommand bad;
+    bad.symbol = 99;
+    REQUIRE_FALSE(engine.submit(bad));
+    engine.stop();
+    engine.start();  // restart keeps books and counters
+    for (SymbolId id : ids) {
+        EngineCommand m;
+        m.type = EngineCommand::MARKET;
+        m.client = 1;
+        m.symbol = id;
+        m.order_id = 90000 + id;
+        m.side = Side::BID;
+        m.quantity = 5 * (id + 1);
+        while (!engine.submit(m)) std::this_thread::yield();
+    }
+    engine.stop();
+
+    std::vector<Quantity> bought(ids.size(), 0);
+    EngineReport r;
+    while (engine.poll(1, r)) {
+        if (r.type == EngineReport::FILL) bought[r.symbol] += r.quantity;
+    }
+    uint64_t total = 0;
+    for (SymbolId id : ids) {
+        REQUIRE(bought[id] == 5 * (id + 1));
+        REQUIRE(engine.book(id)->orderCount() == 0);
+        REQUIRE(engine.symbolCommands(id) == id + 2);
+        total += id + 2;
+    }
+    uint64_t commands = 0;
+    uint32_t symbols = 0;
+    for (const auto& l : engine.shardLoads()) {
+        commands += l.commands;
+        symbols += l.symbols;
+        REQUIRE(l.queue_depth == 0);
+    }
+    REQUIRE(commands == total);
+    REQUIRE(symbols == ids.size());
+    auto hot = engine.hottestSymbols(2);
+    REQUIRE(hot.size() == 2);
+    REQUIRE(hot[0].first == ids[11]);
+    REQUIRE(hot[1].first == ids[10]);
+}
+
+TEST_CASE("Matching engine moves a symbol's book when reassigned") {
+    MatchingEngineConfig cfg;
+    cfg.shards = 2;
+    MatchingEngine engine(cfg);
+    const SymbolId id = engine.addSymbol("MOVE");
+    const uint32_t from = engine.shardOf(id);
+    engine.start();
+    EngineCommand c;
+    c.symbol = id;
+    c.order_id = 1;
+    c.price = 100;
+    c.quantity = 5;
+    REQUIRE(engine.submit(c));
+    REQUIRE_FALSE(engine.assignShard(id, 1 - from));  // only while stopped
+    REQUIRE(engine.addSymbol("LATE") == kInvalidSymbol);
+    REQUIRE(engine.symbolCount() == 1);
+    engine.stop();
+
+    REQUIRE(engine.assignShard(id, 1 - from));
+    REQUIRE_FALSE(engine.assignShard(id, 2));
+    engine.start();
+    c.type = EngineCommand::CANCEL;
+    REQUIRE(engine.submit(c));
+    engine.stop();
+
+    EngineReport r;
+    std::vector<EngineReport::Type> types;
+    while (engine.poll(0, r)) types.push_back(r.type);
+    REQUIRE(types == std::vector<EngineReport::Type>{EngineReport::ACK, EngineReport::ACK});
+    REQUIRE(engine.book(id)->orderCount() == 0);
+    const auto loads = engine.shardLoads();
+    REQUIRE(loads[from].commands == 1);
+    REQUIRE(loads[1 - from].commands == 1);
+    REQUIRE(loads[1 - from].symbols == 1);
+}
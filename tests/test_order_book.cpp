@@ -1,5 +1,9 @@
 #include <catch2/catch_all.hpp>
 #include "lob/order_book.hpp"
+#include "lob/alloc_tracker.hpp"
+#include "book_ops.hpp"
+
+#include <random>
 
 using namespace lob;
 
@@ -12,4 +16,519 @@ TEST_CASE("Add/Match crossing orders") {
     REQUIRE(execs.size()==1);
     REQUIRE(b.orderCount()==0);
     REQUIRE(b.getSpread()==0.0);
-}
\ No newline at end of file
+}
+TEST_CASE("State hash is maintained incrementally") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.stateHash() == 0);
+    lob::testing::RandomBookOps ops(7, 10000, 10);
+    for (int i = 0; i < 5000; ++i) {
+        ops.step(b);
+        REQUIRE(b.stateHash() == b.recomputeStateHash());
+    }
+    b.clear();
+    REQUIRE(b.stateHash() == 0);
+}
+TEST_CASE("State hash distinguishes FIFO order") {
+    OrderBook a{"A"}, b{"B"};
+    REQUIRE(a.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(a.addOrder(Order{2, 100, 10, Side::BID, 2}));
+    REQUIRE(b.addOrder(Order{2, 100, 10, Side::BID, 1}));
+    REQUIRE(b.addOrder(Order{1, 100, 10, Side::BID, 2}));
+    REQUIRE(a.stateHash() != b.stateHash());
+    REQUIRE(a.cancelOrder(1));
+    REQUIRE(a.cancelOrder(2));
+    REQUIRE(a.stateHash() == 0);
+}
+TEST_CASE("Replace follows price-time priority") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(b.addOrder(Order{2, 100, 10, Side::BID, 2}));
+    REQUIRE(b.addOrder(Order{3, 99, 10, Side::BID, 3}));
+
+    // Same price, smaller size: stays at the front.
+    REQUIRE(b.replaceOrder(1, 100, 5));
+    REQUIRE(b.getQueuePosition(1) == 0);
+    REQUIRE(b.getAggregatedBook(Side::BID, 1)[0].second == 15);
+
+    // Same price, larger size: back of the queue.
+    REQUIRE(b.replaceOrder(1, 100, 20));
+    REQUIRE(b.getQueuePosition(1) == 10);
+
+    // New price joins the back of an existing level.
+    REQUIRE(b.replaceOrder(2, 99, 10));
+    REQUIRE(b.getQueuePosition(2) == 10);
+    REQUIRE(b.getOrder(2)->price == 99);
+
+    // New id loses priority even at the same price and size.
+    REQUIRE(b.replaceOrder(3, 99, 10, 30));
+    REQUIRE(b.getOrder(3) == nullptr);
+    REQUIRE(b.getOrder(30) != nullptr);
+    REQUIRE(b.getQueuePosition(30) == 10);
+
+    REQUIRE_FALSE(b.replaceOrder(4, 100, 10));      // unknown
+    REQUIRE_FALSE(b.replaceOrder(1, 100, 0));       // zero quantity
+    REQUIRE_FALSE(b.replaceOrder(1, 101, 10, 2));   // id in use
+    REQUIRE(b.getOrder(1)->price == 100);
+    REQUIRE(b.orderCount() == 3);
+}
+TEST_CASE("Replace moves the only order of a level to a new price") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 105, 10, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, 107, 10, Side::ASK, 2}));
+    // The emptied level at 105 is reused for 103.
+    REQUIRE(b.replaceOrder(1, 103, 7));
+    REQUIRE(b.getBestAsk() == 103);
+    auto asks = b.getAggregatedBook(Side::ASK, 5);
+    REQUIRE(asks.size() == 2);
+    REQUIRE(asks[0] == std::make_pair(Price{103}, Quantity{7}));
+    REQUIRE(asks[1] == std::make_pair(Price{107}, Quantity{10}));
+    // ...or merged into an existing level.
+    REQUIRE(b.replaceOrder(1, 107, 7));
+    asks = b.getAggregatedBook(Side::ASK, 5);
+    REQUIRE(asks.size() == 1);
+    REQUIRE(asks[0] == std::make_pair(Price{107}, Quantity{17}));
+    REQUIRE(b.getQueuePosition(1) == 10);
+}
+TEST_CASE("Replace keeps levels and the state hash consistent") {
+    OrderBook b{"TEST"};
+    const auto checkLevels = [&b] {
+        size_t orders = 0;
+        for (Side side : {Side::BID, Side::ASK}) {
+            for (const auto& [price, qty] : b.getAggregatedBook(side, 10000)) {
+                const auto level = b.getOrdersAtLevel(price, side);
+                REQUIRE_FALSE(level.empty());
+                Quantity sum = 0;
+                for (const auto& o : level) {
+                    REQUIRE(o.price == price);
+                    sum += o.remaining_quantity;
+                }
+                REQUIRE(sum == qty);
+                orders += level.size();
+            }
+        }
+        REQUIRE(orders == b.orderCount());
+    };
+    lob::testing::RandomBookOps ops(11, 10000, 10);
+    for (int i = 0; i < 5000; ++i) {
+        // A wandering mid sends replaces to new and emptied levels.
+        ops.mid += static_cast<Price>(ops.rng()() % 5) - 2;
+        ops.step(b);
+        REQUIRE(b.stateHash() == b.recomputeStateHash());
+        if (i % 100 == 0) checkLevels();
+    }
+    checkLevels();
+}
+TEST_CASE("Mass cancel by participant, side and price range") {
+    OrderBook b{"TEST"};
+    Timestamp t = 1;
+    OrderId id = 1;
+    for (Price px = 95; px <= 99; ++px) {
+        for (uint32_t p = 0; p < 3; ++p) {
+            Order bid{id++, px, 10, Side::BID, t++};
+            bid.participant_id = p;
+            REQUIRE(b.addOrder(bid));
+            Order ask{id++, px + 10, 10, Side::ASK, t++};
+            ask.participant_id = p;
+            REQUIRE(b.addOrder(ask));
+        }
+    }
+    REQUIRE(b.orderCount() == 30);
+
+    std::vector<OrderId> canceled;
+    REQUIRE(b.cancelAll(1, &canceled) == 10);
+    REQUIRE(canceled.size() == 10);
+    for (OrderId c : canceled) REQUIRE(b.getOrder(c) == nullptr);
+    REQUIRE(b.cancelAll(1) == 0);
+    REQUIRE(b.cancelAll(0) == 0);  // unattributed orders are not indexed
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+    REQUIRE(b.getAggregatedBook(Side::BID, 1)[0] == std::make_pair(Price{99}, Quantity{20}));
+
+    // Bids 96..98 in either argument order; asks untouched.
+    canceled.clear();
+    REQUIRE(b.cancelRange(Side::BID, 98, 96, &canceled) == 6);
+    auto bids = b.getAggregatedBook(Side::BID, 10);
+    REQUIRE(bids.size() == 2);
+    REQUIRE(bids[0].first == 99);
+    REQUIRE(bids[1].first == 95);
+    REQUIRE(b.cancelRange(Side::ASK, 100, 104) == 0);
+    REQUIRE(b.cancelRange(Side::ASK, 108, 200) == 4);
+    REQUIRE(b.getAggregatedBook(Side::ASK, 10).size() == 3);
+    REQUIRE(b.getBestAsk() == 105);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+
+    // Participant lists stay consistent after range sweeps and fills.
+    (void)b.processMarketOrder(Side::BID, 10, t++);
+    REQUIRE(b.cancelAll(2) == 5);  // bids 95, 99 and asks 105..107
+    REQUIRE(b.cancelSide(Side::BID) == 2);
+    REQUIRE(b.getBestBid() == 0);
+    REQUIRE(b.cancelSide(Side::ASK) == 2);
+    REQUIRE(b.orderCount() == 0);
+    REQUIRE(b.stateHash() == 0);
+
+    // A participant's list is reusable after it was emptied.
+    Order again{500, 100, 10, Side::BID, t++};
+    again.participant_id = 2;
+    REQUIRE(b.addOrder(again));
+    REQUIRE(b.cancelAll(2) == 1);
+    REQUIRE(b.orderCount() == 0);
+}
+namespace {
+
+Order limitOrder(OrderId id, Side side, Price px, Quantity qty, TimeInForce tif = TimeInForce::GTC) {
+    Order o{id, px, qty, side, id};
+    o.tif = tif;
+    return o;
+}
+
+} // namespace
+
+TEST_CASE("submitOrder matches aggressive limit orders at resting prices") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 101, 5, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, 101, 5, Side::ASK, 2}));
+    REQUIRE(b.addOrder(Order{3, 102, 5, Side::ASK, 3}));
+    REQUIRE(b.addOrder(Order{4, 104, 5, Side::ASK, 4}));
+
+    auto r = b.submitOrder(limitOrder(10, Side::BID, 102, 12));
+    REQUIRE(r.status == SubmitResult::FILLED);
+    REQUIRE(r.filled == 12);  // 5 + 5 + 2
+    REQUIRE(r.executions.size() == 3);
+    REQUIRE(r.executions[0].ask_id == 1);
+    REQUIRE(r.executions[0].bid_id == 10);
+    REQUIRE(r.executions[0].price == 101);
+    REQUIRE(r.executions[2].price == 102);
+    REQUIRE(r.executions[2].quantity == 2);
+    REQUIRE(b.getOrder(10) == nullptr);  // nothing left to rest
+
+    r = b.submitOrder(limitOrder(11, Side::BID, 102, 10));
+    REQUIRE(r.status == SubmitResult::RESTING);
+    REQUIRE(r.filled == 3);
+    REQUIRE(b.getOrder(11)->remaining_quantity == 7);
+    REQUIRE(b.getOrder(11)->quantity == 10);
+    REQUIRE(b.getBestBid() == 102);
+    REQUIRE(b.getBestAsk() == 104);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+}
+
+TEST_CASE("submitOrder handles IOC, FOK and market orders") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 99, 5, Side::BID, 1}));
+    REQUIRE(b.addOrder(Order{2, 98, 5, Side::BID, 2}));
+    const uint64_t before = b.stateHash();
+
+    // FOK larger than the crossing depth is rejected without side effects.
+    auto r = b.submitOrder(limitOrder(10, Side::ASK, 98, 11, TimeInForce::FOK));
+    REQUIRE(r.status == SubmitResult::REJECTED);
+    REQUIRE(r.executions.empty());
+    REQUIRE(b.stateHash() == before);
+    // Depth beyond the limit does not count.
+    r = b.submitOrder(limitOrder(11, Side::ASK, 99, 6, TimeInForce::FOK));
+    REQUIRE(r.status == SubmitResult::REJECTED);
+    r = b.submitOrder(limitOrder(12, Side::ASK, 98, 7, TimeInForce::FOK));
+    REQUIRE(r.status == SubmitResult::FILLED);
+    REQUIRE(r.filled == 7);
+    REQUIRE(b.getAggregatedBook(Side::BID, 5)[0] == std::make_pair(Price{98}, Quantity{3}));
+
+    // IOC fills what crosses and drops the rest.
+    r = b.submitOrder(limitOrder(13, Side::ASK, 97, 10, TimeInForce::IOC));
+    REQUIRE(r.status == SubmitResult::CANCELLED);
+    REQUIRE(r.filled == 3);
+    REQUIRE(b.getOrder(13) == nullptr);
+    REQUIRE(b.orderCount() == 0);
+
+    // Market orders never rest; duplicates are rejected.
+    REQUIRE(b.submitOrder(limitOrder(14, Side::ASK, 105, 5)).status == SubmitResult::RESTING);
+    Order mkt = limitOrder(15, Side::BID, 0, 8);
+    mkt.type = OrderType::MARKET;
+    r = b.submitOrder(mkt);
+    REQUIRE(r.status == SubmitResult::CANCELLED);
+    REQUIRE(r.filled == 5);
+    REQUIRE(r.executions[0].price == 105);
+    REQUIRE(b.submitOrder(limitOrder(17, Side::BID, 100, 1)).status == SubmitResult::RESTING);
+    REQUIRE(b.submitOrder(limitOrder(17, Side::BID, 100, 1)).status == SubmitResult::REJECTED);
+    REQUIRE(b.submitOrder(limitOrder(18, Side::BID, 100, 0)).status == SubmitResult::REJECTED);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+}
+
+namespace {
+
+Order stopOrder(OrderId id, Side side, Price stop_price, Quantity qty, Price limit = 0) {
+    Order o{id, limit, qty, side, id};
+    o.type = limit != 0 ? OrderType::STOP_LIMIT : OrderType::STOP;
+    o.stop_price = stop_price;
+    return o;
+}
+
+} // namespace
+
+TEST_CASE("Stop orders park until triggered and cascade in arrival order") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 101, 5, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, 102, 5, Side::ASK, 2}));
+    REQUIRE(b.addOrder(Order{3, 103, 5, Side::ASK, 3}));
+    REQUIRE(b.addOrder(Order{4, 105, 10, Side::ASK, 4}));
+    REQUIRE(b.addOrder(Order{5, 99, 10, Side::BID, 5}));
+    const uint64_t before = b.stateHash();
+
+    // Nothing has traded yet, so every stop parks without touching the book.
+    REQUIRE(b.submitOrder(stopOrder(20, Side::BID, 102, 5)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(21, Side::BID, 101, 3, 103)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(22, Side::ASK, 95, 1)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(22, Side::ASK, 95, 1)).status == SubmitResult::REJECTED);
+    REQUIRE(b.pendingStops() == 3);
+    REQUIRE(b.stateHash() == before);
+    REQUIRE(b.getOrder(22) != nullptr);
+    REQUIRE(b.getOrder(22)->level == nullptr);
+
+    // 101 fires the stop-limit, whose fill at 102 fires the stop.
+    auto r = b.submitOrder(limitOrder(30, Side::BID, 101, 5));
+    REQUIRE(r.status == SubmitResult::FILLED);
+    REQUIRE(r.filled == 5);
+    REQUIRE(r.triggered == std::vector<OrderId>{21, 20});
+    REQUIRE(r.executions.size() == 4);
+    CHECK(r.executions[1].bid_id == 21);
+    CHECK(r.executions[1].price == 102);
+    CHECK(r.executions[1].quantity == 3);
+    CHECK(r.executions[2].bid_id == 20);
+    CHECK(r.executions[2].quantity == 2);
+    CHECK(r.executions[3].bid_id == 20);
+    CHECK(r.executions[3].price == 103);
+    CHECK(r.executions[3].quantity == 3);
+    REQUIRE(b.lastTradePrice() == 103);
+    REQUIRE(b.pendingStops() == 1);
+    REQUIRE(b.getMetrics().stops_triggered == 2);
+    REQUIRE(b.getBestAsk() == 103);
+
+    // Stops crossed by the same trade run in arrival order, not by price.
+    REQUIRE(b.submitOrder(stopOrder(40, Side::BID, 105, 1)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(41, Side::BID, 104, 1)).status == SubmitResult::PENDING);
+    r = b.submitOrder(limitOrder(31, Side::BID, 105, 4));
+    REQUIRE(r.status == SubmitResult::FILLED);
+    REQUIRE(r.triggered == std::vector<OrderId>{40, 41});
+    REQUIRE(r.executions.size() == 4);
+    CHECK(r.executions[2].bid_id == 40);
+    CHECK(r.executions[3].bid_id == 41);
+    REQUIRE(b.getOrder(4)->remaining_quantity == 6);
+
+    // A stop already crossed by the last trade enters at once.
+    r = b.submitOrder(stopOrder(42, Side::ASK, 106, 2));
+    REQUIRE(r.status == SubmitResult::FILLED);
+    REQUIRE(r.executions[0].bid_id == 5);
+    REQUIRE(r.triggered == std::vector<OrderId>{42});
+    REQUIRE(b.getMetrics().stops_triggered == 5);
+    REQUIRE(b.lastTradePrice() == 99);
+
+    // Parked stops cancel singly and with their participant.
+    REQUIRE(b.cancelOrder(22));
+    REQUIRE_FALSE(b.cancelOrder(22));
+    Order owned = stopOrder(50, Side::ASK, 90, 1);
+    owned.participant_id = 7;
+    REQUIRE(b.submitOrder(owned).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(51, Side::ASK, 90, 1)).status == SubmitResult::PENDING);
+    std::vector<OrderId> canceled;
+    REQUIRE(b.cancelAll(7, &canceled) == 1);
+    REQUIRE(canceled == std::vector<OrderId>{50});
+    REQUIRE(b.pendingStops() == 1);
+    REQUIRE(b.getOrder(50) == nullptr);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+}
+
+TEST_CASE("Parked stops expire, bulk cancel and keep their ids") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 101, 5, Side::ASK, 1}));
+    REQUIRE(b.addOrder(Order{2, 98, 5, Side::BID, 2}));
+    Order gtd = stopOrder(10, Side::BID, 101, 1);
+    gtd.tif = TimeInForce::GTD;
+    gtd.expire_time = 500;
+    REQUIRE(b.submitOrder(gtd).status == SubmitResult::PENDING);
+    REQUIRE(b.pendingExpiries() == 1);
+
+    // A parked stop's id is taken.
+    REQUIRE_FALSE(b.replaceOrder(2, 97, 5, 10));
+    REQUIRE(b.getOrder(2) != nullptr);
+
+    std::vector<OrderId> expired;
+    REQUIRE(b.advanceTime(500, &expired) == 1);
+    REQUIRE(expired == std::vector<OrderId>{10});
+    REQUIRE(b.pendingStops() == 0);
+    REQUIRE(b.pendingExpiries() == 0);
+    REQUIRE(b.getMetrics().orders_expired == 1);
+    // Gone for good: a trade through its stop price fires nothing.
+    auto r = b.submitOrder(limitOrder(3, Side::BID, 101, 5));
+    REQUIRE(r.triggered.empty());
+    REQUIRE(b.lastTradePrice() == 101);
+
+    REQUIRE(b.submitOrder(stopOrder(20, Side::BID, 110, 1)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(21, Side::BID, 120, 1)).status == SubmitResult::PENDING);
+    REQUIRE(b.submitOrder(stopOrder(22, Side::ASK, 90, 1)).status == SubmitResult::PENDING);
+    std::vector<OrderId> canceled;
+    REQUIRE(b.cancelRange(Side::BID, 115, 125, &canceled) == 1);
+    REQUIRE(canceled == std::vector<OrderId>{21});
+    canceled.clear();
+    REQUIRE(b.cancelSide(Side::BID, &canceled) == 2);
+    REQUIRE(canceled == std::vector<OrderId>{2, 20});
+    REQUIRE(b.pendingStops() == 1);
+    REQUIRE(b.getOrder(22) != nullptr);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+}
+
+TEST_CASE("Stop ladders fire exactly the crossed stops") {
+    std::mt19937_64 rng(11);
+    OrderBook b{"TEST"};
+    Timestamp t = 1;
+    OrderId next_id = 1;
+    std::vector<Order> parked;
+    for (int round = 0; round < 200; ++round) {
+        // Deep two-sided book around 1000 so stops fill as small market orders.
+        b.clear();
+        parked.clear();
+        for (Price p = 950; p <= 1050; ++p) {
+            REQUIRE(b.addOrder(Order{next_id++, p, 1000, p < 1000 ? Side::BID : Side::ASK, t++}));
+        }
+        REQUIRE(b.submitOrder(limitOrder(next_id++, Side::BID, 1000, 1)).status == SubmitResult::FILLED);
+        for (int i = 0; i < 40; ++i) {
+            const Side side = (rng() & 1) ? Side::BID : Side::ASK;
+            const Price stop = side == Side::BID ? 1001 + static_cast<Price>(rng() % 30)
+                                                 : 999 - static_cast<Price>(rng() % 30);
+            Order o = stopOrder(next_id++, side, stop, 1);
+            REQUIRE(b.submitOrder(o).status == SubmitResult::PENDING);
+            parked.push_back(o);
+        }
+        // Trade up to a random price; buy stops at or below it fire.
+        const Price to = 1000 + static_cast<Price>(rng() % 35);
+        auto r = b.submitOrder(limitOrder(next_id++, Side::BID, to, static_cast<Quantity>(1000 * (to - 1000) + 1)));
+        std::vector<OrderId> expected;
+        for (const Order& o : parked) {
+            if (o.side == Side::BID && o.stop_price <= to) expected.push_back(o.id);
+        }
+        REQUIRE(r.triggered == expected);
+        REQUIRE(b.pendingStops() == parked.size() - expected.size());
+    }
+}
+
+TEST_CASE("Level and order views read the book in place") {
+    OrderBook b{"TEST"};
+    REQUIRE(b.addOrder(Order{1, 100, 10, Side::BID, 1}));
+    REQUIRE(b.addOrder(Order{2, 100, 20, Side::BID, 2}));
+    REQUIRE(b.addOrder(Order{3, 99, 5, Side::BID, 3}));
+    REQUIRE(b.addOrder(Order{4, 101, 7, Side::ASK, 4}));
+    REQUIRE(b.addOrder(Order{5, 98, 1, Side::BID, 5}));
+
+    const auto base = alloc_tracking::snapshot();
+    LevelInfo top[2];
+    const size_t n = b.fillAggregated(Side::BID, top);
+    std::vector<OrderId> fifo_ids;
+    fifo_ids.reserve(4);
+    Price prev = 0;
+    size_t levels = 0;
+    for (const PriceLevel& level : b.levels(Side::BID)) {
+        REQUIRE((prev == 0 || level.price < prev));
+        prev = level.price;
+        ++levels;
+    }
+    for (const Order& o : b.levelOrders(100, Side::BID)) fifo_ids.push_back(o.id);
+    const bool none = b.levelOrders(100, Side::ASK).empty();
+    const auto delta = alloc_tracking::snapshot() - base;
+    if (alloc_tracking::compiled()) {
+        REQUIRE(delta.totalAllocations() == 1);  // the reserve above
+    }
+
+    REQUIRE(n == 2);
+    REQUIRE(top[0].price == 100);
+    REQUIRE(top[0].quantity == 30);
+    REQUIRE(top[0].order_count == 2);
+    REQUIRE(top[1].price == 99);
+    REQUIRE(levels == 3);
+    REQUIRE(b.levels(Side::ASK).size() == 1);
+    REQUIRE(fifo_ids == std::vector<OrderId>{1, 2});
+    REQUIRE(none);
+
+    // The copying wrappers agree with the views.
+    const auto agg = b.getAggregatedBook(Side::BID, 2);
+    REQUIRE(agg == std::vector<std::pair<Price, Quantity>>{{100, 30}, {99, 5}});
+    const auto orders = b.getOrdersAtLevel(100, Side::BID);
+    REQUIRE(orders.size() == 2);
+    REQUIRE(orders[1].id == 2);
+    REQUIRE(b.getOrdersAtLevel(97, Side::BID).empty());
+}
+
+TEST_CASE("Incremental book stats match a full scan") {
+    lob::testing::RandomBookOps ops(5, 10000, 20);
+    OrderBook b{"TEST"};
+    for (int i = 0; i < 20000; ++i) {
+        ops.mid += static_cast<Price>(ops.rng()() % 5) - 2;
+        ops.step(b);
+        if (i % 25 != 0) continue;
+        const BookStats stats = b.getStats();
+        for (Side s : {Side::BID, Side::ASK}) {
+            uint32_t volume = 0, orders = 0, levels = 0;
+            for (const PriceLevel& level : b.levels(s)) {
+                volume += level.total_quantity;
+                orders += level.order_count;
+                ++levels;
+            }
+            REQUIRE((s == Side::BID ? stats.bid_volume : stats.ask_volume) == volume);
+            REQUIRE((s == Side::BID ? stats.bid_orders : stats.ask_orders) == orders);
+            REQUIRE((s == Side::BID ? stats.bid_levels : stats.ask_levels) == levels);
+        }
+        REQUIRE(stats.total_orders == b.orderCount());
+        REQUIRE(stats.bid_orders + stats.ask_orders == b.orderCount());
+        REQUIRE(stats.imbalance >= -1.0);
+        REQUIRE(stats.imbalance <= 1.0);
+    }
+}
+
+namespace {
+
+// One replayable session of passive order flow (nothing crosses).
+uint64_t runSession(OrderBook& b, uint64_t seed) {
+    lob::testing::RandomBookOps ops(seed, 10000, 20, false);
+    for (int i = 0; i < 5000; ++i) ops.step(b);
+    return b.stateHash();
+}
+
+} // namespace
+
+TEST_CASE("Reset keeps the book's memory for the next session") {
+    OrderBook b{"TEST"};
+    const uint64_t day1 = runSession(b, 9);
+    const BookSizing peak = b.peakSizing();
+    REQUIRE(peak.orders >= b.orderCount());
+    REQUIRE(peak.levels > 0);
+
+    b.reset();
+    REQUIRE(b.orderCount() == 0);
+    REQUIRE(b.stateHash() == 0);
+    REQUIRE(b.getBestBid() == 0);
+    REQUIRE(b.getStats().bid_volume == 0);
+    REQUIRE(b.levels(Side::ASK).empty());
+    REQUIRE(b.lastSessionSizing().orders == peak.orders);
+    REQUIRE(b.lastSessionSizing().levels == peak.levels);
+    REQUIRE(b.peakSizing().orders == 0);
+
+    // The same session again runs entirely from the pools.
+    auto base = alloc_tracking::snapshot();
+    const uint64_t day2 = runSession(b, 9);
+    auto delta = alloc_tracking::snapshot() - base;
+    REQUIRE(day2 == day1);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+    if (alloc_tracking::compiled()) {
+        REQUIRE(delta.totalAllocations() == 0);
+    }
+
+    // A new book sized from the last session only allocates its depth
+    // index windows (three arrays per side).
+    OrderBook fresh{"TEST"};
+    fresh.reserve(b.lastSessionSizing());
+    base = alloc_tracking::snapshot();
+    REQUIRE(runSession(fresh, 9) == day1);
+    delta = alloc_tracking::snapshot() - base;
+    if (alloc_tracking::compiled()) {
+        REQUIRE(delta.totalAllocations() <= 6);
+    }
+
+    // clear() releases everything and forgets the peaks.
+    b.clear();
+    REQUIRE(b.peakSizing().orders == 0);
+    REQUIRE(runSession(b, 9) == day1);
+}
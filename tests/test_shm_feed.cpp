@@ -0,0 +1,155 @@
+#include <catch2/catch_all.hpp>
+#include "lob/shm_feed.hpp"
+#include "lob/synthetic.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace lob;
+
+namespace {
+
+std::string feedName(const char* tag) { return "/lob_test_feed_" + std::string(tag) + "_" + std::to_string(::getpid()); }
+
+SyntheticMarketConfig feedConfig() {
+    SyntheticMarketConfig cfg;
+    cfg.symbols = 3;
+    cfg.max_events = 20000;
+    return cfg;
+}
+
+bool sameEvent(const Event& a, const Event& b) {
+    if (a.type != b.type || a.timestamp != b.timestamp || a.symbol != b.symbol) return false;
+    if (a.market_update.has_value() != b.market_update.has_value()) return false;
+    if (a.market_update) {
+        const auto& x = *a.market_update;
+        const auto& y = *b.market_update;
+        return x.type == y.type && x.side == y.side && x.price == y.price && x.quantity == y.quantity &&
+               x.order_id == y.order_id;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Shared-memory feed delivers every event to each reader") {
+    const std::string name = feedName("all");
+    ShmFeedPublisher publisher;
+    REQUIRE(publisher.create(name, 1 << 16));
+
+    SyntheticDataSource direct(feedConfig());
+    std::vector<Event> expected;
+    while (direct.hasNext()) expected.push_back(direct.getNext());
+
+    // Readers attach before anything is written and consume concurrently.
+    constexpr int kReaders = 3;
+    std::vector<std::vector<Event>> received(kReaders);
+    std::vector<uint64_t> lost(kReaders);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&, r] {
+            ShmFeedSource source(name, true, 5000);
+            if (!source.attached()) return;
+            while (source.hasNext()) received[r].push_back(source.getNext());
+            lost[r] = source.reader().lost();
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    SyntheticDataSource replay(feedConfig());
+    CHECK(publisher.pump(replay) == expected.size());
+    publisher.close();
+    for (auto& t : readers) t.join();
+
+    for (int r = 0; r < kReaders; ++r) {
+        INFO("reader " << r);
+        CHECK(lost[r] == 0);
+        REQUIRE(received[r].size() == expected.size());
+        bool same = true;
+        for (size_t i = 0; i < expected.size() && same; ++i) same = sameEvent(received[r][i], expected[i]);
+        CHECK(same);
+    }
+}
+
+TEST_CASE("Shared-memory feed reader detects being lapped") {
+    const std::string name = feedName("lap");
+    ShmFeedPublisher publisher;
+    REQUIRE(publisher.create(name, 64));
+    ShmFeedReader reader;
+    REQUIRE(reader.open(name));
+
+    FeedRecord r;
+    for (uint64_t i = 0; i < 10; ++i) {
+        r.timestamp = i;
+        REQUIRE(publisher.publish(r));
+    }
+    FeedRecord out;
+    REQUIRE(reader.poll(out) == ShmFeedReader::Status::OK);
+    CHECK(out.timestamp == 0);
+
+    // The writer never waits: 200 more records lap the reader's cursor.
+    for (uint64_t i = 10; i < 210; ++i) {
+        r.timestamp = i;
+        REQUIRE(publisher.publish(r));
+    }
+    CHECK(reader.poll(out) == ShmFeedReader::Status::OVERRUN);
+    CHECK(reader.overruns() == 1);
+    CHECK(reader.lost() > 0);
+
+    // After the overrun the reader continues in order from the oldest
+    // retained record and accounts for every record exactly once.
+    uint64_t got = 1, prev = 0;
+    bool ordered = true;
+    while (reader.poll(out) == ShmFeedReader::Status::OK) {
+        if (got > 1 && out.timestamp != prev + 1) ordered = false;
+        prev = out.timestamp;
+        ++got;
+    }
+    CHECK(ordered);
+    CHECK(prev == 209);
+    CHECK(got + reader.lost() == 210);
+
+    CHECK(reader.poll(out) == ShmFeedReader::Status::EMPTY);
+    publisher.close();
+    CHECK(reader.poll(out) == ShmFeedReader::Status::END);
+}
+
+TEST_CASE("Shared-memory feed rejects mismatched objects and unsupported events") {
+    ShmFeedReader reader;
+    CHECK_FALSE(reader.open(feedName("missing")));
+
+    const std::string name = feedName("types");
+    ShmFeedPublisher publisher;
+    REQUIRE(publisher.create(name, 16));
+    Event signal;
+    signal.type = Event::SIGNAL;
+    signal.symbol = "AAA";
+    CHECK_FALSE(publisher.publish(signal));
+    CHECK_FALSE(publisher.publish(Event{Event::FILL, 1, "AAA", {}, {}, {}, {}}));
+
+    Event fill{Event::FILL, 7, "BBB", {}, {}, {}, Execution{11, 12, 10050, 300, 7}};
+    REQUIRE(publisher.publish(fill));
+    REQUIRE(publisher.publish(Event{Event::END_OF_DAY, 8, "BBB", {}, {}, {}, {}}));
+    publisher.close();
+
+    ShmFeedSource source(name);
+    REQUIRE(source.hasNext());
+    Event e = source.getNext();
+    CHECK(e.type == Event::FILL);
+    CHECK(e.symbol == "BBB");
+    REQUIRE(e.execution.has_value());
+    CHECK(e.execution->bid_id == 11);
+    CHECK(e.execution->ask_id == 12);
+    CHECK(e.execution->price == 10050);
+    CHECK(e.execution->quantity == 300);
+    REQUIRE(source.hasNext());
+    CHECK(source.getNext().type == Event::END_OF_DAY);
+    CHECK_FALSE(source.hasNext());
+
+    // reset() rejoins at the oldest retained record.
+    source.reset();
+    REQUIRE(source.hasNext());
+    CHECK(source.getNext().type == Event::FILL);
+}
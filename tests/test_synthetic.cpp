@@ -0,0 +1,72 @@
+#include <catch2/catch_all.hpp>
+#include "lob/synthetic.hpp"
+
+using namespace lob;
+
+TEST_CASE("Synthetic generator is deterministic and replays cleanly") {
+    auto cfg = SyntheticMarketConfig::smallCap();
+    cfg.symbols = 3;
+    cfg.max_events = 20000;
+    cfg.duration = 24ULL * 3600 * 1000000000ULL;
+
+    SyntheticMarketGenerator a(cfg), b(cfg);
+    std::unordered_map<uint32_t, std::unique_ptr<OrderBook>> books;
+    SyntheticUpdate ua, ub;
+    Timestamp last = 0;
+    uint64_t rejected = 0;
+    while (a.next(ua)) {
+        REQUIRE(b.next(ub));
+        REQUIRE(ua.symbol == ub.symbol);
+        REQUIRE(ua.update.order_id == ub.update.order_id);
+        REQUIRE(ua.update.timestamp == ub.update.timestamp);
+        REQUIRE(ua.update.timestamp >= last);
+        last = ua.update.timestamp;
+
+        auto& book = books[ua.symbol];
+        if (!book) book = std::make_unique<OrderBook>(a.symbolName(ua.symbol));
+        const auto& u = ua.update;
+        switch (u.type) {
+            case MarketDataUpdate::ADD_ORDER:
+                rejected += !book->addOrder(Order{u.order_id, u.price, u.quantity, u.side, u.timestamp});
+                break;
+            case MarketDataUpdate::CANCEL_ORDER: rejected += !book->cancelOrder(u.order_id); break;
+            case MarketDataUpdate::MODIFY_ORDER: rejected += !book->modifyOrder(u.order_id, u.quantity); break;
+            case MarketDataUpdate::TRADE: {
+                auto execs = book->processMarketOrder(u.side, u.quantity, u.timestamp);
+                Quantity filled = 0;
+                for (auto& ex : execs) filled += ex.quantity;
+                REQUIRE(filled == u.quantity);
+                break;
+            }
+            default: break;
+        }
+        // The generator never crosses the book.
+        if (book->getBestBid() != 0 && book->getBestAsk() != 0) REQUIRE(book->getBestBid() < book->getBestAsk());
+    }
+    REQUIRE(a.eventsGenerated() == cfg.max_events);
+    REQUIRE(rejected == 0);
+    REQUIRE(books.size() == 3);
+}
+
+TEST_CASE("Synthetic generator rejects configurations it cannot honour") {
+    REQUIRE(SyntheticMarketConfig::liquidEquity().valid());
+    REQUIRE(SyntheticMarketConfig::smallCap().valid());
+    REQUIRE(SyntheticMarketConfig::crypto().valid());
+
+    const auto invalid = [](void (*edit)(SyntheticMarketConfig&)) {
+        auto cfg = SyntheticMarketConfig::liquidEquity();
+        cfg.max_events = 1000;
+        edit(cfg);
+        if (cfg.valid()) return false;
+        SyntheticMarketGenerator gen(cfg);
+        SyntheticUpdate u;
+        return !gen.next(u) && gen.eventsGenerated() == 0;
+    };
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.depth = 0; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.initial_orders_per_level = -1; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.min_qty = 0; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.min_qty = c.max_qty + 1; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.initial_mid = c.depth; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.event_rate = -1.0; }));
+    REQUIRE(invalid([](SyntheticMarketConfig& c) { c.duration = UINT64_MAX - c.start_time + 1; }));
+}
@@ -0,0 +1,167 @@
+#include <catch2/catch_all.hpp>
+#include "lob/backtester.hpp"
+#include "lob/order_book.hpp"
+#include "lob/timer_wheel.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <set>
+
+using namespace lob;
+
+TEST_CASE("Timer wheel expires exactly what a full scan would") {
+    std::mt19937_64 rng(3);
+    TimerWheel wheel(1000);
+    std::deque<Order> orders;  // stable addresses
+    std::set<Order*> scheduled;
+    Timestamp now = 5000;
+    std::vector<Order*> due;
+    wheel.advance(now, due);
+
+    for (int round = 0; round < 4000; ++round) {
+        const auto op = rng() % 10;
+        if (op < 5) {
+            // Mostly near expiries, some far beyond the wheel's span.
+            const uint64_t horizon = op == 0 ? (uint64_t{1} << 44) : op == 1 ? 3000000 : 300000;
+            orders.emplace_back();
+            Order& o = orders.back();
+            o.id = orders.size();
+            o.expire_time = now + rng() % horizon;
+            wheel.schedule(&o);
+            scheduled.insert(&o);
+        } else if (op < 7 && !scheduled.empty()) {
+            auto it = scheduled.begin();
+            std::advance(it, static_cast<long>(rng() % scheduled.size()));
+            wheel.cancel(*it);
+            REQUIRE((*it)->timer_slot == TimerWheel::kUnscheduled);
+            scheduled.erase(it);
+        } else {
+            const uint64_t step = (rng() % 20 == 0) ? (uint64_t{1} << (20 + rng() % 24)) : rng() % 5000;
+            now += step;
+            due.clear();
+            wheel.advance(now, due);
+            std::set<Order*> expected;
+            for (Order* o : scheduled) {
+                if (o->expire_time <= now) expected.insert(o);
+            }
+            REQUIRE(std::set<Order*>(due.begin(), due.end()) == expected);
+            REQUIRE(due.size() == expected.size());
+            for (Order* o : due) scheduled.erase(o);
+        }
+        REQUIRE(wheel.size() == scheduled.size());
+    }
+}
+
+TEST_CASE("GTD orders expire from the book in a batch") {
+    OrderBook b{"TEST"};
+    b.advanceTime(1000);
+    auto gtd = [](OrderId id, Side side, Price px, Timestamp expire) {
+        Order o{id, px, 10, side, id};
+        o.tif = TimeInForce::GTD;
+        o.expire_time = expire;
+        return o;
+    };
+    REQUIRE(b.submitOrder(gtd(1, Side::BID, 100, 5000)).status == SubmitResult::RESTING);
+    REQUIRE(b.submitOrder(gtd(2, Side::BID, 99, 5000)).status == SubmitResult::RESTING);
+    REQUIRE(b.submitOrder(gtd(3, Side::ASK, 105, 9000)).status == SubmitResult::RESTING);
+    REQUIRE(b.addOrder(Order{4, 100, 10, Side::BID, 4}));  // GTC
+    REQUIRE(b.submitOrder(gtd(5, Side::ASK, 106, 900)).status == SubmitResult::REJECTED);  // already past
+    REQUIRE(b.pendingExpiries() == 3);
+
+    // Cancelled and filled orders leave the schedule.
+    REQUIRE(b.cancelOrder(2));
+    REQUIRE(b.pendingExpiries() == 2);
+
+    std::vector<OrderId> expired;
+    REQUIRE(b.advanceTime(4999, &expired) == 0);
+    REQUIRE(b.advanceTime(5000, &expired) == 1);
+    REQUIRE(expired == std::vector<OrderId>{1});
+    REQUIRE(b.getOrder(1) == nullptr);
+    REQUIRE(b.getAggregatedBook(Side::BID, 5) == std::vector<std::pair<Price, Quantity>>{{100, 10}});
+    REQUIRE(b.advanceTime(4000) == 0);  // never backwards
+    REQUIRE(b.currentTime() == 5000);
+
+    (void)b.processMarketOrder(Side::BID, 10, 6000);
+    REQUIRE(b.pendingExpiries() == 0);
+    REQUIRE(b.advanceTime(20000) == 0);
+    REQUIRE(b.getMetrics().orders_expired == 1);
+    REQUIRE(b.stateHash() == b.recomputeStateHash());
+}
+
+TEST_CASE("Reset and clear rewind the book clock") {
+    auto gtd = [](OrderId id, Timestamp expire) {
+        Order o{id, 100, 10, Side::BID, id};
+        o.tif = TimeInForce::GTD;
+        o.expire_time = expire;
+        return o;
+    };
+    OrderBook b{"TEST"};
+    REQUIRE(b.submitOrder(gtd(1, 50000)).status == SubmitResult::RESTING);
+    REQUIRE(b.advanceTime(40000) == 0);
+
+    // The next session starts over at an earlier time.
+    b.reset();
+    REQUIRE(b.currentTime() == 0);
+    REQUIRE(b.pendingExpiries() == 0);
+    REQUIRE(b.submitOrder(gtd(1, 2000)).status == SubmitResult::RESTING);
+    std::vector<OrderId> expired;
+    REQUIRE(b.advanceTime(1999, &expired) == 0);
+    REQUIRE(b.advanceTime(2000, &expired) == 1);
+    REQUIRE(expired == std::vector<OrderId>{1});
+
+    b.clear();
+    REQUIRE(b.currentTime() == 0);
+    REQUIRE(b.submitOrder(gtd(2, 1000)).status == SubmitResult::RESTING);
+    REQUIRE(b.advanceTime(1000) == 1);
+    REQUIRE(b.orderCount() == 0);
+}
+
+namespace {
+
+class ListSource : public DataSource {
+public:
+    explicit ListSource(std::vector<Event> events) : events_(std::move(events)) {}
+    bool hasNext() const override { return next_ < events_.size(); }
+    Event getNext() override { return events_[next_++]; }
+    void reset() override { next_ = 0; }
+
+private:
+    std::vector<Event> events_;
+    size_t next_ = 0;
+};
+
+} // namespace
+
+TEST_CASE("Backtester expires GTD orders on event time") {
+    std::vector<Event> events;
+    Event order{};
+    order.type = Event::ORDER;
+    order.timestamp = 1000;
+    order.symbol = "AAA";
+    Order gtd{1, 100, 10, Side::BID, 0};
+    gtd.tif = TimeInForce::GTD;
+    gtd.expire_time = 2000;
+    order.order = gtd;
+    events.push_back(order);
+    Event md{};
+    md.type = Event::MARKET_DATA;
+    md.timestamp = 2500;
+    md.symbol = "AAA";
+    md.market_update = MarketDataUpdate{MarketDataUpdate::ADD_ORDER, Side::ASK, 110, 5, 2, 2500};
+    events.push_back(md);
+
+    Backtester bt;
+    bt.setStateHashInterval(1);
+    bt.setDataSource(std::make_unique<ListSource>(events));
+    bt.run();
+    // The second event finds the GTD bid already gone: only the ask rests
+    // (second in the book's enqueue sequence).
+    OrderBook expected{"AAA"};
+    REQUIRE(expected.addOrder(Order{1, 100, 10, Side::BID, 1000}));
+    REQUIRE(expected.cancelOrder(1));
+    REQUIRE(expected.addOrder(Order{2, 110, 5, Side::ASK, 2500}));
+    const auto& samples = bt.getStateHashes().at("AAA").samples;
+    REQUIRE(samples.size() == 2);
+    REQUIRE(samples.back().hash == expected.stateHash());
+}
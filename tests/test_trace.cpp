@@ -0,0 +1,61 @@
+#include <catch2/catch_all.hpp>
+#include "lob/backtester.hpp"
+#include "lob/synthetic.hpp"
+#include "lob/trace.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace lob;
+
+namespace {
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+} // namespace
+
+TEST_CASE("Trace buffer keeps the newest spans when full") {
+    TraceBuffer buf(3, 1);  // rounded up to 4
+    static const char* const kName = "span";
+    for (uint64_t i = 0; i < 10; ++i) buf.record(kName, i, i + 1);
+    REQUIRE(buf.recorded() == 10);
+    REQUIRE(buf.dropped() == 6);
+    const auto spans = buf.spans();
+    REQUIRE(spans.size() == 4);
+    REQUIRE(spans.front().begin_ns == 6);
+    REQUIRE(spans.back().begin_ns == 9);
+}
+
+TEST_CASE("Sampled replay exports Chrome trace spans") {
+    auto cfg = SyntheticMarketConfig::liquidEquity();
+    cfg.max_events = 1000;
+    TraceConfig tc;
+    tc.sample_every = 100;
+    tc.burst = 10;
+    Tracer::instance().start(tc);
+    Backtester bt;
+    bt.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+    bt.run();
+    Tracer::instance().stop();
+
+    std::ostringstream os;
+    const size_t spans = Tracer::instance().writeChromeJson(os);
+    const std::string json = os.str();
+    REQUIRE(countOf(json, "\"name\":\"event\"") == 100);
+    REQUIRE(countOf(json, "\"name\":\"book_update\"") == 100);
+    REQUIRE(countOf(json, "\"name\":\"signal_update\"") == 100);
+    REQUIRE(spans == countOf(json, "\"ph\":\"X\""));
+    REQUIRE(json.front() == '{');
+    REQUIRE(json.back() == '}');
+
+    // Disabled tracer records nothing further
+    Backtester idle;
+    idle.setDataSource(std::make_unique<SyntheticDataSource>(cfg));
+    idle.run();
+    std::ostringstream again;
+    REQUIRE(Tracer::instance().writeChromeJson(again) == spans);
+}